@@ -0,0 +1,19 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// shared by the benchmarks, every measurement is averaged over this many runs
+constexpr uint32_t ITERATIONS = 20;
+
+// average time of one call in milliseconds
+template<typename F>
+double Measure(F&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count() / ITERATIONS;
+}
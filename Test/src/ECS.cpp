@@ -20,23 +20,20 @@ struct Velocity : Component<Velocity>
 class MoveSystem : public System<MoveSystem>
 {
 public:
-    MoveSystem(Engine* engine) : System(engine, {Velocity::ID, Position::ID}, {}, {}) {
+    MoveSystem(Engine* engine) : System(engine, {Velocity::ID, Position::ID}, {}, {}, {Velocity::ID}, {Position::ID}) {
     
     }
     ~MoveSystem() override = default;
 
-    void Execute(float delta, const std::vector<Entity*>& entities) override
+    void Execute(float delta, const QueryResult& result) override
     {
-        std::cout << "Total number of " << entities.size() << " entities get executed\n";
-        for (auto& entity : entities)
-        {
-            Velocity* velocity = entity->GetComponent<Velocity>();
-            Position* position = entity->GetComponent<Position>();
-
-            position->x += velocity->dx * delta;
-            position->y += velocity->dy * delta;
-        }
+        std::cout << "Total number of " << result.GetEntityCount() << " entities get executed\n";
+        result.Each<const Velocity, Position>([delta](const Velocity& velocity, Position& position) {
+            position.x += velocity.dx * delta;
+            position.y += velocity.dy * delta;
+        });
     }
+    void Shutdown() override {}
 };
 
 int main() { 
@@ -77,4 +74,17 @@ int main() {
     assert(e2p->y == 5.f + 100 * 4.f);
     assert(e1p->x == 0.f + 100 * 1.f);
     assert(e1p->y == 0.f + 100 * 1.f);
+
+    // removing and adding a component back leaves a default constructed one, recorded or right away
+    myScene.RemoveComponent<Position>(e1);
+    myScene.AddComponent<Position>(e1);
+    assert(myScene.GetComponent<Position>(e1)->x == 0.f);
+
+    myScene.GetComponent<Position>(e2)->x = 7.f;
+    auto& commands = myScene.GetCommandBuffer();
+    commands.RemoveComponent<Position>(e2);
+    commands.AddComponent<Position>(e2);
+    myScene.PlaybackCommands();
+    assert(myScene.GetComponent<Position>(e2)->x == 0.f);
+    assert(myScene.GetComponent<Velocity>(e2)->dx == -3.f);
 }
\ No newline at end of file
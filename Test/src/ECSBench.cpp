@@ -0,0 +1,146 @@
+#include <iostream>
+#include "pch.h"
+#include "Bench.h"
+#include "scene/Entity.h"
+#include "scene/Scene.h"
+
+using namespace Zephyr;
+
+struct Position : Component<Position>
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+};
+
+struct Velocity : Component<Velocity>
+{
+    float dx = 1.f;
+    float dy = 2.f;
+    float dz = 3.f;
+};
+
+struct Health : Component<Health>
+{
+    float value = 100.f;
+};
+
+struct Tag : Component<Tag>
+{
+    uint32_t value = 0;
+};
+
+constexpr uint32_t ENTITY_COUNT = 1000000;
+// projectiles spawned and despawned per simulated frame
+constexpr uint32_t CHURN_COUNT = 10000;
+
+void Report(const char* name, double ms, uint32_t count)
+{
+    printf("%-24s %8.3f ms  %6.2f ns/entity  %8.1f M entities/s\n",
+           name,
+           ms,
+           ms * 1e6 / count,
+           count / ms / 1e3);
+}
+
+// iterates Position + Velocity over 1M entities spread across four archetypes,
+// once through the archetype chunks and once through per entity lookups.
+// then spawns and despawns projectiles on top of the 1M entities, like a frame of a shooter would,
+// once directly and once through a command buffer
+int main()
+{
+    Scene scene(nullptr, "ECSBench");
+
+    std::vector<EntityHandle> handles;
+    handles.reserve(ENTITY_COUNT);
+    for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+    {
+        auto entity = scene.CreateEntity();
+        scene.AddComponent<Position>(entity);
+        scene.AddComponent<Velocity>(entity);
+        if (i % 2)
+        {
+            scene.AddComponent<Health>(entity);
+        }
+        if (i % 3 == 0)
+        {
+            scene.AddComponent<Tag>(entity)->value = i;
+        }
+        handles.push_back(entity);
+    }
+    printf("%u entities in %zu archetypes\n", ENTITY_COUNT, scene.GetArchetypes().size());
+
+    float  delta     = 1.f / 60.f;
+    double chunkTime = Measure([&] {
+        scene.Each<Position, const Velocity>([delta](Position& position, const Velocity& velocity) {
+            position.x += velocity.dx * delta;
+            position.y += velocity.dy * delta;
+            position.z += velocity.dz * delta;
+        });
+    });
+
+    double lookupTime = Measure([&] {
+        for (auto handle : handles)
+        {
+            auto position = scene.GetComponent<Position>(handle);
+            auto velocity = scene.GetComponent<const Velocity>(handle);
+            position->x += velocity->dx * delta;
+            position->y += velocity->dy * delta;
+            position->z += velocity->dz * delta;
+        }
+    });
+
+    Report("archetype chunks", chunkTime, ENTITY_COUNT);
+    Report("per entity lookup", lookupTime, ENTITY_COUNT);
+    printf("speedup %.2fx\n", lookupTime / chunkTime);
+
+    // both passes ran the same number of steps on every entity
+    auto position = scene.GetComponent<Position>(handles.back());
+    printf("check %f\n", position->x);
+
+    std::vector<EntityHandle> projectiles;
+    projectiles.reserve(CHURN_COUNT);
+    double churnTime = Measure([&] {
+        for (uint32_t i = 0; i < CHURN_COUNT; i++)
+        {
+            auto entity = scene.CreateEntity();
+            scene.AddComponent<Position>(entity);
+            scene.AddComponent<Velocity>(entity);
+            projectiles.push_back(entity);
+        }
+        // oldest first, the worst case for the old linear removal
+        for (auto entity : projectiles)
+        {
+            scene.RemoveEntity(entity);
+        }
+        projectiles.clear();
+    });
+    Report("spawn + despawn", churnTime, CHURN_COUNT);
+
+    // the same churn recorded, every projectile is placed into its final archetype without moves
+    double deferredTime = Measure([&] {
+        auto& commands = scene.GetCommandBuffer();
+        for (uint32_t i = 0; i < CHURN_COUNT; i++)
+        {
+            auto entity = commands.CreateEntity();
+            commands.AddComponent<Position>(entity);
+            commands.AddComponent(entity, Velocity());
+        }
+        scene.PlaybackCommands();
+
+        // pending handles don't survive playback, the projectiles are the newest entities
+        auto& entities = scene.GetEntities();
+        for (uint32_t i = ENTITY_COUNT; i < entities.size(); i++)
+        {
+            commands.RemoveEntity(entities[i]);
+        }
+        scene.PlaybackCommands();
+    });
+    Report("deferred spawn + despawn", deferredTime, CHURN_COUNT);
+
+    // a handle of a removed entity stays dead even after its index is reused
+    auto stale = scene.CreateEntity();
+    scene.RemoveEntity(stale);
+    scene.CreateEntity();
+    printf("stale handle alive %d, entities %u\n", scene.IsAlive(stale), scene.GetEntityCount());
+}
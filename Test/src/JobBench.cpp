@@ -0,0 +1,107 @@
+#include <cmath>
+#include <iostream>
+#include "pch.h"
+#include "Bench.h"
+#include "core/job/JobSystem.h"
+#include "scene/Scene.h"
+
+using namespace Zephyr;
+
+struct Position : Component<Position>
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+};
+
+struct Velocity : Component<Velocity>
+{
+    float dx = 1.f;
+    float dy = 2.f;
+    float dz = 3.f;
+};
+
+constexpr uint32_t ELEMENT_COUNT = 1 << 22;
+constexpr uint32_t ENTITY_COUNT  = 1000000;
+constexpr uint32_t EMPTY_JOBS    = 100000;
+
+class IntegrateSystem : public System<IntegrateSystem>
+{
+public:
+    IntegrateSystem(Engine* engine) : System(engine, {Position::ID, Velocity::ID}, {}, {}, {Velocity::ID}, {Position::ID}) {}
+
+    void Execute(float delta, const QueryResult& result) override
+    {
+        result.ParallelEach<Position, const Velocity>([delta](Position& position, const Velocity& velocity) {
+            // enough math per entity that memory bandwidth isn't the only limit
+            position.x += std::sin(velocity.dx * delta) * std::cos(position.y);
+            position.y += std::sin(velocity.dy * delta) * std::cos(position.z);
+            position.z += std::sin(velocity.dz * delta) * std::cos(position.x);
+        });
+    }
+    void Shutdown() override {}
+};
+
+// the same three workloads with 1 to N threads, N is the hardware thread count unless given as the first argument
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = argc > 1 ? std::max(atoi(argv[1]), 1) : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<float> values(ELEMENT_COUNT);
+    for (uint32_t i = 0; i < ELEMENT_COUNT; i++)
+    {
+        values[i] = i * 0.001f;
+    }
+
+    printf("%8s %14s %8s %14s %8s %14s\n", "threads", "parallel_for", "speedup", "ecs tick", "speedup", "empty job");
+    double baseFor  = 0.;
+    double baseTick = 0.;
+    for (uint32_t threads = 1; threads <= maxThreads; threads++)
+    {
+        // the calling thread works too, so n threads are n - 1 workers
+        JobSystem jobs(threads - 1);
+
+        std::vector<float> output(ELEMENT_COUNT);
+        double             forTime = Measure([&] {
+            jobs.ParallelFor(0, ELEMENT_COUNT, 16384, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    output[i] = std::sqrt(values[i]) * std::sin(values[i]);
+                }
+            });
+        });
+
+        Scene scene(nullptr, "JobBench");
+        scene.SetJobSystem(&jobs);
+        scene.AddSystem<IntegrateSystem>();
+        for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+        {
+            auto entity = scene.CreateEntity();
+            scene.AddComponent<Position>(entity);
+            scene.AddComponent<Velocity>(entity);
+        }
+        double tickTime = Measure([&] { scene.Tick(1.f / 60.f); });
+
+        double emptyTime = Measure([&] {
+            JobCounter counter;
+            for (uint32_t i = 0; i < EMPTY_JOBS; i++)
+            {
+                jobs.Run([]() {}, &counter);
+            }
+            jobs.Wait(counter);
+        });
+
+        if (threads == 1)
+        {
+            baseFor  = forTime;
+            baseTick = tickTime;
+        }
+        printf("%8u %11.3f ms %7.2fx %11.3f ms %7.2fx %11.1f ns\n",
+               threads,
+               forTime,
+               baseFor / forTime,
+               tickTime,
+               baseTick / tickTime,
+               emptyTime * 1e6 / EMPTY_JOBS);
+    }
+}
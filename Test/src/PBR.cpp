@@ -111,10 +111,10 @@ int main()
                 material->SetConstantBlock<float>("roughness", roughness);
                 sphere->SetMaterials({material});
                 auto e1             = scene->CreateEntity();
-                auto meshComponent1 = scene->AddComponent<MeshComponent>(e1);
-                auto meshTransform  = scene->AddComponent<TransformComponent>(e1);
-
+                auto meshComponent1  = scene->AddComponent<MeshComponent>(e1);
                 meshComponent1->mesh = sphere;
+
+                auto meshTransform = scene->AddComponent<TransformComponent>(e1);
                 meshTransform->transform =
                     glm::scale(glm::translate(transform, {10 * i, 10 * (j - 3), 0}), {300, 300, 300});
             }
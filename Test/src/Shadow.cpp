@@ -64,10 +64,10 @@ int main()
             for (int j = 0; j < 20; j++)
             {
                 auto e1             = scene->CreateEntity();
-                auto meshComponent1 = scene->AddComponent<MeshComponent>(e1);
-                auto meshTransform  = scene->AddComponent<TransformComponent>(e1);
+                auto meshComponent1  = scene->AddComponent<MeshComponent>(e1);
+                meshComponent1->mesh = box;
 
-                meshComponent1->mesh     = box;
+                auto meshTransform       = scene->AddComponent<TransformComponent>(e1);
                 meshTransform->transform = glm::translate(transform, {20 * i, 0, -20 * j});
             }
         }
@@ -0,0 +1,170 @@
+#include <iostream>
+#include "pch.h"
+#include "Bench.h"
+#include "core/math/DynamicBVH.h"
+#include "core/math/Random.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace Zephyr;
+
+constexpr uint32_t PROXY_COUNT = 100000;
+// the world is WORLD_SIZE wide and flat, the camera sees a small part of it
+constexpr float    WORLD_SIZE  = 2000.f;
+
+bool Inside(const Frustum& frustum, const AABB& bounds)
+{
+    for (auto& plane : frustum.planes)
+    {
+        glm::vec3 corner = {plane.x > 0.f ? bounds.max.x : bounds.min.x,
+                            plane.y > 0.f ? bounds.max.y : bounds.min.y,
+                            plane.z > 0.f ? bounds.max.z : bounds.min.z};
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// frustum, sphere and ray queries against the linear pass over every box, then the cost of keeping the tree
+// up to date while a part of the boxes moves every frame, and last the queries again while boxes move, come
+// and go
+int main()
+{
+    Random random(42);
+    auto   randomBox = [&] {
+        glm::vec3 center = {random.Range(0.f, WORLD_SIZE), random.Range(0.f, 20.f), random.Range(0.f, WORLD_SIZE)};
+        glm::vec3 extent = {random.Range(.5f, 4.f), random.Range(.5f, 4.f), random.Range(.5f, 4.f)};
+        return AABB(center - extent, center + extent);
+    };
+
+    DynamicBVH            bvh;
+    std::vector<AABB>     boxes;
+    std::vector<uint32_t> proxies;
+    for (uint32_t i = 0; i < PROXY_COUNT; i++)
+    {
+        boxes.push_back(randomBox());
+        proxies.push_back(bvh.Insert(boxes.back(), i));
+    }
+    printf("%u proxies, inserted: height %u cost %.1f\n", PROXY_COUNT, bvh.GetHeight(), bvh.GetCost());
+    bvh.Optimize();
+    printf("%u proxies, rebuilt:  height %u cost %.1f\n", PROXY_COUNT, bvh.GetHeight(), bvh.GetCost());
+
+    glm::vec3 eye = {WORLD_SIZE * .5f, 30.f, WORLD_SIZE * .5f};
+    glm::mat4 vp  = glm::perspective(glm::radians(60.f), 16.f / 9.f, .1f, 300.f) *
+                   glm::lookAt(eye, eye + glm::vec3(1.f, -.2f, 1.f), glm::vec3(0.f, 1.f, 0.f));
+    Frustum   frustum(vp);
+    Sphere    sphere(eye, 100.f);
+    Ray       ray {eye, glm::vec3(1.f, -.01f, .7f), 1000.f};
+
+    uint32_t linearHits    = 0;
+    uint32_t bvhHits       = 0;
+    double   linearFrustum = Measure([&] {
+        linearHits = 0;
+        for (auto& box : boxes)
+        {
+            linearHits += Inside(frustum, box);
+        }
+    });
+    double bvhFrustum = Measure([&] {
+        bvhHits = 0;
+        bvh.Query(frustum, [&](uint32_t) { bvhHits++; });
+    });
+    printf("%-16s linear %8.3f ms  bvh %8.3f ms  %u / %u hits\n", "frustum", linearFrustum, bvhFrustum, linearHits,
+           bvhHits);
+
+    double linearSphere = Measure([&] {
+        linearHits = 0;
+        for (auto& box : boxes)
+        {
+            glm::vec3 d = glm::max(box.min - sphere.m_Center, glm::vec3(0.f)) +
+                          glm::max(sphere.m_Center - box.max, glm::vec3(0.f));
+            linearHits += glm::dot(d, d) <= sphere.m_Radius * sphere.m_Radius;
+        }
+    });
+    double bvhSphere = Measure([&] {
+        bvhHits = 0;
+        bvh.Query(sphere, [&](uint32_t) { bvhHits++; });
+    });
+    printf("%-16s linear %8.3f ms  bvh %8.3f ms  %u / %u hits\n", "sphere", linearSphere, bvhSphere, linearHits,
+           bvhHits);
+
+    double bvhRay = Measure([&] {
+        bvhHits = 0;
+        bvh.Query(ray, [&](uint32_t, float) { bvhHits++; });
+    });
+    printf("%-16s bvh %8.3f ms  %u hits\n", "ray", bvhRay, bvhHits);
+
+    // every frame a slice of the boxes drifts, the tree is refit and rebuilt when it got too loose
+    auto move = [&](uint32_t stride) {
+        for (uint32_t i = random.Index(stride); i < PROXY_COUNT; i += stride)
+        {
+            glm::vec3 offset = {random.Range(-2.f, 2.f), 0.f, random.Range(-2.f, 2.f)};
+            boxes[i]         = AABB(boxes[i].min + offset, boxes[i].max + offset);
+            bvh.Move(proxies[i], boxes[i]);
+        }
+        bvh.Optimize();
+    };
+
+    double allTime  = Measure([&] { move(1); });
+    double someTime = Measure([&] { move(100); });
+    printf("%-16s %8.3f ms\n", "all moving", allTime);
+    printf("%-16s %8.3f ms\n", "1% moving", someTime);
+    printf("moved: height %u cost %.1f\n", bvh.GetHeight(), bvh.GetCost());
+
+    // boxes jump out of their fat bounds while others are removed and inserted next to them, the queries still
+    // have to agree with the linear pass
+    std::vector<bool> alive(PROXY_COUNT, true);
+    std::vector<bool> hit(PROXY_COUNT);
+    uint32_t          mismatches = 0;
+    for (uint32_t frame = 0; frame < ITERATIONS; frame++)
+    {
+        for (uint32_t n = 0; n < PROXY_COUNT / 20; n++)
+        {
+            uint32_t i = random.Index(PROXY_COUNT);
+            if (!alive[i])
+            {
+                continue;
+            }
+            glm::vec3 offset = {random.Range(-20.f, 20.f), 0.f, random.Range(-20.f, 20.f)};
+            boxes[i]         = AABB(boxes[i].min + offset, boxes[i].max + offset);
+            bvh.Move(proxies[i], boxes[i]);
+        }
+        for (uint32_t n = 0; n < PROXY_COUNT / 100; n++)
+        {
+            uint32_t i = random.Index(PROXY_COUNT);
+            if (alive[i])
+            {
+                bvh.Remove(proxies[i]);
+            }
+            else
+            {
+                boxes[i]   = randomBox();
+                proxies[i] = bvh.Insert(boxes[i], i);
+            }
+            alive[i] = !alive[i];
+        }
+        bvh.Optimize();
+
+        std::fill(hit.begin(), hit.end(), false);
+        bvh.Query(frustum, [&](uint32_t i) { hit[i] = true; });
+        for (uint32_t i = 0; i < PROXY_COUNT; i++)
+        {
+            mismatches += hit[i] != (alive[i] && Inside(frustum, boxes[i]));
+        }
+
+        // every box has to be found at its own place, wherever it went since the last rebuild
+        for (uint32_t i = 0; i < PROXY_COUNT; i++)
+        {
+            bool found = false;
+            if (alive[i])
+            {
+                bvh.Query(boxes[i], [&](uint32_t other) { found |= other == i; });
+            }
+            mismatches += alive[i] && !found;
+        }
+    }
+    printf("churn: %u mismatches against the linear pass\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include "pch.h"
+#include "Bench.h"
+#include "scene/Scene.h"
+#include "scene/component/LocalTransformComponent.h"
+#include "scene/component/TransformComponent.h"
+#include "scene/system/preset/TransformSystem.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace Zephyr;
+
+constexpr uint32_t ROOT_COUNT = 1000;
+// every root has this many children, every child this many children again and so on
+constexpr uint32_t BRANCHING  = 4;
+constexpr uint32_t DEPTH      = 4;
+
+void AddChildren(Scene& scene, std::vector<EntityHandle>& entities, EntityHandle parent, uint32_t depth)
+{
+    if (depth == DEPTH)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < BRANCHING; i++)
+    {
+        auto entity = scene.CreateEntity();
+        scene.AddComponent<TransformComponent>(entity);
+        auto local      = scene.AddComponent<LocalTransformComponent>(entity);
+        local->position = {1.f, 0.f, 0.f};
+        local->rotation = glm::angleAxis(0.3f * i, glm::normalize(glm::vec3(1.f, 2.f, 3.f * i)));
+        local->scale    = glm::vec3(1.f + 0.1f * i, 1.f, 1.f - 0.1f * i);
+        local->parent   = parent;
+        entities.push_back(entity);
+        AddChildren(scene, entities, entity, depth + 1);
+    }
+}
+
+// the world matrix composed with glm, walking up the parents
+glm::mat4 Reference(Scene& scene, EntityHandle entity)
+{
+    auto      local     = scene.GetComponent<LocalTransformComponent>(entity);
+    glm::mat4 transform = glm::translate(glm::mat4(1.f), local->position) * glm::mat4_cast(local->rotation) *
+                          glm::scale(glm::mat4(1.f), local->scale);
+    return local->parent != InvalidEntityHandle ? Reference(scene, local->parent) * transform : transform;
+}
+
+// a forest of animated hierarchies, once with every root moving and once with one root in a hundred moving
+int main()
+{
+    Scene scene(nullptr, "TransformBench");
+    scene.AddSystem<TransformSystem>();
+
+    std::vector<EntityHandle> roots;
+    std::vector<EntityHandle> entities;
+    for (uint32_t i = 0; i < ROOT_COUNT; i++)
+    {
+        auto entity = scene.CreateEntity();
+        scene.AddComponent<TransformComponent>(entity);
+        scene.AddComponent<LocalTransformComponent>(entity);
+        AddChildren(scene, entities, entity, 0);
+        roots.push_back(entity);
+        entities.push_back(entity);
+    }
+    printf("%u entities\n", scene.GetEntityCount());
+
+    // links every node and composes every world matrix
+    scene.Tick(0.f);
+
+    float angle = 0.f;
+    auto  move  = [&](uint32_t stride) {
+        angle += 0.01f;
+        for (uint32_t i = 0; i < ROOT_COUNT; i += stride)
+        {
+            auto local      = scene.GetComponent<LocalTransformComponent>(roots[i]);
+            local->rotation = glm::angleAxis(angle, glm::vec3(0.f, 1.f, 0.f));
+            local->dirty    = true;
+        }
+        scene.Tick(1.f / 60.f);
+    };
+
+    double allTime  = Measure([&] { move(1); });
+    double someTime = Measure([&] { move(100); });
+    double noneTime = Measure([&] { scene.Tick(1.f / 60.f); });
+
+    printf("%-16s %8.3f ms\n", "all dirty", allTime);
+    printf("%-16s %8.3f ms\n", "1% dirty", someTime);
+    printf("%-16s %8.3f ms\n", "nothing dirty", noneTime);
+
+    // the composed matrices, sse or not, have to agree with glm
+    uint32_t mismatches = 0;
+    for (auto entity : entities)
+    {
+        glm::mat4 expected = Reference(scene, entity);
+        glm::mat4 actual   = scene.GetComponent<TransformComponent>(entity)->transform;
+        bool      equal    = true;
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            for (uint32_t row = 0; row < 4; row++)
+            {
+                float error = std::abs(expected[column][row] - actual[column][row]);
+                equal &= error <= 1e-4f * (1.f + std::abs(expected[column][row]));
+            }
+        }
+        mismatches += !equal;
+    }
+    printf("%u mismatches against glm\n", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+#include "JobSystem.h"
+
+namespace Zephyr
+{
+    namespace
+    {
+        // which job system the current thread works for, threads outside any pool have none
+        thread_local const JobSystem* s_JobSystem   = nullptr;
+        thread_local uint32_t         s_WorkerIndex = 0;
+    } // namespace
+
+    bool JobCounter::IsDone() const
+    {
+        // a finishing job still touches the counter after the count reached zero
+        return m_Count.load(std::memory_order_seq_cst) == 0 && m_Finishing.load(std::memory_order_seq_cst) == 0;
+    }
+
+    JobSystem::JobSystem(uint32_t workerCount) :
+        m_MainThread(std::this_thread::get_id()), m_WorkerCount(workerCount), m_Queues(new WorkStealingQueue[workerCount])
+    {
+        m_Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            m_Workers.emplace_back(&JobSystem::WorkerMain, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Stop = true;
+        }
+        m_Wake.notify_all();
+        for (auto& worker : m_Workers)
+        {
+            worker.join();
+        }
+
+        // jobs nobody waited for
+        for (auto job : m_Shared)
+        {
+            delete job;
+        }
+        for (auto job : m_Main)
+        {
+            delete job;
+        }
+    }
+
+    bool JobSystem::IsMainThread() const { return std::this_thread::get_id() == m_MainThread; }
+
+    uint32_t JobSystem::GetThreadIndex() const { return s_JobSystem == this ? s_WorkerIndex + 1 : 0; }
+
+    void JobSystem::Run(JobFunction&& function, JobCounter* counter, JobAffinity affinity)
+    {
+        if (counter)
+        {
+            counter->m_Count.fetch_add(1, std::memory_order_seq_cst);
+        }
+        Schedule(new Job {std::move(function), counter, affinity});
+    }
+
+    void JobSystem::RunAfter(JobCounter& dependency, JobFunction&& function, JobCounter* counter, JobAffinity affinity)
+    {
+        if (counter)
+        {
+            counter->m_Count.fetch_add(1, std::memory_order_seq_cst);
+        }
+        auto job = new Job {std::move(function), counter, affinity};
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+            if (dependency.m_Count.load(std::memory_order_seq_cst) != 0)
+            {
+                dependency.m_Continuations.push_back(job);
+                return;
+            }
+        }
+        Schedule(job);
+    }
+
+    void JobSystem::Schedule(Job* job)
+    {
+        if (job->affinity == JobAffinity::MainThread)
+        {
+            std::lock_guard<std::mutex> lock(m_MainMutex);
+            m_Main.push_back(job);
+            return;
+        }
+
+        // counted before it is visible so m_Queued never drops below the real number of jobs
+        m_Queued.fetch_add(1, std::memory_order_seq_cst);
+        if (s_JobSystem == this)
+        {
+            m_Queues[s_WorkerIndex].Push(job);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_SharedMutex);
+            m_Shared.push_back(job);
+        }
+
+        // pairs with the sleeper count in WorkerMain, whichever side comes second sees the other
+        if (m_Sleeping.load(std::memory_order_seq_cst) != 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_SleepMutex);
+            }
+            m_Wake.notify_one();
+        }
+    }
+
+    void JobSystem::Execute(Job* job)
+    {
+        job->function();
+
+        auto counter = job->counter;
+        delete job;
+        if (counter == nullptr)
+        {
+            return;
+        }
+
+        std::vector<Job*> continuations;
+        counter->m_Finishing.fetch_add(1, std::memory_order_seq_cst);
+        if (counter->m_Count.fetch_sub(1, std::memory_order_seq_cst) == 1)
+        {
+            std::lock_guard<std::mutex> lock(counter->m_Mutex);
+            continuations.swap(counter->m_Continuations);
+        }
+        // last access, a waiter may destroy the counter from here on
+        counter->m_Finishing.fetch_sub(1, std::memory_order_seq_cst);
+
+        for (auto continuation : continuations)
+        {
+            Schedule(continuation);
+        }
+    }
+
+    Job* JobSystem::PopMainThreadJob()
+    {
+        std::lock_guard<std::mutex> lock(m_MainMutex);
+        if (m_Main.empty())
+        {
+            return nullptr;
+        }
+        auto job = m_Main.front();
+        m_Main.pop_front();
+        return job;
+    }
+
+    Job* JobSystem::FindJob()
+    {
+        Job*     job        = nullptr;
+        bool     worker     = s_JobSystem == this;
+        uint32_t queueCount = m_WorkerCount;
+
+        // newest own job first, it is the most likely to be hot in cache
+        if (worker)
+        {
+            job = m_Queues[s_WorkerIndex].Pop();
+        }
+
+        if (job == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(m_SharedMutex);
+            if (!m_Shared.empty())
+            {
+                job = m_Shared.front();
+                m_Shared.pop_front();
+            }
+        }
+
+        // then the oldest job of another worker
+        uint32_t start = worker ? s_WorkerIndex + 1 : 0;
+        for (uint32_t i = 0; job == nullptr && i < queueCount; i++)
+        {
+            uint32_t victim = (start + i) % queueCount;
+            if (!worker || victim != s_WorkerIndex)
+            {
+                job = m_Queues[victim].Steal();
+            }
+        }
+
+        if (job)
+        {
+            m_Queued.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    bool JobSystem::TryRunJob()
+    {
+        Job* job = IsMainThread() ? PopMainThreadJob() : nullptr;
+        if (job == nullptr)
+        {
+            job = FindJob();
+        }
+        if (job == nullptr)
+        {
+            return false;
+        }
+
+        Execute(job);
+        return true;
+    }
+
+    void JobSystem::Wait(const JobCounter& counter)
+    {
+        while (!counter.IsDone())
+        {
+            if (!TryRunJob())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::RunMainThreadJobs()
+    {
+        assert(IsMainThread());
+        while (auto job = PopMainThreadJob())
+        {
+            Execute(job);
+        }
+    }
+
+    void JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& fn)
+    {
+        grain = std::max(grain, 1u);
+
+        JobCounter counter;
+        // the calling thread keeps the first range for itself
+        for (uint32_t first = std::min(begin + grain, end); first < end; first += grain)
+        {
+            uint32_t last = end - first > grain ? first + grain : end;
+            Run([&fn, first, last]() { fn(first, last); }, &counter);
+        }
+        if (begin < end)
+        {
+            fn(begin, std::min(begin + grain, end));
+        }
+        Wait(counter);
+    }
+
+    void JobSystem::WorkerMain(uint32_t index)
+    {
+        s_JobSystem   = this;
+        s_WorkerIndex = index;
+
+        while (true)
+        {
+            if (auto job = FindJob())
+            {
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            m_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+            m_Wake.wait(lock, [this] { return m_Stop || m_Queued.load(std::memory_order_seq_cst) != 0; });
+            m_Sleeping.fetch_sub(1, std::memory_order_seq_cst);
+            if (m_Stop)
+            {
+                return;
+            }
+        }
+    }
+} // namespace Zephyr
@@ -0,0 +1,117 @@
+#pragma once
+#include "pch.h"
+#include "core/macro.h"
+#include "core/job/WorkStealingQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Zephyr
+{
+    using JobFunction = std::function<void()>;
+
+    enum class JobAffinity : uint8_t
+    {
+        Any,
+        // only run by the thread that created the job system, for glfw and anything else bound to it
+        MainThread,
+    };
+
+    /*
+        number of unfinished jobs that were started with it.
+        jobs scheduled with RunAfter on a counter start once it drops to zero, which is how dependencies and
+        continuations are expressed. a counter has to outlive the jobs counted by it.
+    */
+    class JobCounter final
+    {
+    public:
+        JobCounter() = default;
+        DISALE_COPY_AND_MOVE(JobCounter);
+
+        bool IsDone() const;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_Count {0};
+        // jobs between their decrement and their last access to the counter
+        std::atomic<uint32_t> m_Finishing {0};
+        std::mutex            m_Mutex;
+        std::vector<Job*>     m_Continuations;
+    };
+
+    struct Job
+    {
+        JobFunction function;
+        JobCounter* counter;
+        JobAffinity affinity;
+    };
+
+    /*
+        engine wide job system.
+        every worker owns a Chase-Lev deque: it pushes and pops its own jobs lock free while idle workers steal the
+        oldest jobs of the others. threads outside the pool submit through a shared queue.
+        waiting never blocks a thread, it runs other jobs until the counter is done, so jobs can wait on jobs.
+        with zero workers every job runs inside Wait on the waiting thread.
+    */
+    class JobSystem final
+    {
+    public:
+        explicit JobSystem(uint32_t workerCount);
+        ~JobSystem();
+
+        DISALE_COPY_AND_MOVE(JobSystem);
+
+        inline uint32_t GetWorkerCount() const { return m_WorkerCount; }
+        bool            IsMainThread() const;
+        // 0 outside the pool, worker index + 1 on workers. lets callers keep GetWorkerCount() + 1 per thread slots
+        uint32_t        GetThreadIndex() const;
+
+        // counter, when given, is incremented now and decremented once the job has run
+        void Run(JobFunction&& function, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any);
+        // like Run, but the job is only queued once dependency is done
+        void RunAfter(JobCounter& dependency, JobFunction&& function, JobCounter* counter = nullptr,
+                      JobAffinity affinity = JobAffinity::Any);
+
+        // runs queued jobs on the calling thread until counter is done
+        void Wait(const JobCounter& counter);
+        // runs one queued job on the calling thread, false when there was nothing it could run
+        bool TryRunJob();
+        // drains the main thread queue, call once per frame on the main thread
+        void RunMainThreadJobs();
+
+        // fn(begin, end) over [begin, end) split into ranges of at most grain, returns once all ranges ran
+        void ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& fn);
+
+    private:
+        void Schedule(Job* job);
+        void Execute(Job* job);
+        Job* FindJob();
+        Job* PopMainThreadJob();
+        void WorkerMain(uint32_t index);
+
+    private:
+        std::thread::id                      m_MainThread;
+        // fixed before the workers start, m_Workers itself is still growing while they run
+        uint32_t                             m_WorkerCount;
+        std::vector<std::thread>             m_Workers;
+        std::unique_ptr<WorkStealingQueue[]> m_Queues;
+
+        // jobs submitted by threads outside the pool
+        std::mutex       m_SharedMutex;
+        std::deque<Job*> m_Shared;
+
+        std::mutex       m_MainMutex;
+        std::deque<Job*> m_Main;
+
+        // queued jobs any worker may run, sleeping workers wait for it to become non zero
+        std::atomic<uint32_t>   m_Queued {0};
+        std::atomic<uint32_t>   m_Sleeping {0};
+        std::mutex              m_SleepMutex;
+        std::condition_variable m_Wake;
+        bool                    m_Stop = false;
+    };
+} // namespace Zephyr
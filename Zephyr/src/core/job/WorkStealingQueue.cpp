@@ -0,0 +1,93 @@
+#include "WorkStealingQueue.h"
+
+namespace Zephyr
+{
+    WorkStealingQueue::WorkStealingQueue(uint32_t capacity)
+    {
+        assert(capacity != 0 && (capacity & (capacity - 1)) == 0 && "capacity has to be a power of two");
+        m_Ring.store(new Ring(capacity), std::memory_order_relaxed);
+    }
+
+    WorkStealingQueue::~WorkStealingQueue()
+    {
+        delete m_Ring.load(std::memory_order_relaxed);
+        for (auto ring : m_Retired)
+        {
+            delete ring;
+        }
+    }
+
+    WorkStealingQueue::Ring* WorkStealingQueue::Grow(Ring* ring, int64_t top, int64_t bottom)
+    {
+        auto grown = new Ring(ring->capacity * 2);
+        for (int64_t i = top; i < bottom; i++)
+        {
+            grown->Put(i, ring->Get(i));
+        }
+        m_Retired.push_back(ring);
+        m_Ring.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    void WorkStealingQueue::Push(Job* job)
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top    = m_Top.load(std::memory_order_acquire);
+        Ring*   ring   = m_Ring.load(std::memory_order_relaxed);
+
+        if (bottom - top > ring->capacity - 1)
+        {
+            ring = Grow(ring, top, bottom);
+        }
+        ring->Put(bottom, job);
+        // publishes the slot to thieves
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    Job* WorkStealingQueue::Pop()
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        Ring*   ring   = m_Ring.load(std::memory_order_relaxed);
+
+        // the reservation of the bottom slot has to be visible before top is read, seq_cst orders the two
+        m_Bottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_seq_cst);
+
+        if (top > bottom)
+        {
+            // empty
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = ring->Get(bottom);
+        if (top == bottom)
+        {
+            // last job, race the thieves for it through top
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* WorkStealingQueue::Steal()
+    {
+        int64_t top    = m_Top.load(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_seq_cst);
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Ring* ring = m_Ring.load(std::memory_order_acquire);
+        Job*  job  = ring->Get(top);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return job;
+    }
+} // namespace Zephyr
@@ -0,0 +1,57 @@
+#pragma once
+#include "pch.h"
+#include "core/macro.h"
+#include <atomic>
+
+namespace Zephyr
+{
+    struct Job;
+
+    /*
+        Chase-Lev work-stealing deque (the C11 formulation by Le, Pop, Cohen and Zappa Nardelli).
+        only the owning thread may Push and Pop, at the bottom. any thread may Steal, from the top.
+        the ring grows when full, outgrown rings are kept until the queue dies since a thief may still read them.
+    */
+    class WorkStealingQueue final
+    {
+    public:
+        explicit WorkStealingQueue(uint32_t capacity = 1024);
+        ~WorkStealingQueue();
+
+        DISALE_COPY_AND_MOVE(WorkStealingQueue);
+
+        void Push(Job* job);
+        // nullptr when empty
+        Job* Pop();
+        // nullptr when empty or when another thread won the race for the top job
+        Job* Steal();
+
+        inline bool Empty() const
+        {
+            return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Ring
+        {
+            explicit Ring(int64_t capacity) : capacity(capacity), mask(capacity - 1), slots(new std::atomic<Job*>[capacity]) {}
+            ~Ring() { delete[] slots; }
+
+            inline Job* Get(int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+            inline void Put(int64_t index, Job* job) { slots[index & mask].store(job, std::memory_order_relaxed); }
+
+            int64_t            capacity;
+            int64_t            mask;
+            std::atomic<Job*>* slots;
+        };
+
+        Ring* Grow(Ring* ring, int64_t top, int64_t bottom);
+
+    private:
+        alignas(64) std::atomic<int64_t> m_Top {0};
+        alignas(64) std::atomic<int64_t> m_Bottom {0};
+        std::atomic<Ring*> m_Ring;
+        // owner only
+        std::vector<Ring*> m_Retired;
+    };
+} // namespace Zephyr
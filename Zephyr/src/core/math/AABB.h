@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cfloat>
 #include <glm/glm.hpp>
 
 namespace Zephyr
@@ -13,6 +14,41 @@ namespace Zephyr
         AABB() : min(0.0f), max(0.0f) {}
 
         AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+        // bounds of the transformed box corners
+        AABB Transform(const glm::mat4& transform) const
+        {
+            AABB result({FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX});
+            for (int corner = 0; corner < 8; corner++)
+            {
+                glm::vec3 p = {corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z};
+                p           = transform * glm::vec4(p, 1.f);
+                result.min  = glm::min(result.min, p);
+                result.max  = glm::max(result.max, p);
+            }
+            return result;
+        }
+
+        // min > max on any axis, such boxes are never culled
+        bool IsEmpty() const { return glm::any(glm::greaterThan(min, max)); }
+
+        bool Contains(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+        }
+
+        bool Overlaps(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::lessThanEqual(other.min, max));
+        }
+
+        float SurfaceArea() const
+        {
+            glm::vec3 extent = max - min;
+            return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        }
+
+        static AABB Union(const AABB& a, const AABB& b) { return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max)); }
     };
 
-} // namespace Hazel
\ No newline at end of file
+} // namespace Zephyr
\ No newline at end of file
@@ -0,0 +1,494 @@
+#include "DynamicBVH.h"
+
+namespace Zephyr
+{
+    namespace
+    {
+        // the bounds of nothing, any union with it is the other box
+        const AABB EMPTY_BOUNDS({FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX});
+
+        AABB Fatten(const AABB& bounds, float margin)
+        {
+            glm::vec3 extent = bounds.max - bounds.min;
+            glm::vec3 grow   = glm::vec3(margin * std::max(extent.x, std::max(extent.y, extent.z)));
+            return AABB(bounds.min - grow, bounds.max + grow);
+        }
+
+        glm::vec3 Center(const AABB& bounds) { return (bounds.min + bounds.max) * .5f; }
+    } // namespace
+
+    // a leaf as the rebuild sees it, kept in one array so the binning passes read memory in order
+    struct DynamicBVH::BuildItem
+    {
+        AABB      bounds;
+        glm::vec3 center;
+        uint32_t  leaf;
+    };
+
+    DynamicBVH::FrustumPlanes::FrustumPlanes(const Frustum& frustum)
+    {
+#ifdef ZEPHYR_BVH_SSE
+        // planes past the sixth are 0 * p + 1, every box is inside them
+        alignas(16) float px[8], py[8], pz[8], pw[8];
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            glm::vec4 plane = i < Frustum::PlaneCount ? frustum.planes[i] : glm::vec4(0.f, 0.f, 0.f, 1.f);
+            px[i]           = plane.x;
+            py[i]           = plane.y;
+            pz[i]           = plane.z;
+            pw[i]           = plane.w;
+        }
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            x[i] = _mm_load_ps(px + i * 4);
+            y[i] = _mm_load_ps(py + i * 4);
+            z[i] = _mm_load_ps(pz + i * 4);
+            w[i] = _mm_load_ps(pw + i * 4);
+        }
+#else
+        for (uint32_t i = 0; i < Frustum::PlaneCount; i++)
+        {
+            planes[i] = frustum.planes[i];
+        }
+#endif
+    }
+
+    // the corner farthest along a plane's normal decides whether the box is outside it, the nearest one whether
+    // it's inside
+    uint32_t DynamicBVH::FrustumPlanes::Test(const AABB& bounds) const
+    {
+#ifdef ZEPHYR_BVH_SSE
+        __m128 minX = _mm_set1_ps(bounds.min.x);
+        __m128 minY = _mm_set1_ps(bounds.min.y);
+        __m128 minZ = _mm_set1_ps(bounds.min.z);
+        __m128 maxX = _mm_set1_ps(bounds.max.x);
+        __m128 maxY = _mm_set1_ps(bounds.max.y);
+        __m128 maxZ = _mm_set1_ps(bounds.max.z);
+        __m128 zero = _mm_setzero_ps();
+
+        int crossing = 0;
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            __m128 ax = _mm_mul_ps(x[i], minX);
+            __m128 bx = _mm_mul_ps(x[i], maxX);
+            __m128 ay = _mm_mul_ps(y[i], minY);
+            __m128 by = _mm_mul_ps(y[i], maxY);
+            __m128 az = _mm_mul_ps(z[i], minZ);
+            __m128 bz = _mm_mul_ps(z[i], maxZ);
+
+            __m128 farthest =
+                _mm_add_ps(_mm_add_ps(_mm_max_ps(ax, bx), _mm_max_ps(ay, by)), _mm_add_ps(_mm_max_ps(az, bz), w[i]));
+            if (_mm_movemask_ps(_mm_cmplt_ps(farthest, zero)))
+            {
+                return 0;
+            }
+
+            __m128 nearest =
+                _mm_add_ps(_mm_add_ps(_mm_min_ps(ax, bx), _mm_min_ps(ay, by)), _mm_add_ps(_mm_min_ps(az, bz), w[i]));
+            crossing |= _mm_movemask_ps(_mm_cmplt_ps(nearest, zero));
+        }
+        return crossing ? 1 : 2;
+#else
+        bool crossing = false;
+        for (auto& plane : planes)
+        {
+            glm::vec3 a        = glm::vec3(plane) * bounds.min;
+            glm::vec3 b        = glm::vec3(plane) * bounds.max;
+            glm::vec3 farthest = glm::max(a, b);
+            glm::vec3 nearest  = glm::min(a, b);
+            if (farthest.x + farthest.y + farthest.z + plane.w < 0.f)
+            {
+                return 0;
+            }
+            crossing |= nearest.x + nearest.y + nearest.z + plane.w < 0.f;
+        }
+        return crossing ? 1 : 2;
+#endif
+    }
+
+    uint32_t DynamicBVH::Insert(const AABB& bounds, uint32_t userData)
+    {
+        uint32_t leaf    = AllocateNode();
+        auto&    node    = m_Nodes[leaf];
+        node.bounds      = Fatten(bounds, FAT_MARGIN);
+        node.tight       = bounds;
+        node.parent      = NullNode;
+        node.children[0] = NullNode;
+        node.children[1] = NullNode;
+        node.userData    = userData;
+        node.height      = 0;
+        node.moved       = false;
+
+        InsertLeaf(leaf);
+        m_ProxyCount++;
+
+        // the query stacks are sized for MAX_HEIGHT
+        if (GetHeight() >= MAX_HEIGHT)
+        {
+            Rebuild();
+        }
+        return leaf;
+    }
+
+    void DynamicBVH::Remove(uint32_t proxy)
+    {
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_ProxyCount--;
+
+        if (m_ProxyCount == 0)
+        {
+            m_InternalArea = 0.;
+            m_RebuildCost  = 0.f;
+        }
+    }
+
+    bool DynamicBVH::Move(uint32_t proxy, const AABB& bounds)
+    {
+        auto& node = m_Nodes[proxy];
+        node.tight = bounds;
+        if (node.bounds.Contains(bounds))
+        {
+            return false;
+        }
+
+        // refit in place later, the sah rebuild takes care of the tree getting worse. marking stops at the first
+        // marked node, everything above it is marked already
+        node.bounds = Fatten(bounds, FAT_MARGIN);
+        for (uint32_t parent = node.parent; parent != NullNode && !m_Nodes[parent].moved;
+             parent          = m_Nodes[parent].parent)
+        {
+            m_Nodes[parent].moved = true;
+        }
+        return true;
+    }
+
+    void DynamicBVH::Optimize()
+    {
+        if (m_ProxyCount < 2)
+        {
+            return;
+        }
+        RefitMoved(m_Root);
+        if (m_RebuildCost == 0.f || GetCost() > m_RebuildCost * REBUILD_COST_RATIO)
+        {
+            Rebuild();
+        }
+    }
+
+    void DynamicBVH::Rebuild()
+    {
+        if (m_Root == NullNode)
+        {
+            return;
+        }
+
+        // leaves keep their nodes so the proxy ids survive. a tree over n leaves always has n - 1 internal nodes,
+        // the old ones are handed out again in ascending order so a depth first walk mostly moves forward
+        std::vector<BuildItem> items;
+        std::vector<uint32_t>  internal;
+        std::vector<uint32_t>  stack;
+        items.reserve(m_ProxyCount);
+        internal.reserve(m_ProxyCount);
+        stack.push_back(m_Root);
+        while (!stack.empty())
+        {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            auto& node = m_Nodes[index];
+            if (node.IsLeaf())
+            {
+                items.push_back({node.bounds, Center(node.bounds), index});
+                continue;
+            }
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+            internal.push_back(index);
+        }
+        std::sort(internal.begin(), internal.end());
+
+        const uint32_t* nodes  = internal.data();
+        m_InternalArea         = 0.;
+        m_Root                 = Build(items.data(), items.size(), 0, nodes);
+        m_Nodes[m_Root].parent = NullNode;
+        m_RebuildCost          = GetCost();
+    }
+
+    void DynamicBVH::Clear()
+    {
+        m_Nodes.clear();
+        m_Root         = NullNode;
+        m_FreeList     = NullNode;
+        m_ProxyCount   = 0;
+        m_InternalArea = 0.;
+        m_RebuildCost  = 0.f;
+    }
+
+    float DynamicBVH::GetCost() const
+    {
+        if (m_ProxyCount < 2)
+        {
+            return 1.f;
+        }
+        float rootArea = m_Nodes[m_Root].bounds.SurfaceArea();
+        return rootArea > 0.f ? float(m_InternalArea / rootArea) : 1.f;
+    }
+
+    uint32_t DynamicBVH::AllocateNode()
+    {
+        if (m_FreeList == NullNode)
+        {
+            m_Nodes.emplace_back();
+            return m_Nodes.size() - 1;
+        }
+        uint32_t node = m_FreeList;
+        m_FreeList    = m_Nodes[node].parent;
+        return node;
+    }
+
+    void DynamicBVH::FreeNode(uint32_t node)
+    {
+        m_Nodes[node].parent = m_FreeList;
+        m_FreeList           = node;
+    }
+
+    // walks down to the sibling whose new parent adds the least area to the tree, the area the new leaf adds to
+    // every node on the way is paid either way
+    void DynamicBVH::InsertLeaf(uint32_t leaf)
+    {
+        if (m_Root == NullNode)
+        {
+            m_Root               = leaf;
+            m_Nodes[leaf].parent = NullNode;
+            return;
+        }
+
+        AABB     bounds  = m_Nodes[leaf].bounds;
+        uint32_t sibling = m_Root;
+        while (!m_Nodes[sibling].IsLeaf())
+        {
+            auto& node         = m_Nodes[sibling];
+            float area         = node.bounds.SurfaceArea();
+            float combinedArea = AABB::Union(node.bounds, bounds).SurfaceArea();
+            // a new parent of this node and the leaf
+            float cost         = 2.f * combinedArea;
+            float inheritance  = 2.f * (combinedArea - area);
+
+            float childCost[2];
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                auto& child  = m_Nodes[node.children[i]];
+                float grown  = AABB::Union(child.bounds, bounds).SurfaceArea();
+                childCost[i] = (child.IsLeaf() ? grown : grown - child.bounds.SurfaceArea()) + inheritance;
+            }
+
+            if (cost < childCost[0] && cost < childCost[1])
+            {
+                break;
+            }
+            sibling = node.children[childCost[1] < childCost[0] ? 1 : 0];
+        }
+
+        uint32_t oldParent = m_Nodes[sibling].parent;
+        uint32_t parent    = AllocateNode();
+        auto&    node      = m_Nodes[parent];
+        node.bounds        = AABB();
+        node.parent        = oldParent;
+        node.children[0]   = sibling;
+        node.children[1]   = leaf;
+        node.userData      = NullProxy;
+        node.height        = m_Nodes[sibling].height + 1;
+        // a marked sibling still waits for its refit, the chain of marks down to it has to stay unbroken
+        node.moved         = m_Nodes[sibling].moved;
+        SetInternalBounds(parent, AABB::Union(m_Nodes[sibling].bounds, bounds));
+
+        if (oldParent == NullNode)
+        {
+            m_Root = parent;
+        }
+        else
+        {
+            auto& children = m_Nodes[oldParent].children;
+            children[children[0] == sibling ? 0 : 1] = parent;
+        }
+        m_Nodes[sibling].parent = parent;
+        m_Nodes[leaf].parent    = parent;
+
+        Refit(oldParent);
+    }
+
+    // the leaf's sibling takes the place of their parent
+    void DynamicBVH::RemoveLeaf(uint32_t leaf)
+    {
+        if (leaf == m_Root)
+        {
+            m_Root = NullNode;
+            return;
+        }
+
+        uint32_t parent      = m_Nodes[leaf].parent;
+        uint32_t grandParent = m_Nodes[parent].parent;
+        auto&    siblings    = m_Nodes[parent].children;
+        uint32_t sibling     = siblings[siblings[0] == leaf ? 1 : 0];
+
+        if (grandParent == NullNode)
+        {
+            m_Root = sibling;
+        }
+        else
+        {
+            auto& children = m_Nodes[grandParent].children;
+            children[children[0] == parent ? 0 : 1] = sibling;
+        }
+        m_Nodes[sibling].parent = grandParent;
+
+        m_InternalArea -= m_Nodes[parent].bounds.SurfaceArea();
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+
+    void DynamicBVH::Refit(uint32_t node)
+    {
+        while (node != NullNode)
+        {
+            auto&    current = m_Nodes[node];
+            auto&    a       = m_Nodes[current.children[0]];
+            auto&    b       = m_Nodes[current.children[1]];
+            AABB     bounds  = AABB::Union(a.bounds, b.bounds);
+            uint32_t height  = std::max(a.height, b.height) + 1;
+
+            // nothing above can change either
+            if (bounds.min == current.bounds.min && bounds.max == current.bounds.max && height == current.height)
+            {
+                return;
+            }
+            SetInternalBounds(node, bounds);
+            current.height = height;
+            node           = current.parent;
+        }
+    }
+
+    // the children of a marked node may be marked too, nodes that aren't have correct bounds
+    void DynamicBVH::RefitMoved(uint32_t node)
+    {
+        auto& current = m_Nodes[node];
+        if (!current.moved)
+        {
+            return;
+        }
+        current.moved = false;
+        RefitMoved(current.children[0]);
+        RefitMoved(current.children[1]);
+        SetInternalBounds(node, AABB::Union(m_Nodes[current.children[0]].bounds, m_Nodes[current.children[1]].bounds));
+    }
+
+    void DynamicBVH::SetInternalBounds(uint32_t node, const AABB& bounds)
+    {
+        auto& current = m_Nodes[node];
+        m_InternalArea += bounds.SurfaceArea() - current.bounds.SurfaceArea();
+        current.bounds = bounds;
+    }
+
+    // top down binned sah over the leaf centers, past MAX_SAH_DEPTH or when the centers can't be told apart the
+    // leaves are split at the median of the widest axis
+    uint32_t DynamicBVH::Build(BuildItem* items, uint32_t count, uint32_t depth, const uint32_t*& nodes)
+    {
+        if (count == 1)
+        {
+            return items[0].leaf;
+        }
+        uint32_t parent = *nodes++;
+
+        AABB centers = EMPTY_BOUNDS;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            centers.min = glm::min(centers.min, items[i].center);
+            centers.max = glm::max(centers.max, items[i].center);
+        }
+        glm::vec3 extent = centers.max - centers.min;
+        uint32_t  axis   = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+        uint32_t split = 0;
+        if (depth < MAX_SAH_DEPTH && extent[axis] > 0.f)
+        {
+            struct Bin
+            {
+                AABB     bounds = EMPTY_BOUNDS;
+                uint32_t count  = 0;
+            };
+            Bin   bins[SAH_BIN_COUNT];
+            float scale = SAH_BIN_COUNT / extent[axis];
+            auto  binOf = [&](const BuildItem& item) {
+                float offset = item.center[axis] - centers.min[axis];
+                return std::min(uint32_t(offset * scale), SAH_BIN_COUNT - 1);
+            };
+            for (uint32_t i = 0; i < count; i++)
+            {
+                auto& bin  = bins[binOf(items[i])];
+                bin.bounds = AABB::Union(bin.bounds, items[i].bounds);
+                bin.count++;
+            }
+
+            // area and count right of every boundary, then the cheapest boundary from the left
+            float    rightArea[SAH_BIN_COUNT];
+            uint32_t rightCount[SAH_BIN_COUNT];
+            AABB     right = EMPTY_BOUNDS;
+            uint32_t total = 0;
+            for (uint32_t i = SAH_BIN_COUNT - 1; i > 0; i--)
+            {
+                right         = AABB::Union(right, bins[i].bounds);
+                total        += bins[i].count;
+                rightArea[i]  = total ? right.SurfaceArea() : 0.f;
+                rightCount[i] = total;
+            }
+
+            AABB     left      = EMPTY_BOUNDS;
+            uint32_t leftCount = 0;
+            float    bestCost  = FLT_MAX;
+            uint32_t best      = 0;
+            for (uint32_t i = 1; i < SAH_BIN_COUNT; i++)
+            {
+                left = AABB::Union(left, bins[i - 1].bounds);
+                leftCount += bins[i - 1].count;
+                if (leftCount == 0 || rightCount[i] == 0)
+                {
+                    continue;
+                }
+                float cost = left.SurfaceArea() * leftCount + rightArea[i] * rightCount[i];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    best     = i;
+                }
+            }
+
+            if (best != 0)
+            {
+                split = std::partition(items, items + count, [&](const BuildItem& item) { return binOf(item) < best; }) -
+                        items;
+            }
+        }
+        if (split == 0 || split == count)
+        {
+            split = count / 2;
+            std::nth_element(items, items + split, items + count, [&](const BuildItem& a, const BuildItem& b) {
+                return a.center[axis] < b.center[axis];
+            });
+        }
+
+        uint32_t a       = Build(items, split, depth + 1, nodes);
+        uint32_t b       = Build(items + split, count - split, depth + 1, nodes);
+        auto&    node    = m_Nodes[parent];
+        node.bounds      = AABB::Union(m_Nodes[a].bounds, m_Nodes[b].bounds);
+        node.children[0] = a;
+        node.children[1] = b;
+        node.userData    = NullProxy;
+        node.height      = std::max(m_Nodes[a].height, m_Nodes[b].height) + 1;
+        node.moved       = false;
+        m_InternalArea  += node.bounds.SurfaceArea();
+
+        m_Nodes[a].parent = parent;
+        m_Nodes[b].parent = parent;
+        return parent;
+    }
+} // namespace Zephyr
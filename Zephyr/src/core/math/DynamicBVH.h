@@ -0,0 +1,293 @@
+#pragma once
+#include "pch.h"
+#include "core/math/AABB.h"
+#include "core/math/Frustum.h"
+#include "core/math/Ray.h"
+#include "core/math/Sphere.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ZEPHYR_BVH_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Zephyr
+{
+    /*
+        a binary aabb tree over proxies that come, go and move every frame.
+        leaves keep the tight bounds for the queries and a fattened copy for the tree, a proxy moving inside its
+        fattened box leaves the tree alone, one leaving it marks its path to the root and Optimize refits all
+        marked nodes in one bottom up pass. incremental inserts pick the sibling with the least sah growth,
+        Optimize rebuilds the whole tree with binned sah once the summed internal node area grew past
+        REBUILD_COST_RATIO times what the last rebuild left behind.
+        proxy ids stay the same across rebuilds, the user data is what queries report.
+    */
+    class DynamicBVH final
+    {
+    public:
+        static constexpr uint32_t NullProxy = ~0u;
+
+        DynamicBVH() = default;
+
+        uint32_t Insert(const AABB& bounds, uint32_t userData);
+        void     Remove(uint32_t proxy);
+        // false if the bounds still fit the fattened leaf and the tree was left as it was, otherwise queries can
+        // miss the proxy until the next Optimize
+        bool     Move(uint32_t proxy, const AABB& bounds);
+        // refits what moved and rebuilds the tree if it degraded too much, meant to run once after a frame's moves
+        void     Optimize();
+        void     Rebuild();
+        void     Clear();
+
+        inline void        SetUserData(uint32_t proxy, uint32_t userData) { m_Nodes[proxy].userData = userData; }
+        inline uint32_t    GetUserData(uint32_t proxy) const { return m_Nodes[proxy].userData; }
+        inline const AABB& GetBounds(uint32_t proxy) const { return m_Nodes[proxy].tight; }
+        inline uint32_t    GetProxyCount() const { return m_ProxyCount; }
+        inline uint32_t    GetHeight() const { return m_Root == NullNode ? 0 : m_Nodes[m_Root].height; }
+        // internal node area over root area, the expected number of node visits of a random query
+        float              GetCost() const;
+
+        // fn(userData) for every proxy whose bounds intersect the query volume
+        template<typename F>
+        void Query(const Frustum& frustum, F&& fn) const;
+        template<typename F>
+        void Query(const AABB& bounds, F&& fn) const;
+        template<typename F>
+        void Query(const Sphere& sphere, F&& fn) const;
+        // fn(userData, distance) with the distance along the ray where it enters the bounds, in no particular order
+        template<typename F>
+        void Query(const Ray& ray, F&& fn) const;
+
+    private:
+        static constexpr uint32_t NullNode = ~0u;
+        // deepest tree the query stacks can walk, Insert rebuilds before the tree outgrows it
+        static constexpr uint32_t MAX_HEIGHT         = 120;
+        static constexpr uint32_t SAH_BIN_COUNT      = 12;
+        // deeper down the rebuild splits at the median instead of by sah, which bounds the height
+        static constexpr uint32_t MAX_SAH_DEPTH      = 24;
+        static constexpr float    REBUILD_COST_RATIO = 1.5f;
+        // fattened leaves grow by this much of their largest extent on every side
+        static constexpr float    FAT_MARGIN         = .1f;
+
+        struct Node
+        {
+            // fattened for leaves
+            AABB     bounds;
+            // leaves only
+            AABB     tight;
+            uint32_t parent;
+            // NullNode for leaves, parent doubles as the next free node
+            uint32_t children[2];
+            uint32_t userData;
+            uint32_t height;
+            // internal nodes above a leaf that left its fattened box, waiting for RefitMoved
+            bool     moved;
+
+            inline bool IsLeaf() const { return children[0] == NullNode; }
+        };
+
+        // 0 outside, 1 intersecting, 2 fully inside. planes in sse lanes, the two unused lanes never reject
+        struct FrustumPlanes
+        {
+#ifdef ZEPHYR_BVH_SSE
+            __m128 x[2], y[2], z[2], w[2];
+#else
+            glm::vec4 planes[Frustum::PlaneCount];
+#endif
+            explicit FrustumPlanes(const Frustum& frustum);
+            uint32_t Test(const AABB& bounds) const;
+        };
+
+        uint32_t AllocateNode();
+        void     FreeNode(uint32_t node);
+        void     InsertLeaf(uint32_t leaf);
+        void     RemoveLeaf(uint32_t leaf);
+        // recomputes bounds and heights from node up to the root
+        void     Refit(uint32_t node);
+        void     RefitMoved(uint32_t node);
+        void     SetInternalBounds(uint32_t node, const AABB& bounds);
+        struct BuildItem;
+        // internal nodes are taken from the front of nodes in preorder
+        uint32_t Build(BuildItem* items, uint32_t count, uint32_t depth, const uint32_t*& nodes);
+
+        static bool Overlaps(const AABB& a, const AABB& b);
+        static bool Overlaps(const AABB& bounds, const glm::vec4& sphere);
+        // entry distance, or a negative value on a miss
+        static float Intersect(const AABB& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                               float maxDistance);
+
+        template<typename Test, typename Visit>
+        void Traverse(Test&& test, Visit&& visit) const;
+        template<typename F>
+        void VisitSubtree(uint32_t node, F& fn) const;
+
+    private:
+        std::vector<Node> m_Nodes;
+        uint32_t          m_Root       = NullNode;
+        uint32_t          m_FreeList   = NullNode;
+        uint32_t          m_ProxyCount = 0;
+
+        // summed surface area of the internal nodes, double so the running sum doesn't drift
+        double m_InternalArea = 0.;
+        // GetCost right after the last rebuild, 0 if there never was one
+        float  m_RebuildCost  = 0.f;
+    };
+
+    inline bool DynamicBVH::Overlaps(const AABB& a, const AABB& b)
+    {
+#ifdef ZEPHYR_BVH_SSE
+        // the 4th lane repeats x so it agrees with the others
+        __m128 aMin = _mm_setr_ps(a.min.x, a.min.y, a.min.z, a.min.x);
+        __m128 aMax = _mm_setr_ps(a.max.x, a.max.y, a.max.z, a.max.x);
+        __m128 bMin = _mm_setr_ps(b.min.x, b.min.y, b.min.z, b.min.x);
+        __m128 bMax = _mm_setr_ps(b.max.x, b.max.y, b.max.z, b.max.x);
+        return _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(aMin, bMax), _mm_cmple_ps(bMin, aMax))) == 0xF;
+#else
+        return a.Overlaps(b);
+#endif
+    }
+
+    inline bool DynamicBVH::Overlaps(const AABB& bounds, const glm::vec4& sphere)
+    {
+#ifdef ZEPHYR_BVH_SSE
+        // distance from the center to the closest point of the box, the 4th lane is 0 and adds nothing
+        __m128 center = _mm_setr_ps(sphere.x, sphere.y, sphere.z, 0.f);
+        __m128 min    = _mm_setr_ps(bounds.min.x, bounds.min.y, bounds.min.z, 0.f);
+        __m128 max    = _mm_setr_ps(bounds.max.x, bounds.max.y, bounds.max.z, 0.f);
+        __m128 zero   = _mm_setzero_ps();
+        __m128 d      = _mm_add_ps(_mm_max_ps(_mm_sub_ps(min, center), zero), _mm_max_ps(_mm_sub_ps(center, max), zero));
+        d             = _mm_mul_ps(d, d);
+        d             = _mm_add_ps(d, _mm_movehl_ps(d, d));
+        d             = _mm_add_ss(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(d) <= sphere.w * sphere.w;
+#else
+        glm::vec3 d = glm::max(bounds.min - glm::vec3(sphere), glm::vec3(0.f)) +
+                      glm::max(glm::vec3(sphere) - bounds.max, glm::vec3(0.f));
+        return glm::dot(d, d) <= sphere.w * sphere.w;
+#endif
+    }
+
+    inline float DynamicBVH::Intersect(const AABB& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                                       float maxDistance)
+    {
+#ifdef ZEPHYR_BVH_SSE
+        // slab test, the 4th lane repeats x
+        __m128 o     = _mm_setr_ps(origin.x, origin.y, origin.z, origin.x);
+        __m128 inv   = _mm_setr_ps(inverseDirection.x, inverseDirection.y, inverseDirection.z, inverseDirection.x);
+        __m128 t0    = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(bounds.min.x, bounds.min.y, bounds.min.z, bounds.min.x), o), inv);
+        __m128 t1    = _mm_mul_ps(_mm_sub_ps(_mm_setr_ps(bounds.max.x, bounds.max.y, bounds.max.z, bounds.max.x), o), inv);
+        __m128 enter = _mm_min_ps(t0, t1);
+        __m128 exit  = _mm_max_ps(t0, t1);
+        enter        = _mm_max_ps(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(2, 1, 0, 3)));
+        enter        = _mm_max_ps(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(1, 0, 3, 2)));
+        exit         = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(2, 1, 0, 3)));
+        exit         = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(1, 0, 3, 2)));
+        float tEnter = std::max(_mm_cvtss_f32(enter), 0.f);
+        float tExit  = std::min(_mm_cvtss_f32(exit), maxDistance);
+#else
+        glm::vec3 t0     = (bounds.min - origin) * inverseDirection;
+        glm::vec3 t1     = (bounds.max - origin) * inverseDirection;
+        glm::vec3 enter  = glm::min(t0, t1);
+        glm::vec3 exit   = glm::max(t0, t1);
+        float     tEnter = std::max(std::max(enter.x, enter.y), std::max(enter.z, 0.f));
+        float     tExit  = std::min(std::min(exit.x, exit.y), std::min(exit.z, maxDistance));
+#endif
+        return tEnter <= tExit ? tEnter : -1.f;
+    }
+
+    template<typename F>
+    void DynamicBVH::VisitSubtree(uint32_t node, F& fn) const
+    {
+        uint32_t stack[MAX_HEIGHT + 1];
+        uint32_t size = 0;
+        stack[size++] = node;
+        while (size > 0)
+        {
+            auto& current = m_Nodes[stack[--size]];
+            if (current.IsLeaf())
+            {
+                fn(current.userData);
+                continue;
+            }
+            stack[size++] = current.children[1];
+            stack[size++] = current.children[0];
+        }
+    }
+
+    // test(bounds) returns 0 to skip, 1 to descend and 2 to take the whole subtree, visit(userData) gets the hits
+    template<typename Test, typename Visit>
+    void DynamicBVH::Traverse(Test&& test, Visit&& visit) const
+    {
+        if (m_Root == NullNode)
+        {
+            return;
+        }
+
+        uint32_t stack[MAX_HEIGHT + 1];
+        uint32_t size = 0;
+        stack[size++] = m_Root;
+        while (size > 0)
+        {
+            uint32_t index = stack[--size];
+            auto&    node  = m_Nodes[index];
+            if (node.IsLeaf())
+            {
+                if (test(node.tight))
+                {
+                    visit(node.userData);
+                }
+                continue;
+            }
+
+            uint32_t result = test(node.bounds);
+            if (result == 2)
+            {
+                VisitSubtree(index, visit);
+            }
+            else if (result == 1)
+            {
+                stack[size++] = node.children[1];
+                stack[size++] = node.children[0];
+            }
+        }
+    }
+
+    template<typename F>
+    void DynamicBVH::Query(const Frustum& frustum, F&& fn) const
+    {
+        FrustumPlanes planes(frustum);
+        Traverse([&](const AABB& bounds) { return planes.Test(bounds); }, fn);
+    }
+
+    template<typename F>
+    void DynamicBVH::Query(const AABB& query, F&& fn) const
+    {
+        Traverse([&](const AABB& bounds) -> uint32_t { return Overlaps(bounds, query) ? 1 : 0; }, fn);
+    }
+
+    template<typename F>
+    void DynamicBVH::Query(const Sphere& sphere, F&& fn) const
+    {
+        glm::vec4 s = {sphere.m_Center, sphere.m_Radius};
+        Traverse([&](const AABB& bounds) -> uint32_t { return Overlaps(bounds, s) ? 1 : 0; }, fn);
+    }
+
+    template<typename F>
+    void DynamicBVH::Query(const Ray& ray, F&& fn) const
+    {
+        // axis parallel directions get a huge instead of an infinite inverse, 0 * inf would poison the slabs
+        glm::vec3 inverse;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            float d       = ray.direction[axis];
+            inverse[axis] = 1.f / (std::abs(d) < 1e-20f ? (d < 0.f ? -1e-20f : 1e-20f) : d);
+        }
+
+        float distance = 0.f;
+        Traverse(
+            [&](const AABB& bounds) -> uint32_t {
+                distance = Intersect(bounds, ray.origin, inverse, ray.maxDistance);
+                return distance >= 0.f ? 1 : 0;
+            },
+            [&](uint32_t userData) { fn(userData, distance); });
+    }
+} // namespace Zephyr
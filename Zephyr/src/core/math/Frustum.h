@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    /*
+        the six planes of a view projection volume, normals point inwards and are normalized so
+        dot(plane.xyz, p) + plane.w is the signed distance of p. planes are taken from the matrix rows,
+        the clip depth is [0, 1] like every projection of the engine
+    */
+    struct Frustum
+    {
+        enum Plane
+        {
+            Left,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far,
+            PlaneCount,
+        };
+
+        glm::vec4 planes[PlaneCount];
+
+        Frustum() = default;
+
+        explicit Frustum(const glm::mat4& vp)
+        {
+            glm::vec4 x = {vp[0][0], vp[1][0], vp[2][0], vp[3][0]};
+            glm::vec4 y = {vp[0][1], vp[1][1], vp[2][1], vp[3][1]};
+            glm::vec4 z = {vp[0][2], vp[1][2], vp[2][2], vp[3][2]};
+            glm::vec4 w = {vp[0][3], vp[1][3], vp[2][3], vp[3][3]};
+
+            planes[Left]   = w + x;
+            planes[Right]  = w - x;
+            planes[Bottom] = w + y;
+            planes[Top]    = w - y;
+            planes[Near]   = z;
+            planes[Far]    = w - z;
+
+            for (auto& plane : planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+        }
+    };
+} // namespace Zephyr
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+namespace Zephyr
+{
+    /*
+        xorshift64* seeded through splitmix64. the sequence only depends on the seed, unlike the std
+        distributions whose output differs between standard libraries, so seeded content is identical
+        on every compiler and machine.
+    */
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed)
+        {
+            uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+            z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            m_State    = (z ^ (z >> 31)) | 1;
+        }
+
+        uint64_t Next()
+        {
+            m_State ^= m_State >> 12;
+            m_State ^= m_State << 25;
+            m_State ^= m_State >> 27;
+            return m_State * 0x2545F4914F6CDD1Dull;
+        }
+
+        // [0, 1)
+        float Float() { return (Next() >> 40) * (1.f / 16777216.f); }
+
+        float Range(float min, float max) { return min + (max - min) * Float(); }
+
+        // [0, count)
+        uint32_t Index(uint32_t count) { return (uint32_t)((Next() >> 32) % count); }
+
+    private:
+        uint64_t m_State;
+    };
+} // namespace Zephyr
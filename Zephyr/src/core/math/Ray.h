@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cfloat>
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    // points origin + t * direction for t in [0, maxDistance], direction doesn't have to be normalized
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        float     maxDistance = FLT_MAX;
+    };
+} // namespace Zephyr
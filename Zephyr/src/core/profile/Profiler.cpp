@@ -0,0 +1,185 @@
+#include "Profiler.h"
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+namespace Zephyr
+{
+    namespace
+    {
+        // written by its owning thread only, count is published after the event so readers never see a partial one
+        struct ThreadBuffer
+        {
+            uint32_t              threadIndex = 0;
+            std::atomic<uint64_t> count {0};
+            ProfileEvent          events[PROFILER_EVENTS_PER_THREAD];
+        };
+
+        struct ThreadRegistry
+        {
+            std::mutex                                 mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        };
+
+        ThreadRegistry& GetRegistry()
+        {
+            static ThreadRegistry registry;
+            return registry;
+        }
+
+        ThreadBuffer* GetThreadBuffer()
+        {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (buffer == nullptr)
+            {
+                auto&                       registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+
+                auto& owned        = registry.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+                owned->threadIndex = registry.buffers.size() - 1;
+                buffer             = owned.get();
+            }
+            return buffer;
+        }
+
+        // frames are marked on the main thread only
+        uint64_t              s_Frames[PROFILER_FRAME_HISTORY];
+        std::atomic<uint64_t> s_FrameCount {0};
+
+        const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+        void WriteEscaped(std::ofstream& file, const char* name)
+        {
+            for (auto c = name; *c != '\0'; c++)
+            {
+                if (*c == '"' || *c == '\\')
+                {
+                    file << '\\';
+                }
+                file << *c;
+            }
+        }
+    } // namespace
+
+    uint64_t Profiler::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+    }
+
+    void Profiler::RecordZone(const char* name, uint64_t begin, uint64_t end)
+    {
+        auto     buffer = GetThreadBuffer();
+        uint64_t index  = buffer->count.load(std::memory_order_relaxed);
+
+        buffer->events[index % PROFILER_EVENTS_PER_THREAD] = {name, begin, end};
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::MarkFrame()
+    {
+        uint64_t index = s_FrameCount.load(std::memory_order_relaxed);
+
+        s_Frames[index % PROFILER_FRAME_HISTORY] = Now();
+        s_FrameCount.store(index + 1, std::memory_order_release);
+    }
+
+    bool Profiler::ExportChromeTrace(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            printf("Failed to open profile trace %s\n", path.c_str());
+            return false;
+        }
+
+        // timestamps are in microseconds and grow large, the default stream format would cut them to 6 digits
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+
+        auto& registry = GetRegistry();
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (auto& buffer : registry.buffers)
+            {
+                uint64_t count = buffer->count.load(std::memory_order_acquire);
+                uint64_t begin = count > PROFILER_EVENTS_PER_THREAD ? count - PROFILER_EVENTS_PER_THREAD : 0;
+                for (uint64_t i = begin; i < count; i++)
+                {
+                    auto& event = buffer->events[i % PROFILER_EVENTS_PER_THREAD];
+
+                    file << (first ? "" : ",\n") << "{\"name\":\"";
+                    WriteEscaped(file, event.name);
+                    file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+                         << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0
+                         << "}";
+                    first = false;
+                }
+            }
+        }
+
+        // frame time as a counter track, one sample at the start of every frame
+        uint64_t frameCount = s_FrameCount.load(std::memory_order_acquire);
+        uint64_t frameBegin = frameCount > PROFILER_FRAME_HISTORY ? frameCount - PROFILER_FRAME_HISTORY : 0;
+        for (uint64_t i = frameBegin + 1; i < frameCount; i++)
+        {
+            uint64_t previous = s_Frames[(i - 1) % PROFILER_FRAME_HISTORY];
+            uint64_t current  = s_Frames[i % PROFILER_FRAME_HISTORY];
+
+            file << (first ? "" : ",\n") << "{\"name\":\"frame time\",\"ph\":\"C\",\"pid\":0,\"ts\":" << previous / 1000.0
+                 << ",\"args\":{\"ms\":" << (current - previous) / 1000000.0 << "}}";
+            first = false;
+        }
+
+        file << "\n]}\n";
+        return true;
+    }
+
+    std::vector<uint32_t> Profiler::GetFrameHistogram(float bucketWidth, uint32_t bucketCount)
+    {
+        std::vector<uint32_t> histogram(bucketCount, 0);
+        if (bucketCount == 0)
+        {
+            return histogram;
+        }
+
+        uint64_t frameCount = s_FrameCount.load(std::memory_order_acquire);
+        uint64_t frameBegin = frameCount > PROFILER_FRAME_HISTORY ? frameCount - PROFILER_FRAME_HISTORY : 0;
+        for (uint64_t i = frameBegin + 1; i < frameCount; i++)
+        {
+            float ms = (s_Frames[i % PROFILER_FRAME_HISTORY] - s_Frames[(i - 1) % PROFILER_FRAME_HISTORY]) / 1000000.f;
+            uint32_t bucket = std::min<uint32_t>(ms / bucketWidth, bucketCount - 1);
+            histogram[bucket]++;
+        }
+        return histogram;
+    }
+
+    void Profiler::PrintFrameHistogram()
+    {
+        const float    bucketWidth = 2.f;
+        const uint32_t bucketCount = 17;
+
+        auto     histogram = GetFrameHistogram(bucketWidth, bucketCount);
+        uint32_t peak      = 1;
+        for (auto count : histogram)
+        {
+            peak = std::max(peak, count);
+        }
+
+        printf("frame time (ms)\n");
+        for (uint32_t i = 0; i < bucketCount; i++)
+        {
+            uint32_t bar = histogram[i] * 50 / peak;
+            if (i == bucketCount - 1)
+            {
+                printf("%5.0f+     %6u ", i * bucketWidth, histogram[i]);
+            }
+            else
+            {
+                printf("%5.0f-%-5.0f%6u ", i * bucketWidth, (i + 1) * bucketWidth, histogram[i]);
+            }
+            printf("%s\n", std::string(bar, '#').c_str());
+        }
+    }
+} // namespace Zephyr
@@ -0,0 +1,65 @@
+#pragma once
+#include "pch.h"
+#include "core/macro.h"
+
+namespace Zephyr
+{
+    // zones kept per thread, the oldest are overwritten once a thread records more
+    inline constexpr uint32_t PROFILER_EVENTS_PER_THREAD = 1 << 16;
+    // frame markers kept for the frame time histogram and the trace
+    inline constexpr uint32_t PROFILER_FRAME_HISTORY = 1 << 14;
+
+    struct ProfileEvent
+    {
+        // static string, zones never copy their names
+        const char* name;
+        // nanoseconds since the profiler started
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /*
+        cpu scoped-zone profiler.
+        every thread records into its own event buffer, the only shared state is the list of buffers which is
+        touched once per thread. use the ZEPHYR_PROFILE_* macros, they compile out without ZEPHYR_PROFILE.
+        zones are named by hand and qualified like "Renderer::Render", __FUNCTION__ drops the class on gcc and clang.
+    */
+    class Profiler final
+    {
+    public:
+        static uint64_t Now();
+
+        static void RecordZone(const char* name, uint64_t begin, uint64_t end);
+        static void MarkFrame();
+
+        // chrome://tracing or perfetto json, every thread's zones plus a frame time counter
+        static bool ExportChromeTrace(const std::string& path);
+
+        // frame time in milliseconds, the last bucket also counts everything above it
+        static std::vector<uint32_t> GetFrameHistogram(float bucketWidth, uint32_t bucketCount);
+        static void                  PrintFrameHistogram();
+    };
+
+    class ProfileZone final
+    {
+    public:
+        explicit ProfileZone(const char* name) : m_Name(name), m_Begin(Profiler::Now()) {}
+        ~ProfileZone() { Profiler::RecordZone(m_Name, m_Begin, Profiler::Now()); }
+
+        DISALE_COPY_AND_MOVE(ProfileZone);
+
+    private:
+        const char* m_Name;
+        uint64_t    m_Begin;
+    };
+} // namespace Zephyr
+
+#ifdef ZEPHYR_PROFILE
+#define ZEPHYR_PROFILE_CONCAT_I(a, b) a##b
+#define ZEPHYR_PROFILE_CONCAT(a, b) ZEPHYR_PROFILE_CONCAT_I(a, b)
+#define ZEPHYR_PROFILE_ZONE(name) ::Zephyr::ProfileZone ZEPHYR_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define ZEPHYR_PROFILE_FRAME() ::Zephyr::Profiler::MarkFrame()
+#else
+#define ZEPHYR_PROFILE_ZONE(name)
+#define ZEPHYR_PROFILE_FRAME()
+#endif
@@ -1,6 +1,8 @@
 #include "Engine.h"
 #include "core/event/EventSystem.h"
 #include "core/event/KeyboardEvent.h"
+#include "core/job/JobSystem.h"
+#include "core/profile/Profiler.h"
 #include "platform/Path.h"
 #include "platform/Window.h"
 #include "rhi/Driver.h"
@@ -24,10 +26,21 @@ namespace Zephyr
 
     Engine::Engine(const EngineDescription& desc) : m_Description(desc), m_ResourceManager(this)
     {
+        // created first so the constructing thread, the one glfw lives on, is its main thread
+        uint32_t workers = desc.workerCount;
+        if (workers == ~0u)
+        {
+            workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        }
+        m_JobSystem = new JobSystem(workers);
+
         EventCenter::Init();
         // initialize rendering context
-        m_Window = new Window({desc.width, desc.height, desc.title, desc.resize, desc.fulscreen});
-        m_Window->Init();
+        if (!desc.headless)
+        {
+            m_Window = new Window({desc.width, desc.height, desc.title, desc.resize, desc.fulscreen});
+            m_Window->Init();
+        }
 
         EventCenter::Register<KeyPressedEvent>([this](KeyPressedEvent& event) {
             switch (event.GetKeyCode())
@@ -38,7 +51,8 @@ namespace Zephyr
             return false;
         });
 
-        m_Driver = Driver::Create(desc.driver, m_Window);
+        m_Driver = desc.headless ? Driver::CreateHeadless(desc.driver, desc.width, desc.height)
+                                 : Driver::Create(desc.driver, m_Window);
 
         m_ResourceManager.InitResources(m_Driver);
     }
@@ -52,6 +66,7 @@ namespace Zephyr
         {
             delete scene.second;
         }
+        delete m_JobSystem;
     }
 
     float Engine::GetDeltaTime()
@@ -79,7 +94,12 @@ namespace Zephyr
         m_LastTimePoint = std::chrono::steady_clock::now();
         while (!m_ShouldClose)
         {
-            m_Window->PollEvents();
+            ZEPHYR_PROFILE_FRAME();
+            if (m_Window)
+            {
+                m_Window->PollEvents();
+            }
+            m_JobSystem->RunMainThreadJobs();
             // update scene
             float delta = GetDeltaTime();
             a += delta / 1000000;
@@ -88,7 +108,16 @@ namespace Zephyr
             {
                 scene.second->Tick(delta / 1000000);
             }
+            m_GpuProfiler.Collect(m_Driver->GetGpuTimings());
+            if (m_FrameCallback)
+            {
+                m_FrameCallback(this);
+            }
             m_FrameCount++;
+            if (m_Description.frameLimit && m_FrameCount >= m_Description.frameLimit)
+            {
+                m_ShouldClose = true;
+            }
         }
         m_Driver->WaitIdle();
 
@@ -99,6 +128,11 @@ namespace Zephyr
         std::cout << "--------------------------------------\n";
         std::cout << "Average Time: " << a / frame << std::endl;
         std::cout << "--------------------------------------\n";
+        m_GpuProfiler.Print();
+#ifdef ZEPHYR_PROFILE
+        Profiler::PrintFrameHistogram();
+        Profiler::ExportChromeTrace("zephyr_trace.json");
+#endif
     }
 
     Scene* Engine::CreateScene(const std::string& debugName)
@@ -117,6 +151,10 @@ namespace Zephyr
 
     std::pair<uint32_t, uint32_t> Engine::GetWindowDimension()
     {
+        if (!m_Window)
+        {
+            return {m_Description.width, m_Description.height};
+        }
         uint32_t width, height;
         m_Window->GetFramebufferSize(&width, &height);
 
@@ -125,12 +163,21 @@ namespace Zephyr
 
     ShaderSet* Engine::GetShaderSet(const std::string& name) { return m_ResourceManager.GetShaderSet(name); }
 
+    ShaderSet* Engine::GetShaderSet(const std::string& name, const std::vector<uint32_t>& specialization)
+    {
+        return m_ResourceManager.GetShaderSet(name, specialization);
+    }
+
     Texture* Engine::GetDefaultSkybox() { return m_ResourceManager.GetDefaultSkybox(); }
     Texture* Engine::GetDefaultPrefilteredEnv() { return m_ResourceManager.GetDefaultPrefilteredEnv(); }
     Texture* Engine::GetBRDFLut() { return m_ResourceManager.GetBRDFLut(); }
     Texture* Engine::GetDither() { return m_ResourceManager.GetDither(); }
     Mesh*    Engine::GetSkyboxMesh() { return m_ResourceManager.GetSkyboxMesh(); }
 
+    GeometryPool* Engine::GetGeometryPool() { return m_ResourceManager.GetGeometryPool(); }
+
+    std::vector<Texture*> Engine::TakePendingMipTextures() { return m_ResourceManager.TakePendingMipTextures(); }
+
     MaterialInstance* Engine::CreateMaterial(ShadingModel shading)
     {
         return m_ResourceManager.CreateMaterialInstance(shading);
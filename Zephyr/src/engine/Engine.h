@@ -2,6 +2,8 @@
 #include "pch.h"
 
 #include "core/macro.h"
+#include "render/GpuProfiler.h"
+#include "render/Renderer.h"
 #include "resource/Buffer.h"
 #include "resource/Material.h"
 #include "resource/Mesh.h"
@@ -17,9 +19,11 @@ namespace Zephyr
 {
     class Window;
     class Driver;
+    class JobSystem;
     class Scene;
     class View;
     class Mesh;
+    class GeometryPool;
     using SceneHandle = uint32_t;
     using ViewHandle  = uint32_t;
 
@@ -32,6 +36,12 @@ namespace Zephyr
         bool        fulscreen;
         bool        resize;
         bool        debug;
+        // no window, frames go to offscreen images of width x height
+        bool     headless   = false;
+        // Run returns after this many frames, 0 runs until closed
+        uint64_t frameLimit = 0;
+        // job system workers besides the main thread, ~0u picks one per remaining core
+        uint32_t workerCount = ~0u;
     };
 
     /*
@@ -42,6 +52,7 @@ namespace Zephyr
     {
     public:
         using SetupCallback = std::function<void(Engine*)>;
+        using FrameCallback = std::function<void(Engine*)>;
         static Engine* Create(const EngineDescription& desc);
         static bool    Destroy(Engine* engine);
 
@@ -50,6 +61,8 @@ namespace Zephyr
         inline Driver* GetDriver() { return m_Driver; }
 
         void            Run(SetupCallback&& setup);
+        // called at the end of every frame, after the scenes ticked
+        inline void     SetFrameCallback(FrameCallback&& callback) { m_FrameCallback = std::move(callback); }
         inline uint64_t GetFrame() { return m_FrameCount; }
 
         Scene* CreateScene(const std::string& debugName);
@@ -61,13 +74,28 @@ namespace Zephyr
         Mesh*                         CreateMesh(const std::string& path);
         std::pair<uint32_t, uint32_t> GetWindowDimension();
         ShaderSet*                    GetShaderSet(const std::string& name);
+        ShaderSet* GetShaderSet(const std::string& name, const std::vector<uint32_t>& specialization);
         Texture*                      GetDefaultSkybox();
         Texture*                      GetDefaultPrefilteredEnv();
         Texture*                      GetBRDFLut();
         Texture*                      GetDither();
         Mesh*                         GetSkyboxMesh();
+        GeometryPool*                 GetGeometryPool();
+        std::vector<Texture*>         TakePendingMipTextures();
         MaterialInstance*             CreateMaterial(ShadingModel shading);
 
+        // rolling gpu timings of the frame graph passes
+        inline GpuProfiler* GetGpuProfiler() { return &m_GpuProfiler; }
+
+        inline JobSystem* GetJobSystem() { return m_JobSystem; }
+
+        // post stack switches and color grading every scene renders with
+        inline void SetPostProcessSettings(const PostProcessSettings& settings) { m_PostProcess = settings; }
+        inline void SetColorGrading(const ColorGradingConstant& grading) { m_ColorGrading = grading; }
+
+        inline const PostProcessSettings&  GetPostProcessSettings() const { return m_PostProcess; }
+        inline const ColorGradingConstant& GetColorGrading() const { return m_ColorGrading; }
+
     private:
         Engine(const EngineDescription& desc);
         ~Engine();
@@ -78,12 +106,18 @@ namespace Zephyr
         EngineDescription m_Description;
         uint64_t          m_FrameCount = 0;
 
-        Window* m_Window;
+        Window* m_Window = nullptr;
         Driver* m_Driver;
 
         ResourceManager m_ResourceManager;
+        GpuProfiler     m_GpuProfiler;
+        JobSystem*      m_JobSystem;
+
+        PostProcessSettings  m_PostProcess {};
+        ColorGradingConstant m_ColorGrading {};
 
         std::unordered_map<std::string, Scene*> m_Scenes;
+        FrameCallback                           m_FrameCallback;
 
         bool m_ShouldClose = false;
 
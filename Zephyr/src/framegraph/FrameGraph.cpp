@@ -1,10 +1,12 @@
 #include "FrameGraph.h"
+#include "core/profile/Profiler.h"
 #include "engine/Engine.h"
 
 namespace Zephyr
 {
     void FrameGraph::Compile()
     {
+        ZEPHYR_PROFILE_ZONE("FrameGraph::Compile");
         m_Graph.Cull();
 
         // add resource dependencies
@@ -58,6 +60,7 @@ namespace Zephyr
 
     void FrameGraph::Execute()
     {
+        ZEPHYR_PROFILE_ZONE("FrameGraph::Execute");
         for (auto& node : m_ActivePassNodes)
         {
             // devirtualize
@@ -87,6 +90,23 @@ namespace Zephyr
         return FrameGraphResourceHandle<FrameGraphTexture>(id);
     }
 
+    FrameGraphResourceHandle<FrameGraphTexture> FrameGraph::ImportTexture(const TextureDescription& desc,
+                                                                          Handle<RHITexture>        texture)
+    {
+        uint32_t resourceId = m_VirtualResources.size();
+        uint32_t nodeId     = m_ResourceNodes.size();
+
+        uint32_t id = m_Slots.size();
+
+        auto vr           = new VirtualResource(desc, texture);
+        auto resourceNode = CreateResourceNode(id);
+        m_VirtualResources.push_back(vr);
+        m_ResourceNodes.push_back(resourceNode);
+        m_Slots.push_back({resourceId, nodeId});
+
+        return FrameGraphResourceHandle<FrameGraphTexture>(id);
+    }
+
     FrameGraphResourceHandle<FrameGraphTexture>
     FrameGraph::CreateSubresource(FrameGraphResourceHandle<FrameGraphTexture>     parent,
                                   const FrameGraphTexture::SubresourceDescriptor& desc)
@@ -65,6 +65,11 @@ namespace Zephyr
         // create a texture handle. this would also create a virtual resource and a resource node
         FrameGraphResourceHandle<FrameGraphTexture> CreateTexture(const TextureDescription& desc, bool external = false);
 
+        // wrap a texture owned outside the frame graph. it is never created or released by the graph, so its content
+        // survives across frames(e.g. cached shadow maps, history buffers)
+        FrameGraphResourceHandle<FrameGraphTexture> ImportTexture(const TextureDescription& desc,
+                                                                  Handle<RHITexture>        texture);
+
         // this creates a subresource from the "main" resource. subresource represents a view into the actual resource.
         // for example, for cascaded shadow map, the shadowmap texture would be the "main" resource, and each layer of
         // which each cascade renders into would be a subresource. a write/ read from the subresource is effectively a write/ read
@@ -8,12 +8,16 @@ namespace Zephyr
 
     void FrameGraphTexture::Create(RenderResourceManager* manager, const TextureDescription& desc)
     {
+        if (m_Imported)
+        {
+            return;
+        }
         m_Handle = manager->CreateTexture(desc, m_External);
     }
     void FrameGraphTexture::Destroy(RenderResourceManager* manager)
     {
         assert(m_Handle.IsValid());
-        if (m_External)
+        if (m_External || m_Imported)
         {
             return;
         }
@@ -37,7 +37,8 @@ namespace Zephyr
     {};
     // a framegraph resource is a handle to the actual backend resource.
     // the backend resource will be created when the frame graph finished culling unused node and begin executing
-    // the backend resource will be destroyed(internally cached) when the execution finishes
+    // the backend resource will be destroyed(internally cached) when the execution finishes.
+    // imported resources are owned outside of the frame graph and persist across frames
     class FrameGraphTexture : public FrameGraphResource
     {
     public:
@@ -61,6 +62,7 @@ namespace Zephyr
         };
 
         FrameGraphTexture(bool external = false) : m_External(external) {};
+        FrameGraphTexture(Handle<RHITexture> imported) : m_Handle(imported), m_External(false), m_Imported(true) {};
         ~FrameGraphTexture() = default;
 
         void Create(RenderResourceManager* manager, const TextureDescription& desc);
@@ -70,5 +72,6 @@ namespace Zephyr
     private:
         Handle<RHITexture> m_Handle;
         bool               m_External;
+        bool               m_Imported = false;
     };
 } // namespace Zephyr
\ No newline at end of file
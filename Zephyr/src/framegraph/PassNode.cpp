@@ -34,6 +34,7 @@ namespace Zephyr
             RenderTargetDescription rtDesc {};
             rtDesc.useDepthStencil = m_RTDescriptor.useDepth;
             rtDesc.present         = m_RTDescriptor.present;
+            rtDesc.multiview       = m_RTDescriptor.multiview;
             std::vector<Handle<RHITexture>> attachments;
 
             for (auto& color : m_RTDescriptor.color)
@@ -86,8 +87,10 @@ namespace Zephyr
             auto r = static_cast<VirtualResource*>(write.resource);
             m_FG->GetDriver()->SetupBarrier(r->GetRHITexture(), r->GetViewRange(), write.usage, type);
         }
-        // execute
+        // execute, timed on the queue the pass runs on
+        m_FG->GetDriver()->BeginGpuScope(GetName(), type);
         m_Pass->Execute(graph, m_RenderTarget);
+        m_FG->GetDriver()->EndGpuScope(type);
 
         // destroy rendertarget
     }
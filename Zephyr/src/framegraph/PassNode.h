@@ -21,6 +21,8 @@ namespace Zephyr
         FrameGraphAttachmentDescriptor              depthStencil;
         bool                                        useDepth = false;
         bool                                        present  = false;
+        // layered attachments broadcast through a view mask instead of gl_Layer
+        bool multiview = false;
 
         bool IsValid() { return color.size() > 0 || useDepth; }
     };
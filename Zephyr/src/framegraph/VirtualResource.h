@@ -65,6 +65,9 @@ namespace Zephyr
         VirtualResource(const TextureDescription& desc, bool external = false) :
             m_Descriptor(desc), m_Resource(external)
         {}
+        VirtualResource(const TextureDescription& desc, Handle<RHITexture> imported) :
+            m_Descriptor(desc), m_Resource(imported)
+        {}
         VirtualResource(VirtualResourceBase* parent, const SubresourceDesciptor& sub) :
             VirtualResourceBase(parent), m_SubresourceDescriptor(sub)
         {}
@@ -112,12 +115,14 @@ namespace Zephyr
         //
         AttachmentDescriptor GetAttachmentDescriptor()
         {
-            // the assumption is that if used as a render attachment, we can only use one layer and one level at a time
+            // the assumption is that if used as a render attachment, we can only use one level at a time.
+            // a subresource spanning several layers becomes a layered attachment
             AttachmentDescriptor desc {};
             if (IsSubresource())
             {
-                desc.layer = m_SubresourceDescriptor.baseLayer;
-                desc.level = m_SubresourceDescriptor.baseLevel;
+                desc.layer      = m_SubresourceDescriptor.baseLayer;
+                desc.level      = m_SubresourceDescriptor.baseLevel;
+                desc.layerCount = m_SubresourceDescriptor.layerCount;
             }
             else
             {
@@ -0,0 +1,52 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Zephyr
+{
+    float DynamicResolution::Update(float gpuFrameTime, float measuredScale)
+    {
+        if (!m_Settings.enabled)
+        {
+            m_Scale       = m_Settings.maxScale;
+            m_UnderBudget = 0;
+            return m_Scale;
+        }
+
+        if (gpuFrameTime <= 0.f)
+        {
+            return m_Scale;
+        }
+
+        float target = m_Settings.targetFrameTime;
+        // gpu time scales roughly with the pixel count, the square of the scale
+        float ideal = measuredScale * std::sqrt(target / gpuFrameTime);
+
+        if (gpuFrameTime > target * (1.f + m_Settings.headroom))
+        {
+            m_Scale       = std::min(m_Scale, std::clamp(ideal, m_Settings.minScale, m_Settings.maxScale));
+            m_UnderBudget = 0;
+        }
+        else if (gpuFrameTime < target * (1.f - m_Settings.headroom))
+        {
+            // frames from before the last change say nothing about the current scale
+            if (measuredScale != m_Scale)
+            {
+                return m_Scale;
+            }
+            if (++m_UnderBudget >= m_Settings.raiseDelay)
+            {
+                ideal         = std::min(ideal, m_Scale * (1.f + m_Settings.raiseStep));
+                m_Scale       = std::clamp(ideal, m_Settings.minScale, m_Settings.maxScale);
+                // the next step waits for the frame time at the new scale
+                m_UnderBudget = 0;
+            }
+        }
+        else
+        {
+            m_UnderBudget = 0;
+        }
+
+        return m_Scale;
+    }
+} // namespace Zephyr
@@ -0,0 +1,45 @@
+#pragma once
+#include "pch.h"
+
+namespace Zephyr
+{
+    struct DynamicResolutionSettings
+    {
+        bool enabled = true;
+        // gpu budget of a frame in milliseconds
+        float targetFrameTime = 16.6f;
+        float minScale        = .5f;
+        float maxScale        = 1.f;
+        // fraction of the budget around the target in which the scale is left alone
+        float headroom = .1f;
+        // frames that have to stay under budget before the scale goes up again
+        uint32_t raiseDelay = 30;
+        // largest relative step when raising, dropping is never limited
+        float raiseStep = .05f;
+    };
+
+    /*
+        picks the render scale of the next frame from the measured gpu frame time.
+        the scale drops as soon as a frame goes over budget and only creeps back up after a stable run of frames
+        under budget, so it doesn't oscillate around the target.
+        measurements arrive frames late, each one is judged against the scale its frame was rendered at. a late
+        sample from before a drop can't drop the scale again, and only frames rendered at the current scale count
+        towards a raise.
+    */
+    class DynamicResolution final
+    {
+    public:
+        // gpu time in milliseconds of a frame rendered at measuredScale, negative when there is no new
+        // measurement. returns the new scale
+        float Update(float gpuFrameTime, float measuredScale);
+
+        float GetScale() const { return m_Scale; }
+
+        DynamicResolutionSettings& GetSettings() { return m_Settings; }
+
+    private:
+        DynamicResolutionSettings m_Settings {};
+        float                     m_Scale       = 1.f;
+        uint32_t                  m_UnderBudget = 0;
+    };
+} // namespace Zephyr
@@ -0,0 +1,118 @@
+#include "GpuProfiler.h"
+#include <algorithm>
+
+namespace Zephyr
+{
+    void GpuProfiler::Collect(const GpuFrameTimings& timings)
+    {
+        if (!timings.valid || (m_Collected && timings.frame == m_LastFrame))
+        {
+            return;
+        }
+        m_Collected = true;
+        m_LastFrame = timings.frame;
+
+        // a pass name can show up several times in a frame, those are summed up
+        std::unordered_map<std::string, float> frameTimes;
+        frameTimes[GPU_PROFILER_FRAME] = timings.frameTime;
+        GetHistory(GPU_PROFILER_FRAME);
+
+        for (auto& scope : timings.scopes)
+        {
+            frameTimes[scope.name] += scope.time;
+
+            auto& history = GetHistory(scope.name);
+            if (scope.hasStatistics)
+            {
+                history.hasStatistics = true;
+                history.primitives    = scope.primitives;
+                history.fragments     = scope.fragments;
+            }
+        }
+
+        for (auto& [name, time] : frameTimes)
+        {
+            auto& history = GetHistory(name);
+            if (history.times.size() < GPU_PROFILER_HISTORY)
+            {
+                history.times.push_back(time);
+            }
+            else
+            {
+                history.times[history.next] = time;
+            }
+            history.next = (history.next + 1) % GPU_PROFILER_HISTORY;
+        }
+    }
+
+    bool GpuProfiler::GetStats(const std::string& name, GpuScopeStats& stats) const
+    {
+        auto iter = m_History.find(name);
+        if (iter == m_History.end() || iter->second.times.empty())
+        {
+            return false;
+        }
+
+        auto& history = iter->second;
+        auto  sorted  = history.times;
+        std::sort(sorted.begin(), sorted.end());
+
+        float sum = 0.f;
+        for (auto time : sorted)
+        {
+            sum += time;
+        }
+
+        auto percentile = [&sorted](float p) {
+            uint32_t index = std::min<uint32_t>(sorted.size() * p, sorted.size() - 1);
+            return sorted[index];
+        };
+
+        stats.samples       = sorted.size();
+        stats.average       = sum / sorted.size();
+        stats.median        = percentile(.5f);
+        stats.p95           = percentile(.95f);
+        stats.p99           = percentile(.99f);
+        stats.max           = sorted.back();
+        stats.hasStatistics = history.hasStatistics;
+        stats.primitives    = history.primitives;
+        stats.fragments     = history.fragments;
+
+        return true;
+    }
+
+    void GpuProfiler::Print() const
+    {
+        printf("%-32s %9s %9s %9s %9s\n", "gpu (ms)", "avg", "p50", "p95", "p99");
+
+        GpuScopeStats stats;
+        for (auto& name : m_Names)
+        {
+            if (!GetStats(name, stats))
+            {
+                continue;
+            }
+
+            printf("%-32s %9.3f %9.3f %9.3f %9.3f", name.c_str(), stats.average, stats.median, stats.p95, stats.p99);
+            if (stats.hasStatistics)
+            {
+                printf("  primitives: %llu fragments: %llu",
+                       (unsigned long long)stats.primitives,
+                       (unsigned long long)stats.fragments);
+            }
+            printf("\n");
+        }
+    }
+
+    GpuProfiler::History& GpuProfiler::GetHistory(const std::string& name)
+    {
+        auto iter = m_History.find(name);
+        if (iter != m_History.end())
+        {
+            return iter->second;
+        }
+
+        m_Names.push_back(name);
+        return m_History[name];
+    }
+} // namespace Zephyr
@@ -0,0 +1,63 @@
+#pragma once
+#include "pch.h"
+#include "rhi/Driver.h"
+
+namespace Zephyr
+{
+    // frames kept per scope for the rolling statistics
+    inline constexpr uint32_t GPU_PROFILER_HISTORY = 128;
+    // scope name of the whole frame
+    inline const std::string GPU_PROFILER_FRAME = "frame";
+
+    // milliseconds over the recorded history
+    struct GpuScopeStats
+    {
+        uint32_t samples = 0;
+        float    average = 0.f;
+        float    median  = 0.f;
+        float    p95     = 0.f;
+        float    p99     = 0.f;
+        float    max     = 0.f;
+        // counts of the latest frame, when the scope had pipeline statistics
+        bool     hasStatistics = false;
+        uint64_t primitives    = 0;
+        uint64_t fragments     = 0;
+    };
+
+    /*
+        rolling gpu timings of the whole frame and every profiled scope, fed with the driver's resolved queries.
+        scopes are the frame graph passes, the whole frame is reported as GPU_PROFILER_FRAME.
+    */
+    class GpuProfiler final
+    {
+    public:
+        // a frame is only collected once, calling it again before the driver resolves another is a no-op
+        void Collect(const GpuFrameTimings& timings);
+
+        bool GetStats(const std::string& name, GpuScopeStats& stats) const;
+        // in the order the scopes were first seen
+        const std::vector<std::string>& GetScopeNames() const { return m_Names; }
+
+        void Print() const;
+
+    private:
+        struct History
+        {
+            std::vector<float> times;
+            uint32_t           next = 0;
+
+            bool     hasStatistics = false;
+            uint64_t primitives    = 0;
+            uint64_t fragments     = 0;
+        };
+
+        History& GetHistory(const std::string& name);
+
+    private:
+        std::unordered_map<std::string, History> m_History;
+        std::vector<std::string>                 m_Names;
+
+        bool     m_Collected = false;
+        uint64_t m_LastFrame = 0;
+    };
+} // namespace Zephyr
@@ -1,7 +1,10 @@
 #include "Renderer.h"
+#include "core/math/DynamicBVH.h"
+#include "core/profile/Profiler.h"
 #include "engine/Engine.h"
 #include "framegraph/FrameGraph.h"
 #include "resource/Buffer.h"
+#include "resource/GeometryPool.h"
 #include "resource/MaterialInstance.h"
 #include "rhi/Driver.h"
 #include "rhi/RHIEnums.h"
@@ -9,33 +12,138 @@
 
 namespace Zephyr
 {
-    Renderer::Renderer(Engine* engine) : m_Engine(engine), m_Driver(engine->GetDriver()), m_Manager(m_Driver)
+    namespace
+    {
+        // the eye of a cascade is rebuilt from the snapped center every frame and picks up float noise on the way
+        // back to world space. a difference below a hundredth of a texel keeps the cached cascade
+        bool IsSameLightMatrix(const glm::mat4& a, const glm::mat4& b, uint32_t resolution)
+        {
+            float tolerance = .01f * 2.f / resolution;
+            for (uint32_t column = 0; column < 4; column++)
+            {
+                for (uint32_t row = 0; row < 4; row++)
+                {
+                    if (std::abs(a[column][row] - b[column][row]) > tolerance * (1.f + std::abs(a[column][row])))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    Renderer::Renderer(Engine* engine) :
+        m_Engine(engine), m_Driver(engine->GetDriver()), m_Manager(m_Driver), m_Downsampler(engine, m_Driver)
     {
         // setup global render ringbuffer
         BufferDescription desc {};
         desc.memoryType   = BufferMemoryType::DynamicRing;
         desc.size         = sizeof(GlobalRenderShaderData);
-        desc.pipelines    = PipelineTypeBits::Graphics;
-        desc.shaderStages = ShaderStageBits::Vertex | ShaderStageBits::Fragment;
+        desc.pipelines    = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
+        desc.shaderStages = ShaderStageBits::Vertex | ShaderStageBits::Fragment | ShaderStageBits::Compute;
         desc.usage        = BufferUsageBits::StorageDynamic;
 
         m_GlobalRingBuffer = engine->CreateBuffer(desc);
-        // setup point light ringbuffer
-        desc.size  = sizeof(PointLightShaderData);
-        desc.usage = BufferUsageBits::UniformDynamic;
 
-        m_PointLightBuffer = engine->CreateBuffer(desc);
+        // setup point light buffers
+        ReservePointLightBuffers(POINT_LIGHT_INITIAL_CAPACITY);
+
+        // setup light cluster buffers, every cluster owns a fixed slice of the index list
+        desc.memoryType   = BufferMemoryType::Static;
+        desc.size         = CLUSTER_COUNT * sizeof(glm::uvec2);
+        desc.pipelines    = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
+        desc.shaderStages = ShaderStageBits::Fragment | ShaderStageBits::Compute;
+        desc.usage        = BufferUsageBits::Storage;
+
+        m_ClusterLightGridBuffer = m_Driver->CreateBuffer(desc);
+
+        desc.size = CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t);
+
+        m_ClusterLightIndexBuffer = m_Driver->CreateBuffer(desc);
+
+        // setup occlusion culling buffers, the hi-z follows the window size and is created on first use
+        ReserveOcclusionCullBuffers(OCCLUSION_CULL_INITIAL_CAPACITY);
+
+        // persistent shadow map, imported into the frame graph every frame
+        m_ShadowMapDescription.width     = m_ShadowMapResolution;
+        m_ShadowMapDescription.height    = m_ShadowMapResolution;
+        m_ShadowMapDescription.depth     = 4;
+        m_ShadowMapDescription.levels    = 1;
+        m_ShadowMapDescription.samples   = 1;
+        m_ShadowMapDescription.format    = TextureFormat::DEPTH24_STENCIL8;
+        m_ShadowMapDescription.usage     = TextureUsageBits::DepthStencilAttachment | TextureUsageBits::Sampled;
+        m_ShadowMapDescription.sampler   = SamplerType::Sampler2DArray;
+        m_ShadowMapDescription.pipelines = PipelineTypeBits::Graphics;
+
+        m_ShadowMap = m_Driver->CreateTexture(m_ShadowMapDescription);
+
+        // prefer rendering all cascades in one pass
+        auto& capabilities = m_Driver->GetCapabilities();
+        if (capabilities.layeredRendering)
+        {
+            m_ShadowRenderMode = ShadowRenderMode::Layered;
+        }
+        else if (capabilities.multiview)
+        {
+            m_ShadowRenderMode = ShadowRenderMode::Multiview;
+        }
+    }
+    void Renderer::Shutdown()
+    {
+        for (auto& buffer : m_PointLightBuffers)
+        {
+            m_Driver->DestroyBuffer(buffer);
+        }
+        m_Driver->DestroyBuffer(m_ClusterLightGridBuffer);
+        m_Driver->DestroyBuffer(m_ClusterLightIndexBuffer);
+        m_Driver->DestroyTexture(m_ShadowMap);
+        for (auto& buffer : m_OcclusionUnitBuffers)
+        {
+            m_Driver->DestroyBuffer(buffer);
+        }
+        m_Driver->DestroyBuffer(m_EarlyDrawBuffer);
+        m_Driver->DestroyBuffer(m_LateDrawBuffer);
+        if (m_HiZ.IsValid())
+        {
+            m_Driver->DestroyTexture(m_HiZ);
+        }
+        m_Downsampler.Shutdown();
+        m_Manager.Shutdown();
     }
-    void Renderer::Shutdown() { m_Manager.Shutdown(); }
 
     Renderer::~Renderer() {}
 
     void Renderer::Render(const SceneRenderData& scene)
     {
-        m_Scene = scene;
+        ZEPHYR_PROFILE_ZONE("Renderer::Render");
+
+        // the measurement lags behind by the frames in flight, every frame is measured once against its own scale
+        auto&    timings       = m_Driver->GetGpuTimings();
+        uint64_t frame         = m_Engine->GetFrame();
+        float    frameTime     = -1.f;
+        float    measuredScale = m_RenderScale;
+        if (timings.valid && timings.frame != m_MeasuredFrame && frame - timings.frame < RENDER_SCALE_HISTORY)
+        {
+            frameTime       = timings.frameTime;
+            measuredScale   = m_FrameScales[timings.frame % RENDER_SCALE_HISTORY];
+            m_MeasuredFrame = timings.frame;
+        }
+        m_RenderScale                               = m_DynamicResolution.Update(frameTime, measuredScale);
+        m_FrameScales[frame % RENDER_SCALE_HISTORY] = m_RenderScale;
+
+        m_Scene = &scene;
         PrepareScene();
         SetupGlobalRenderData();
+        CullScene();
         SetupPointLightData();
+        SetupOcclusionCullData();
+        UpdateDepthPrepass();
+
+        // textures loaded since the last frame get their mip chains before anything samples them
+        auto pendingMips = m_Engine->TakePendingMipTextures();
+        m_PendingMipTextures.insert(m_PendingMipTextures.end(), pendingMips.begin(), pendingMips.end());
+        m_Downsampler.BeginFrame(m_PendingMipTextures.size() + 1);
         //  build frame graph
 
         if (!m_Driver->BeginFrame(m_Engine->GetFrame()))
@@ -45,17 +153,25 @@ namespace Zephyr
 
         FrameGraph fg(m_Engine, &m_Manager);
 
+        GeneratePendingMips(fg);
         DrawShadowMap(fg);
         // DrawForward(fg);
+        DispatchLightCulling(fg);
         DrawDeferred(fg);
-        DispatchBloomCompute(fg);
-        DispatchFXAACompute(fg);
-        DispatchPostProcessingCompute(fg);
+        if (m_PostProcess.bloom)
+        {
+            DispatchBloomCompute(fg);
+        }
+        DispatchPostComposite(fg);
         DrawResolve(fg);
 
         fg.Compile();
         fg.Execute();
 
+        // this frame's pyramid is the occlusion history of the next one
+        m_HiZValid          = m_OcclusionCulling;
+        m_HiZViewProjection = m_GlobalShaderData.vp;
+
         m_Driver->EndFrame();
         m_Driver->WaitAndPresent();
     }
@@ -63,28 +179,66 @@ namespace Zephyr
     void Renderer::PrepareScene()
     {
         m_SceneRenderUnit.clear();
+        m_MeshUnits.clear();
         uint32_t i = 0;
-        for (auto& mesh : m_Scene.meshes)
+        for (auto& mesh : m_Scene->meshes)
         {
+            m_MeshUnits.push_back(m_SceneRenderUnit.size());
             for (auto& submesh : mesh->GetSubmeshes())
             {
                 auto& ru        = m_SceneRenderUnit.emplace_back();
-                ru.vertex       = mesh->GetVertexBuffer();
-                ru.index        = mesh->GetIndexBuffer();
-                ru.vertexOffset = submesh.baseVertex;
-                ru.indexOffset  = submesh.baseIndex;
+                ru.vertexOffset = submesh.globalVertexOffset;
+                ru.indexOffset  = submesh.globalIndexOffset;
                 ru.indexCount   = submesh.indexCount;
                 ru.material     = mesh->GetMaterials()[submesh.materialIndex];
-                ru.transform    = submesh.transform * m_Scene.transforms[i];
+                ru.transform    = submesh.transform * m_Scene->transforms[i];
+                ru.bounds       = submesh.aabb;
             }
             i++;
         }
+        m_MeshUnits.push_back(m_SceneRenderUnit.size());
+    }
+
+    // marks the units of the meshes whose bounds reach into the camera and each shadow cascade, the scene's bvh
+    // only visits the subtrees that do
+    void Renderer::CullScene()
+    {
+        ZEPHYR_PROFILE_ZONE("Renderer::CullScene");
+        auto bounds = m_Scene->meshBounds;
+        m_UnitVisibility.assign(m_SceneRenderUnit.size(), bounds ? 0 : UNIT_VISIBLE_ALL);
+        if (!bounds)
+        {
+            return;
+        }
+
+        auto mark = [&](uint8_t bit) {
+            return [&, bit](uint32_t mesh) {
+                for (uint32_t unit = m_MeshUnits[mesh]; unit < m_MeshUnits[mesh + 1]; unit++)
+                {
+                    m_UnitVisibility[unit] |= bit;
+                }
+            };
+        };
+        bounds->Query(Frustum(m_GlobalShaderData.vp), mark(UNIT_VISIBLE_CAMERA));
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            bounds->Query(Frustum(m_ShadowCascadeCache[i].lightVP), mark(1 << i));
+        }
+
+        // units without bounds are never culled, same as on the gpu
+        for (uint32_t i = 0; i < m_SceneRenderUnit.size(); i++)
+        {
+            if (m_SceneRenderUnit[i].bounds.IsEmpty())
+            {
+                m_UnitVisibility[i] = UNIT_VISIBLE_ALL;
+            }
+        }
     }
 
     void Renderer::SetupGlobalRenderData()
     {
-        auto& camera = m_Scene.camera;
-        auto& light  = m_Scene.light;
+        auto& camera = m_Scene->camera;
+        auto& light  = m_Scene->light;
 
         m_GlobalShaderData.view                      = camera.view;
         m_GlobalShaderData.projection                = camera.projection;
@@ -92,6 +246,11 @@ namespace Zephyr
         m_GlobalShaderData.directionalLightDirection = light.direction;
         m_GlobalShaderData.directionalLightRadiance  = light.radiance;
         m_GlobalShaderData.eye                       = camera.position;
+        m_GlobalShaderData.inverseProjection         = glm::inverse(camera.projection);
+        m_GlobalShaderData.inverseViewProjection     = glm::inverse(m_GlobalShaderData.vp);
+
+        auto dimension                 = GetRenderDimension();
+        m_GlobalShaderData.clusterInfo = glm::vec4(camera.zNear, camera.zFar, dimension.first, dimension.second);
 
         PrepareCascadedShadowData();
 
@@ -106,28 +265,290 @@ namespace Zephyr
 
     void Renderer::SetupPointLightData()
     {
-        auto& lights = m_Scene.pointLights;
+        auto* lights = &m_Scene->pointLights;
+        // lights outside the view can't reach a visible cluster
+        if (m_Scene->pointLightBounds)
+        {
+            m_VisiblePointLights.clear();
+            m_Scene->pointLightBounds->Query(Frustum(m_GlobalShaderData.vp), [&](uint32_t light) {
+                m_VisiblePointLights.push_back(m_Scene->pointLights[light]);
+            });
+            lights = &m_VisiblePointLights;
+        }
 
-        for (uint32_t i = 0; i < lights.size(); i++)
+        // the gpu doesn't report per cluster counts, only more lights in view than a cluster holds can overflow one
+        if (lights->size() > MAX_LIGHTS_PER_CLUSTER && m_ClusterOverflowFrames++ == 0)
         {
+            printf("%zu point lights in view, clusters keep at most %u and may drop lights\n",
+                   lights->size(),
+                   MAX_LIGHTS_PER_CLUSTER);
+        }
+
+        ReservePointLightBuffers(lights->size());
+
+        auto buffer = m_PointLightBuffers[m_Engine->GetFrame() % MAX_CONCURRENT_FRAME];
 
-            m_PointLightData.pointLights[i] = lights[i];
+        PointLightShaderHeader header {};
+        header.activePointLight = lights->size();
+
+        BufferUpdateDescriptor update {};
+        update.data      = &header;
+        update.size      = sizeof(header);
+        update.srcOffset = 0;
+        update.dstOffset = 0;
+
+        m_Driver->UpdateBuffer(update, buffer);
+
+        if (lights->empty())
+        {
+            return;
+        }
+
+        update.data      = (void*)lights->data();
+        update.size      = lights->size() * sizeof(PointLight);
+        update.dstOffset = sizeof(PointLightShaderHeader);
+
+        m_Driver->UpdateBuffer(update, buffer);
+    }
+
+    // grow the per frame point light buffers by doubling, the old ones may still be in flight
+    void Renderer::ReservePointLightBuffers(uint32_t count)
+    {
+        if (count <= m_PointLightCapacity)
+        {
+            return;
+        }
+
+        uint32_t capacity = std::max(m_PointLightCapacity, POINT_LIGHT_INITIAL_CAPACITY);
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+
+        if (m_PointLightCapacity != 0)
+        {
+            m_Driver->WaitIdle();
+            for (auto& buffer : m_PointLightBuffers)
+            {
+                m_Driver->DestroyBuffer(buffer);
+            }
+        }
+
+        BufferDescription desc {};
+        desc.memoryType   = BufferMemoryType::Dynamic;
+        desc.size         = sizeof(PointLightShaderHeader) + capacity * sizeof(PointLight);
+        desc.pipelines    = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
+        desc.shaderStages = ShaderStageBits::Fragment | ShaderStageBits::Compute;
+        desc.usage        = BufferUsageBits::Storage;
+
+        for (auto& buffer : m_PointLightBuffers)
+        {
+            buffer = m_Driver->CreateBuffer(desc);
+        }
+        m_PointLightCapacity = capacity;
+    }
+
+    void Renderer::SetupOcclusionCullData()
+    {
+        if (!m_OcclusionCulling)
+        {
+            return;
+        }
+
+        // the pyramid base is the largest power of two inside the depth buffer, so every level halves exactly
+        auto     dimension = m_Engine->GetWindowDimension();
+        uint32_t width     = 1;
+        uint32_t height    = 1;
+        while (width * 2 <= dimension.first)
+        {
+            width *= 2;
+        }
+        while (height * 2 <= dimension.second)
+        {
+            height *= 2;
+        }
+        uint32_t levels = 1;
+        while ((std::max(width, height) >> levels) > 0)
+        {
+            levels++;
+        }
+
+        if (!m_HiZ.IsValid() || m_HiZDescription.width != width || m_HiZDescription.height != height)
+        {
+            if (m_HiZ.IsValid())
+            {
+                m_Driver->WaitIdle();
+                m_Driver->DestroyTexture(m_HiZ);
+            }
+
+            m_HiZDescription.width     = width;
+            m_HiZDescription.height    = height;
+            m_HiZDescription.depth     = 1;
+            m_HiZDescription.levels    = levels;
+            m_HiZDescription.samples   = 1;
+            m_HiZDescription.format    = TextureFormat::R32_SFLOAT;
+            m_HiZDescription.usage     = TextureUsageBits::Storage | TextureUsageBits::Sampled;
+            m_HiZDescription.sampler   = SamplerType::Sampler2D;
+            m_HiZDescription.pipelines = PipelineTypeBits::Compute;
+
+            m_HiZ      = m_Driver->CreateTexture(m_HiZDescription);
+            m_HiZValid = false;
+        }
+
+        ReserveOcclusionCullBuffers(m_SceneRenderUnit.size());
+
+        if (m_SceneRenderUnit.empty())
+        {
+            return;
+        }
+
+        std::vector<OcclusionCullUnit> units;
+        units.reserve(m_SceneRenderUnit.size());
+        for (auto& unit : m_SceneRenderUnit)
+        {
+            // empty bounds stay empty, the shader never culls them
+            bool empty  = glm::any(glm::greaterThan(unit.bounds.min, unit.bounds.max));
+            auto bounds = empty ? unit.bounds : unit.bounds.Transform(unit.transform);
+
+            auto& cull        = units.emplace_back();
+            cull.boundsMin    = glm::vec4(bounds.min, 1.f);
+            cull.boundsMax    = glm::vec4(bounds.max, 1.f);
+            cull.indexCount   = unit.indexCount;
+            cull.firstIndex   = unit.indexOffset;
+            cull.vertexOffset = unit.vertexOffset;
         }
-        m_PointLightData.activePointLight = lights.size();
 
         BufferUpdateDescriptor update {};
-        update.data      = &m_PointLightData;
-        update.size      = sizeof(m_PointLightData);
+        update.data      = units.data();
+        update.size      = units.size() * sizeof(OcclusionCullUnit);
         update.srcOffset = 0;
         update.dstOffset = 0;
 
-        m_Driver->UpdateBuffer(update, m_PointLightBuffer->GetHandle());
+        m_Driver->UpdateBuffer(update, m_OcclusionUnitBuffers[m_Engine->GetFrame() % MAX_CONCURRENT_FRAME]);
+    }
+
+    void Renderer::UpdateDepthPrepass()
+    {
+        if (m_DepthPrepassMode != DepthPrepassMode::Auto)
+        {
+            m_DepthPrepass = m_DepthPrepassMode == DepthPrepassMode::On;
+            return;
+        }
+
+        // hysteresis keeps the pass from toggling every frame around the threshold
+        m_EstimatedOverdraw = EstimateOverdraw();
+        if (!m_DepthPrepass && m_EstimatedOverdraw > DEPTH_PREPASS_ENABLE_OVERDRAW)
+        {
+            m_DepthPrepass = true;
+        }
+        else if (m_DepthPrepass && m_EstimatedOverdraw < DEPTH_PREPASS_DISABLE_OVERDRAW)
+        {
+            m_DepthPrepass = false;
+        }
+    }
+
+    // screen coverage of all unit bounds over the screen area, a conservative depth complexity estimate
+    float Renderer::EstimateOverdraw()
+    {
+        auto& vp       = m_GlobalShaderData.vp;
+        float coverage = 0.f;
+        for (uint32_t i = 0; i < m_SceneRenderUnit.size(); i++)
+        {
+            auto& unit = m_SceneRenderUnit[i];
+            if (unit.bounds.IsEmpty() || !(m_UnitVisibility[i] & UNIT_VISIBLE_CAMERA))
+            {
+                continue;
+            }
+            auto world = unit.bounds.Transform(unit.transform);
+
+            glm::vec2 ndcMin(1.f);
+            glm::vec2 ndcMax(-1.f);
+            bool      crossesNear = false;
+            for (uint32_t corner = 0; corner < 8; corner++)
+            {
+                glm::vec4 clip = vp * glm::vec4(corner & 1 ? world.max.x : world.min.x,
+                                                corner & 2 ? world.max.y : world.min.y,
+                                                corner & 4 ? world.max.z : world.min.z,
+                                                1.f);
+                if (clip.w <= 0.f)
+                {
+                    crossesNear = true;
+                    break;
+                }
+                ndcMin = glm::min(ndcMin, glm::vec2(clip) / clip.w);
+                ndcMax = glm::max(ndcMax, glm::vec2(clip) / clip.w);
+            }
+
+            // around the camera, assume it covers the whole screen
+            if (crossesNear)
+            {
+                coverage += 1.f;
+                continue;
+            }
+
+            ndcMin = glm::clamp(ndcMin, glm::vec2(-1.f), glm::vec2(1.f));
+            ndcMax = glm::clamp(ndcMax, glm::vec2(-1.f), glm::vec2(1.f));
+            if (ndcMin.x < ndcMax.x && ndcMin.y < ndcMax.y)
+            {
+                coverage += (ndcMax.x - ndcMin.x) * (ndcMax.y - ndcMin.y) * .25f;
+            }
+        }
+        return coverage;
+    }
+
+    // same growth policy as the point light buffers
+    void Renderer::ReserveOcclusionCullBuffers(uint32_t count)
+    {
+        if (count <= m_OcclusionCapacity)
+        {
+            return;
+        }
+
+        uint32_t capacity = std::max(m_OcclusionCapacity, OCCLUSION_CULL_INITIAL_CAPACITY);
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+
+        if (m_OcclusionCapacity != 0)
+        {
+            m_Driver->WaitIdle();
+            for (auto& buffer : m_OcclusionUnitBuffers)
+            {
+                m_Driver->DestroyBuffer(buffer);
+            }
+            m_Driver->DestroyBuffer(m_EarlyDrawBuffer);
+            m_Driver->DestroyBuffer(m_LateDrawBuffer);
+        }
+
+        BufferDescription desc {};
+        desc.memoryType   = BufferMemoryType::Dynamic;
+        desc.size         = capacity * sizeof(OcclusionCullUnit);
+        desc.pipelines    = PipelineTypeBits::Compute;
+        desc.shaderStages = ShaderStageBits::Compute;
+        desc.usage        = BufferUsageBits::Storage;
+
+        for (auto& buffer : m_OcclusionUnitBuffers)
+        {
+            buffer = m_Driver->CreateBuffer(desc);
+        }
+
+        // indirect arguments are written and consumed on the gpu
+        desc.memoryType = BufferMemoryType::Static;
+        desc.size       = capacity * sizeof(DrawIndexedIndirectCommand);
+        desc.pipelines  = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
+        desc.usage      = BufferUsageBits::Storage | BufferUsageBits::Indirect;
+
+        m_EarlyDrawBuffer = m_Driver->CreateBuffer(desc);
+        m_LateDrawBuffer  = m_Driver->CreateBuffer(desc);
+
+        m_OcclusionCapacity = capacity;
     }
 
     void Renderer::PrepareCascadedShadowData()
     {
-        auto& camera = m_Scene.camera;
-        auto& light  = m_Scene.light;
+        auto& camera = m_Scene->camera;
+        auto& light  = m_Scene->light;
 
         uint32_t cascadeCount         = 4;
         float    cascadeExponentScale = 2.5;
@@ -186,6 +607,9 @@ namespace Zephyr
 
             center.x -= std::fmodf(center.x, shadowMapPixelSize);
             center.y -= std::fmodf(center.y, shadowMapPixelSize);
+            // snap the depth as well so that the light matrix stays constant while the camera moves within a texel,
+            // which is what lets a cached cascade survive
+            center.z -= std::fmodf(center.z, shadowMapPixelSize);
 
             center = glm::inverse(w2l) * glm::vec4(center, 1.f);
 
@@ -206,103 +630,253 @@ namespace Zephyr
         m_GlobalShaderData.lightVPCascade1 = cascadeShadowVP[1];
         m_GlobalShaderData.lightVPCascade2 = cascadeShadowVP[2];
         m_GlobalShaderData.lightVPCascade3 = cascadeShadowVP[3];
+
+        UpdateShadowCascadeCache(cascadeShadowVP);
     }
 
-    void Renderer::DrawShadowMap(FrameGraph& fg)
+    void Renderer::UpdateShadowCascadeCache(const glm::mat4* cascadeVP)
     {
-        struct PrepareShadowPassData
+        // a new light matrix means the light direction or the snapped center/radius changed
+        for (uint32_t i = 0; i < 4; i++)
         {
-            FrameGraphResourceHandle<FrameGraphTexture> shadow;
-        };
-        // prepare shadow render target
-        auto prepareShadowPass = fg.AddPass<PrepareShadowPassData>(
-            "prepareShadow",
-            [engine = m_Engine](FrameGraph* fg, PassNode* passNode, PrepareShadowPassData* passData) {
-                std::pair<uint32_t, uint32_t> windowDimension = engine->GetWindowDimension();
+            auto& cache = m_ShadowCascadeCache[i];
+            if (!m_CacheShadowCascades || !IsSameLightMatrix(cache.lightVP, cascadeVP[i], m_ShadowMapResolution))
+            {
+                cache.lightVP = cascadeVP[i];
+                cache.dirty   = true;
+            }
+        }
 
-                TextureDescription desc {};
-                desc.width     = 2048;
-                desc.height    = 2048;
-                desc.depth     = 4;
-                desc.levels    = 1;
-                desc.samples   = 1;
-                desc.format    = TextureFormat::DEPTH24_STENCIL8;
-                desc.usage     = TextureUsageBits::DepthStencilAttachment | TextureUsageBits::Sampled;
-                desc.sampler   = SamplerType::Sampler2DArray;
-                desc.pipelines = PipelineTypeBits::Graphics;
+        std::vector<ShadowCasterState> casters;
+        casters.reserve(m_ShadowCasters.size());
+        for (auto& unit : m_SceneRenderUnit)
+        {
+            if (!unit.material->DoCastShadow())
+            {
+                continue;
+            }
 
-                passData->shadow = fg->CreateTexture(desc);
-                fg->GetBlackboard().Set("shadow", passData->shadow);
+            casters.push_back({unit.indexOffset, unit.transform, unit.bounds.Transform(unit.transform)});
+        }
 
-                passNode->SideEffect();
-            },
-            [](FrameGraph* fg, PrepareShadowPassData* m_Data, PassRenderTarget rt) {});
+        if (casters.size() != m_ShadowCasters.size())
+        {
+            // casters were added or removed, there's no cheap way to tell where
+            for (auto& cache : m_ShadowCascadeCache)
+            {
+                cache.dirty = true;
+            }
+        }
+        else
+        {
+            // a moved caster dirties the cascades it left and the ones it entered
+            for (uint32_t i = 0; i < casters.size(); i++)
+            {
+                auto& previous = m_ShadowCasters[i];
+                auto& current  = casters[i];
+                if (previous.indexOffset != current.indexOffset || previous.transform != current.transform)
+                {
+                    InvalidateShadowCascades(previous.worldBounds);
+                    InvalidateShadowCascades(current.worldBounds);
+                }
+            }
+        }
 
-        // 4x cascade
-        for (uint32_t i = 0; i < 4; i++)
+        m_ShadowCasters = std::move(casters);
+    }
+
+    void Renderer::InvalidateShadowCascades(const AABB& worldBounds)
+    {
+        for (auto& cache : m_ShadowCascadeCache)
         {
-            struct ShadowPassData
+            if (cache.dirty)
             {
-                FrameGraphResourceHandle<FrameGraphTexture> output;
-                uint32_t                                    cascadeIndex;
-            };
+                continue;
+            }
 
-            auto shadowPass = fg.AddPass<ShadowPassData>(
-                "shadow cascade " + std::to_string(i),
-                [engine = m_Engine, shadowTexture = prepareShadowPass->GetData()->shadow, i = i](
-                    FrameGraph* fg, PassNode* passNode, ShadowPassData* passData) {
-                    FrameGraphTexture::SubresourceDescriptor sub {};
-                    sub.baseLayer          = i;
-                    sub.layerCount         = 1;
-                    sub.baseLevel          = 0;
-                    sub.levelCount         = 1;
-                    passData->output       = fg->CreateSubresource(shadowTexture, sub);
-                    passData->cascadeIndex = i;
+            // bounds of the box in the cascade's clip space, overlapping the ortho volume means it casts into it
+            glm::vec3 clipMin = glm::vec3(FLT_MAX);
+            glm::vec3 clipMax = glm::vec3(-FLT_MAX);
+            for (uint32_t corner = 0; corner < 8; corner++)
+            {
+                glm::vec3 p = {corner & 1 ? worldBounds.max.x : worldBounds.min.x,
+                               corner & 2 ? worldBounds.max.y : worldBounds.min.y,
+                               corner & 4 ? worldBounds.max.z : worldBounds.min.z};
+                glm::vec3 c = cache.lightVP * glm::vec4(p, 1.f);
+                clipMin     = glm::min(clipMin, c);
+                clipMax     = glm::max(clipMax, c);
+            }
 
-                    FrameGraphRenderTargetDescriptor rtDesc {};
-                    rtDesc.useDepth            = true;
-                    rtDesc.depthStencil.handle = passData->output;
+            bool outside = clipMax.x < -1.f || clipMin.x > 1.f || clipMax.y < -1.f || clipMin.y > 1.f ||
+                           clipMax.z < 0.f || clipMin.z > 1.f;
+            if (!outside)
+            {
+                cache.dirty = true;
+            }
+        }
+    }
 
-                    fg->Write(passNode, passData->output, TextureUsageBits::DepthStencilAttachment);
-                    fg->SetRenderTarget(passNode, rtDesc);
+    void Renderer::DrawShadowMap(FrameGraph& fg)
+    {
+        // the shadow map persists across frames, cascades that are still valid are left untouched
+        auto shadow = fg.ImportTexture(m_ShadowMapDescription, m_ShadowMap);
+        fg.GetBlackboard().Set("shadow", shadow);
 
-                    // passNode->SideEffect();
-                },
-                [&](FrameGraph* fg, ShadowPassData* m_Data, PassRenderTarget rt) {
-                    // set viewport scissor
-                    m_Driver->SetViewportScissor({0, 0, (int)m_ShadowMapResolution, (int)m_ShadowMapResolution},
-                                                 {0, 0, m_ShadowMapResolution, m_ShadowMapResolution});
-                    // bind render target
-                    m_Driver->BeginRenderPass(rt.rt);
-                    m_Driver->BindShaderSet(m_Engine->GetShaderSet("shadow")->GetHandle());
-                    m_Driver->SetRasterState({Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
-
-                    auto handle = m_GlobalRingBuffer->GetHandle();
-                    m_Driver->BindBuffer(m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
-                    for (auto& unit : m_SceneRenderUnit)
-                    {
-                        if (!unit.material->DoCastShadow())
+        uint32_t dirtyCount = 0;
+        for (auto& cache : m_ShadowCascadeCache)
+        {
+            dirtyCount += cache.dirty ? 1 : 0;
+        }
+
+        if (dirtyCount == 4 && m_ShadowRenderMode != ShadowRenderMode::PerCascade)
+        {
+            DrawShadowMapSinglePass(fg, shadow);
+        }
+        else
+        {
+            // redraw the dirty cascades one by one, each pass only clears its own layer
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                if (!m_ShadowCascadeCache[i].dirty)
+                {
+                    continue;
+                }
+
+                struct ShadowPassData
+                {
+                    FrameGraphResourceHandle<FrameGraphTexture> output;
+                    uint32_t                                    cascadeIndex;
+                };
+
+                auto shadowPass = fg.AddPass<ShadowPassData>(
+                    "shadow cascade " + std::to_string(i),
+                    [engine = m_Engine, shadowTexture = shadow, i = i](
+                        FrameGraph* fg, PassNode* passNode, ShadowPassData* passData) {
+                        FrameGraphTexture::SubresourceDescriptor sub {};
+                        sub.baseLayer          = i;
+                        sub.layerCount         = 1;
+                        sub.baseLevel          = 0;
+                        sub.levelCount         = 1;
+                        passData->output       = fg->CreateSubresource(shadowTexture, sub);
+                        passData->cascadeIndex = i;
+
+                        FrameGraphRenderTargetDescriptor rtDesc {};
+                        rtDesc.useDepth            = true;
+                        rtDesc.depthStencil.handle = passData->output;
+
+                        fg->Write(passNode, passData->output, TextureUsageBits::DepthStencilAttachment);
+                        fg->SetRenderTarget(passNode, rtDesc);
+
+                        // passNode->SideEffect();
+                    },
+                    [&](FrameGraph* fg, ShadowPassData* m_Data, PassRenderTarget rt) {
+                        // set viewport scissor
+                        m_Driver->SetViewportScissor(
+                            {0, 0, (int)m_ShadowMapResolution, (int)m_ShadowMapResolution},
+                            {0, 0, m_ShadowMapResolution, m_ShadowMapResolution});
+                        // bind render target
+                        m_Driver->BeginRenderPass(rt.rt);
+                        m_Driver->BindShaderSet(m_Engine->GetShaderSet("shadow")->GetHandle());
+                        m_Driver->SetRasterState(
+                            {Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
+
+                        m_Driver->BindBuffer(
+                            m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
+                        // every mesh lives in the geometry pool, bind it once for the whole pass
+                        m_Driver->BindVertexBuffer(m_Engine->GetGeometryPool()->GetVertexBuffer());
+                        m_Driver->BindIndexBuffer(m_Engine->GetGeometryPool()->GetIndexBuffer());
+                        for (uint32_t unitIndex = 0; unitIndex < m_SceneRenderUnit.size(); unitIndex++)
                         {
-                            continue;
+                            auto& unit = m_SceneRenderUnit[unitIndex];
+                            if (!unit.material->DoCastShadow() ||
+                                !(m_UnitVisibility[unitIndex] & (1 << m_Data->cascadeIndex)))
+                            {
+                                continue;
+                            }
+                            struct ShadowMapConstant
+                            {
+                                glm::mat4 world;
+                                uint32_t  cascadeIndex;
+                            };
+
+                            ShadowMapConstant sc {unit.transform, m_Data->cascadeIndex};
+                            m_Driver->BindConstantBuffer(0, sizeof(ShadowMapConstant), ShaderStageBits::Vertex, &sc);
+
+                            m_Driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
                         }
-                        struct ShadowMapConstant
-                        {
-                            glm::mat4 world;
-                            uint32_t  cascadeIndex;
-                        };
+                        m_Driver->EndRenderPass(rt.rt);
+                    });
+            }
+        }
+
+        for (auto& cache : m_ShadowCascadeCache)
+        {
+            cache.dirty = false;
+        }
+    }
 
-                        ShadowMapConstant sc {unit.transform, m_Data->cascadeIndex};
-                        // bind shader. this will automatically create a new render pipeline if there's no
-                        // pipeline with same config exists. this would also bind the pipeline
-                        m_Driver->BindVertexBuffer(unit.vertex);
-                        m_Driver->BindIndexBuffer(unit.index);
-                        m_Driver->BindConstantBuffer(0, sizeof(ShadowMapConstant), ShaderStageBits::Vertex, &sc);
+    // all 4 cascades in one render pass, the draw list is replayed once instead of once per cascade
+    void Renderer::DrawShadowMapSinglePass(FrameGraph& fg, FrameGraphResourceHandle<FrameGraphTexture> shadow)
+    {
+        struct ShadowPassData
+        {
+            FrameGraphResourceHandle<FrameGraphTexture> output;
+        };
+
+        fg.AddPass<ShadowPassData>(
+            "shadow cascades",
+            [shadow = shadow, multiview = m_ShadowRenderMode == ShadowRenderMode::Multiview](
+                FrameGraph* fg, PassNode* passNode, ShadowPassData* passData) {
+                FrameGraphTexture::SubresourceDescriptor sub {};
+                sub.baseLayer    = 0;
+                sub.layerCount   = 4;
+                sub.baseLevel    = 0;
+                sub.levelCount   = 1;
+                passData->output = fg->CreateSubresource(shadow, sub);
+
+                FrameGraphRenderTargetDescriptor rtDesc {};
+                rtDesc.useDepth            = true;
+                rtDesc.depthStencil.handle = passData->output;
+                rtDesc.multiview           = multiview;
 
+                fg->Write(passNode, passData->output, TextureUsageBits::DepthStencilAttachment);
+                fg->SetRenderTarget(passNode, rtDesc);
+            },
+            [&](FrameGraph* fg, ShadowPassData* m_Data, PassRenderTarget rt) {
+                bool layered = m_ShadowRenderMode == ShadowRenderMode::Layered;
+
+                m_Driver->SetViewportScissor({0, 0, (int)m_ShadowMapResolution, (int)m_ShadowMapResolution},
+                                             {0, 0, m_ShadowMapResolution, m_ShadowMapResolution});
+                m_Driver->BeginRenderPass(rt.rt);
+                m_Driver->BindShaderSet(
+                    m_Engine->GetShaderSet(layered ? "shadowLayered" : "shadowMultiview")->GetHandle());
+                m_Driver->SetRasterState({Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
+
+                m_Driver->BindBuffer(m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
+                m_Driver->BindVertexBuffer(m_Engine->GetGeometryPool()->GetVertexBuffer());
+                m_Driver->BindIndexBuffer(m_Engine->GetGeometryPool()->GetIndexBuffer());
+                for (uint32_t i = 0; i < m_SceneRenderUnit.size(); i++)
+                {
+                    auto& unit = m_SceneRenderUnit[i];
+                    if (!unit.material->DoCastShadow() || !(m_UnitVisibility[i] & UNIT_VISIBLE_CASCADES))
+                    {
+                        continue;
+                    }
+                    glm::mat4 world = unit.transform;
+                    m_Driver->BindConstantBuffer(0, sizeof(glm::mat4), ShaderStageBits::Vertex, &world);
+
+                    if (layered)
+                    {
+                        // instance i lands in cascade i
+                        m_Driver->DrawIndexedInstanced(unit.vertexOffset, unit.indexOffset, unit.indexCount, 4);
+                    }
+                    else
+                    {
                         m_Driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
                     }
-                    m_Driver->EndRenderPass(rt.rt);
-                });
-        }
+                }
+                m_Driver->EndRenderPass(rt.rt);
+            });
     }
 
     void Renderer::DrawForward(FrameGraph& fg)
@@ -364,7 +938,7 @@ namespace Zephyr
                 fg->GetBlackboard().Set("colorOutput", passData->color);
             },
             [&](FrameGraph* fg, ColorPassData* m_Data, PassRenderTarget rt) {
-                auto dimension = m_Engine->GetWindowDimension();
+                auto dimension = GetRenderDimension();
                 m_Driver->SetViewportScissor({0, 0, (int)dimension.first, (int)dimension.second},
                                              {0, 0, dimension.first, dimension.second});
                 // bind render target
@@ -378,15 +952,21 @@ namespace Zephyr
                 auto shadowMap = shadowResource->GetRHITexture();
 
                 m_Driver->BindTexture(shadowMap, 0, 2, TextureUsageBits::SampledDepthStencil);
-                m_Driver->BindBuffer(m_PointLightBuffer->GetHandle(), 0, 3, BufferUsageBits::UniformDynamic);
+                m_Driver->BindBuffer(
+                    m_PointLightBuffers[m_Engine->GetFrame() % MAX_CONCURRENT_FRAME], 0, 3, BufferUsageBits::Storage);
                 m_Driver->BindTexture(m_Engine->GetDefaultSkybox()->GetHandle(), 0, 1, TextureUsageBits::Sampled);
                 m_Driver->BindShaderSet(m_Engine->GetShaderSet("lit")->GetHandle());
-                for (auto& unit : m_SceneRenderUnit)
+                m_Driver->BindVertexBuffer(m_Engine->GetGeometryPool()->GetVertexBuffer());
+                m_Driver->BindIndexBuffer(m_Engine->GetGeometryPool()->GetIndexBuffer());
+                for (uint32_t i = 0; i < m_SceneRenderUnit.size(); i++)
                 {
+                    auto& unit = m_SceneRenderUnit[i];
+                    if (!(m_UnitVisibility[i] & UNIT_VISIBLE_CAMERA))
+                    {
+                        continue;
+                    }
                     unit.material->Bind(m_Driver);
                     m_Driver->BindConstantBuffer(0, sizeof(glm::mat4), ShaderStageBits::Vertex, &unit.transform);
-                    m_Driver->BindVertexBuffer(unit.vertex);
-                    m_Driver->BindIndexBuffer(unit.index);
 
                     m_Driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
                 }
@@ -401,62 +981,210 @@ namespace Zephyr
                     m_Driver->SetRasterState({Culling::BackFace, FrontFace::CounterClockwise, true, true, false});
                     m_Driver->BindVertexBuffer(skyboxMesh->GetVertexBuffer());
                     m_Driver->BindIndexBuffer(skyboxMesh->GetIndexBuffer());
-                    m_Driver->DrawIndexed(meshlet.baseVertex, meshlet.baseIndex, meshlet.indexCount);
+                    m_Driver->DrawIndexed(meshlet.globalVertexOffset, meshlet.globalIndexOffset, meshlet.indexCount);
                 }
                 m_Driver->EndRenderPass(rt.rt);
             });
     }
 
-    void Renderer::DrawDeferred(FrameGraph& fg)
+    // the scene is rendered into the top left corner of the window sized targets, post composite upscales it
+    std::pair<uint32_t, uint32_t> Renderer::GetRenderDimension()
+    {
+        auto dimension = m_Engine->GetWindowDimension();
+        return {std::max(1u, (uint32_t)(dimension.first * m_RenderScale)),
+                std::max(1u, (uint32_t)(dimension.second * m_RenderScale))};
+    }
+
+    // xy: uv scale from the window to the rendered region zw: uv clamp half a texel inside it
+    glm::vec4 Renderer::GetRenderViewport()
+    {
+        auto window = m_Engine->GetWindowDimension();
+        auto render = GetRenderDimension();
+        return glm::vec4((float)render.first / window.first,
+                         (float)render.second / window.second,
+                         (render.first - .5f) / window.first,
+                         (render.second - .5f) / window.second);
+    }
+
+    TextureDescription Renderer::GetSceneDepthDescription()
+    {
+        auto dimension = m_Engine->GetWindowDimension();
+
+        TextureDescription desc {};
+        desc.width     = dimension.first;
+        desc.height    = dimension.second;
+        desc.depth     = 1;
+        desc.levels    = 1;
+        desc.samples   = 1;
+        desc.format    = TextureFormat::DEPTH24_STENCIL8;
+        // the lighting pass reconstructs positions from it
+        desc.usage     = TextureUsageBits::DepthStencilAttachment | TextureUsageBits::Sampled;
+        desc.sampler   = SamplerType::Sampler2D;
+        desc.pipelines = PipelineTypeBits::Graphics;
+        if (m_OcclusionCulling)
+        {
+            // the hi-z build reads the early depth
+            desc.pipelines |= PipelineTypeBits::Compute;
+        }
+        return desc;
+    }
+
+    void Renderer::DrawDepthPrepass(FrameGraph& fg, OcclusionCullPhase phase)
+    {
+        struct DepthPrepassData
+        {
+            FrameGraphResourceHandle<FrameGraphTexture> depthStencil;
+        };
+
+        bool late     = phase == OcclusionCullPhase::Late;
+        bool indirect = m_OcclusionCulling;
+
+        fg.AddPass<DepthPrepassData>(
+            late ? "depth prepass late" : "depth prepass",
+            [self = this, late](FrameGraph* fg, PassNode* node, DepthPrepassData* data) {
+                auto& blackboard = fg->GetBlackboard();
+                if (late)
+                {
+                    data->depthStencil = blackboard.Get("geometryDepthStencil");
+                }
+                else
+                {
+                    data->depthStencil = fg->CreateTexture(self->GetSceneDepthDescription());
+                    blackboard.Set("geometryDepthStencil", data->depthStencil);
+                }
+
+                fg->Write(node, data->depthStencil, TextureUsageBits::DepthStencilAttachment);
+
+                FrameGraphRenderTargetDescriptor rtDesc {};
+                rtDesc.depthStencil = {data->depthStencil, !late, true};
+                rtDesc.useDepth     = true;
+                rtDesc.present      = false;
+
+                fg->SetRenderTarget(node, rtDesc);
+
+                node->SideEffect();
+            },
+            [engine = m_Engine, driver = m_Driver, self = this, late, indirect](
+                FrameGraph* fg, DepthPrepassData* data, PassRenderTarget rt) {
+                auto dimension = self->GetRenderDimension();
+                driver->SetViewportScissor({0, 0, (int)dimension.first, (int)dimension.second},
+                                           {0, 0, dimension.first, dimension.second});
+                driver->BeginRenderPass(rt.rt);
+                // same culling as the geometry pass, or the EQUAL test would reject its fragments
+                driver->SetRasterState({Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
+                driver->BindBuffer(self->m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
+
+                driver->BindShaderSet(engine->GetShaderSet("depthPrepass")->GetHandle());
+                driver->BindVertexBuffer(engine->GetGeometryPool()->GetPositionBuffer());
+                driver->BindIndexBuffer(engine->GetGeometryPool()->GetIndexBuffer());
+
+                auto drawBuffer = late ? self->m_LateDrawBuffer : self->m_EarlyDrawBuffer;
+                for (uint32_t i = 0; i < self->m_SceneRenderUnit.size(); i++)
+                {
+                    auto& unit = self->m_SceneRenderUnit[i];
+                    if (!(self->m_UnitVisibility[i] & UNIT_VISIBLE_CAMERA))
+                    {
+                        continue;
+                    }
+                    driver->BindConstantBuffer(0, sizeof(glm::mat4), ShaderStageBits::Vertex, &unit.transform);
+
+                    if (indirect)
+                    {
+                        driver->DrawIndexedIndirect(drawBuffer, i * sizeof(DrawIndexedIndirectCommand));
+                    }
+                    else
+                    {
+                        driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
+                    }
+                }
+                driver->EndRenderPass(rt.rt);
+            });
+    }
+
+    void Renderer::DrawGeometry(FrameGraph& fg, OcclusionCullPhase phase)
     {
         struct GeometryData
         {
-            // albedo metalness
+            // albedo metalness, rgba8
             FrameGraphResourceHandle<FrameGraphTexture> color0;
-            // normal roughness
+            // octahedral normal, rg16
             FrameGraphResourceHandle<FrameGraphTexture> color1;
-            // position occlusion
+            // roughness occlusion flags, rgba8
             FrameGraphResourceHandle<FrameGraphTexture> color2;
-            // emission
+            // emission, r11g11b10
             FrameGraphResourceHandle<FrameGraphTexture> color3;
             FrameGraphResourceHandle<FrameGraphTexture> depthStencil;
         };
-        auto geometryPass = fg.AddPass<GeometryData>(
-            "geometry",
-            [engine = m_Engine](FrameGraph* fg, PassNode* node, GeometryData* data) {
+        bool late     = phase == OcclusionCullPhase::Late;
+        bool indirect = m_OcclusionCulling;
+        bool prepass  = m_DepthPrepass;
+
+        fg.AddPass<GeometryData>(
+            late ? "geometry late" : "geometry",
+            [engine = m_Engine, self = this, late, prepass](FrameGraph* fg, PassNode* node, GeometryData* data) {
+                auto& blackboard = fg->GetBlackboard();
+                if (late)
+                {
+                    // draw on top of the early phase
+                    data->color0       = blackboard.Get("albedoMetalness");
+                    data->color1       = blackboard.Get("normal");
+                    data->color2       = blackboard.Get("roughnessOcclusion");
+                    data->color3       = blackboard.Get("emission");
+                    data->depthStencil = blackboard.Get("geometryDepthStencil");
+
+                    fg->Write(node, data->color0, TextureUsageBits::ColorAttachment);
+                    fg->Write(node, data->color1, TextureUsageBits::ColorAttachment);
+                    fg->Write(node, data->color2, TextureUsageBits::ColorAttachment);
+                    fg->Write(node, data->color3, TextureUsageBits::ColorAttachment);
+                    fg->Write(node, data->depthStencil, TextureUsageBits::DepthStencilAttachment);
+
+                    FrameGraphRenderTargetDescriptor rtDesc {};
+                    rtDesc.color.push_back({data->color0, false, true});
+                    rtDesc.color.push_back({data->color1, false, true});
+                    rtDesc.color.push_back({data->color2, false, true});
+                    rtDesc.color.push_back({data->color3, false, true});
+                    rtDesc.depthStencil = {data->depthStencil, false, true};
+                    rtDesc.useDepth     = true;
+                    rtDesc.present      = false;
+
+                    fg->SetRenderTarget(node, rtDesc);
+
+                    node->SideEffect();
+                    return;
+                }
+
                 std::pair<uint32_t, uint32_t> windowDimension = engine->GetWindowDimension();
 
-                // we need 16-bits color attachments for hdr color output && emission && position
+                // 16 bytes per pixel, position is reconstructed from depth in the lighting pass
                 TextureDescription colorDesc {};
                 colorDesc.width     = windowDimension.first;
                 colorDesc.height    = windowDimension.second;
                 colorDesc.depth     = 1;
                 colorDesc.levels    = 1;
                 colorDesc.samples   = 1;
-                colorDesc.format    = TextureFormat::RGBA16_SFLOAT;
+                colorDesc.format    = TextureFormat::RGBA8_UNORM;
                 colorDesc.usage     = TextureUsageBits::ColorAttachment | TextureUsageBits::Sampled;
                 colorDesc.sampler   = SamplerType::Sampler2D;
                 colorDesc.pipelines = PipelineTypeBits::Graphics;
                 data->color0        = fg->CreateTexture(colorDesc, false);
-                data->color3        = fg->CreateTexture(colorDesc, false);
                 data->color2        = fg->CreateTexture(colorDesc, false);
-                data->color1        = fg->CreateTexture(colorDesc);
 
-                // for rest of the attachments, signed rba8 will do
-                // colorDesc.format = TextureFormat::RGBA8_SNORM;
+                colorDesc.format = TextureFormat::RG16_UNORM;
+                data->color1     = fg->CreateTexture(colorDesc, false);
 
-                TextureDescription dsDesc {};
-                dsDesc.width     = windowDimension.first;
-                dsDesc.height    = windowDimension.second;
-                dsDesc.depth     = 1;
-                dsDesc.levels    = 1;
-                dsDesc.samples   = 1;
-                dsDesc.format    = TextureFormat::DEPTH24_STENCIL8;
-                dsDesc.usage     = TextureUsageBits::DepthStencilAttachment;
-                dsDesc.sampler   = SamplerType::Sampler2D;
-                dsDesc.pipelines = PipelineTypeBits::Graphics;
+                // emission is hdr
+                colorDesc.format = TextureFormat::R11G11B10_UFLOAT;
+                data->color3     = fg->CreateTexture(colorDesc, false);
 
-                data->depthStencil = fg->CreateTexture(dsDesc);
+                // the depth pre-pass already laid down the final depth
+                if (prepass)
+                {
+                    data->depthStencil = blackboard.Get("geometryDepthStencil");
+                }
+                else
+                {
+                    data->depthStencil = fg->CreateTexture(self->GetSceneDepthDescription());
+                }
 
                 fg->Write(node, data->color0, TextureUsageBits::ColorAttachment);
                 fg->Write(node, data->color1, TextureUsageBits::ColorAttachment);
@@ -465,10 +1193,9 @@ namespace Zephyr
 
                 fg->Write(node, data->depthStencil, TextureUsageBits::DepthStencilAttachment);
 
-                auto& blackboard = fg->GetBlackboard();
                 blackboard.Set("albedoMetalness", data->color0);
-                blackboard.Set("normalRoughness", data->color1);
-                blackboard.Set("positionOcclusion", data->color2);
+                blackboard.Set("normal", data->color1);
+                blackboard.Set("roughnessOcclusion", data->color2);
                 blackboard.Set("emission", data->color3);
                 blackboard.Set("geometryDepthStencil", data->depthStencil);
 
@@ -477,7 +1204,7 @@ namespace Zephyr
                 rtDesc.color.push_back({data->color1, true, true});
                 rtDesc.color.push_back({data->color2, true, true});
                 rtDesc.color.push_back({data->color3, true, true});
-                rtDesc.depthStencil = {data->depthStencil, true, true};
+                rtDesc.depthStencil = {data->depthStencil, !prepass, true};
                 rtDesc.useDepth     = true;
                 rtDesc.present      = false;
 
@@ -485,42 +1212,98 @@ namespace Zephyr
 
                 node->SideEffect();
             },
-            [engine = m_Engine, driver = m_Driver, self = this](
+            [engine = m_Engine, driver = m_Driver, self = this, late, indirect, prepass](
                 FrameGraph* fg, GeometryData* data, PassRenderTarget rt) {
                 auto c0 = static_cast<VirtualResource*>(fg->GetResource(data->color0))->GetRHITexture();
                 auto c1 = static_cast<VirtualResource*>(fg->GetResource(data->color1))->GetRHITexture();
                 auto c2 = static_cast<VirtualResource*>(fg->GetResource(data->color2))->GetRHITexture();
                 auto c3 = static_cast<VirtualResource*>(fg->GetResource(data->color3))->GetRHITexture();
 
-                auto dimension = engine->GetWindowDimension();
+                auto dimension = self->GetRenderDimension();
                 driver->SetViewportScissor({0, 0, (int)dimension.first, (int)dimension.second},
                                            {0, 0, dimension.first, dimension.second});
                 // bind render target
                 driver->BeginRenderPass(rt.rt);
-                driver->SetRasterState({Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
+                if (prepass)
+                {
+                    // only the visible surface passes, each pixel is shaded once
+                    driver->SetRasterState(
+                        {Culling::FrontFace, FrontFace::CounterClockwise, true, false, false, CompareOp::Equal});
+                }
+                else
+                {
+                    driver->SetRasterState({Culling::FrontFace, FrontFace::CounterClockwise, true, true, false});
+                }
                 auto handle = self->m_GlobalRingBuffer->GetHandle();
                 driver->BindBuffer(self->m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
 
                 driver->BindShaderSet(engine->GetShaderSet("deferredGeometry")->GetHandle());
-                for (auto& unit : self->m_SceneRenderUnit)
+                driver->BindVertexBuffer(engine->GetGeometryPool()->GetVertexBuffer());
+                driver->BindIndexBuffer(engine->GetGeometryPool()->GetIndexBuffer());
+                // culled units keep their draw with a zero instance count
+                auto drawBuffer = late ? self->m_LateDrawBuffer : self->m_EarlyDrawBuffer;
+                for (uint32_t i = 0; i < self->m_SceneRenderUnit.size(); i++)
                 {
+                    auto& unit = self->m_SceneRenderUnit[i];
+                    // outside the frustum, the gpu would cull it anyway
+                    if (!(self->m_UnitVisibility[i] & UNIT_VISIBLE_CAMERA))
+                    {
+                        continue;
+                    }
                     unit.material->Bind(driver);
                     driver->BindConstantBuffer(0, sizeof(glm::mat4), ShaderStageBits::Vertex, &unit.transform);
-                    driver->BindVertexBuffer(unit.vertex);
-                    driver->BindIndexBuffer(unit.index);
 
-                    driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
+                    if (indirect)
+                    {
+                        driver->DrawIndexedIndirect(drawBuffer, i * sizeof(DrawIndexedIndirectCommand));
+                    }
+                    else
+                    {
+                        driver->DrawIndexed(unit.vertexOffset, unit.indexOffset, unit.indexCount);
+                    }
                 }
                 driver->EndRenderPass(rt.rt);
             });
+    }
+
+    void Renderer::DrawDeferred(FrameGraph& fg)
+    {
+        if (m_OcclusionCulling)
+        {
+            // hi-z history of the previous frame, rebuilt in place once the early geometry is drawn
+            auto hiZ = fg.ImportTexture(m_HiZDescription, m_HiZ);
+            fg.GetBlackboard().Set("hiZ", hiZ);
+
+            DispatchOcclusionCulling(fg, OcclusionCullPhase::Early);
+            if (m_DepthPrepass)
+            {
+                DrawDepthPrepass(fg, OcclusionCullPhase::Early);
+            }
+            DrawGeometry(fg, OcclusionCullPhase::Early);
+            BuildHiZ(fg);
+            DispatchOcclusionCulling(fg, OcclusionCullPhase::Late);
+            if (m_DepthPrepass)
+            {
+                DrawDepthPrepass(fg, OcclusionCullPhase::Late);
+            }
+            DrawGeometry(fg, OcclusionCullPhase::Late);
+        }
+        else
+        {
+            if (m_DepthPrepass)
+            {
+                DrawDepthPrepass(fg, OcclusionCullPhase::Early);
+            }
+            DrawGeometry(fg, OcclusionCullPhase::Early);
+        }
 
         struct LightingData
         {
-            // albedo roughness
+            // albedo metalness
             FrameGraphResourceHandle<FrameGraphTexture> color0;
-            // normal metalness
+            // octahedral normal
             FrameGraphResourceHandle<FrameGraphTexture> color1;
-            // position occlusion
+            // roughness occlusion flags
             FrameGraphResourceHandle<FrameGraphTexture> color2;
             // emission
             FrameGraphResourceHandle<FrameGraphTexture> color3;
@@ -528,7 +1311,7 @@ namespace Zephyr
             FrameGraphResourceHandle<FrameGraphTexture> shadow;
             // color output
             FrameGraphResourceHandle<FrameGraphTexture> color;
-            // disable writes and reuse depthstencil from geometry pass(mainly for skybox rendering)
+            // sampled for position reconstruction, background pixels get the skybox
             FrameGraphResourceHandle<FrameGraphTexture> depthStencil;
         };
 
@@ -538,8 +1321,8 @@ namespace Zephyr
                 std::pair<uint32_t, uint32_t> windowDimension = engine->GetWindowDimension();
                 auto&                         blackboard      = fg->GetBlackboard();
                 data->color0                                  = blackboard.Get("albedoMetalness");
-                data->color1                                  = blackboard.Get("normalRoughness");
-                data->color2                                  = blackboard.Get("positionOcclusion");
+                data->color1                                  = blackboard.Get("normal");
+                data->color2                                  = blackboard.Get("roughnessOcclusion");
                 data->color3                                  = blackboard.Get("emission");
                 data->shadow                                  = blackboard.Get("shadow");
                 data->depthStencil                            = blackboard.Get("geometryDepthStencil");
@@ -562,14 +1345,13 @@ namespace Zephyr
                 fg->Read(node, data->color2, TextureUsageBits::Sampled);
                 fg->Read(node, data->color3, TextureUsageBits::Sampled);
                 fg->Read(node, data->shadow, TextureUsageBits::SampledDepthStencil);
-                fg->Read(node, data->depthStencil, TextureUsageBits::DepthStencilAttachment);
+                fg->Read(node, data->depthStencil, TextureUsageBits::SampledDepthStencil);
                 fg->Write(node, data->color, TextureUsageBits::ColorAttachment);
 
                 FrameGraphRenderTargetDescriptor rtDesc {};
                 rtDesc.color.push_back({data->color, true, true});
-                rtDesc.depthStencil = {data->depthStencil, false, false};
-                rtDesc.useDepth     = true;
-                rtDesc.present      = false;
+                rtDesc.useDepth = false;
+                rtDesc.present  = false;
 
                 fg->SetRenderTarget(node, rtDesc);
 
@@ -580,7 +1362,7 @@ namespace Zephyr
             [engine = m_Engine, driver = m_Driver, self = this](
                 FrameGraph* fg, LightingData* data, PassRenderTarget rt) {
                 auto& blackboard = fg->GetBlackboard();
-                auto  dimension  = engine->GetWindowDimension();
+                auto  dimension  = self->GetRenderDimension();
 
                 driver->BindShaderSet(engine->GetShaderSet("deferredLighting")->GetHandle());
                 driver->SetViewportScissor({0, 0, (int)dimension.first, (int)dimension.second},
@@ -595,32 +1377,226 @@ namespace Zephyr
                 auto color1    = static_cast<VirtualResource*>(fg->GetResource(data->color1))->GetRHITexture();
                 auto color2    = static_cast<VirtualResource*>(fg->GetResource(data->color2))->GetRHITexture();
                 auto color3    = static_cast<VirtualResource*>(fg->GetResource(data->color3))->GetRHITexture();
+                auto depth     = static_cast<VirtualResource*>(fg->GetResource(data->depthStencil))->GetRHITexture();
 
                 driver->BindBuffer(self->m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
                 driver->BindTexture(shadowMap, 0, 1, TextureUsageBits::SampledDepthStencil);
-                driver->BindBuffer(self->m_PointLightBuffer->GetHandle(), 0, 2, BufferUsageBits::UniformDynamic);
+                driver->BindBuffer(self->m_PointLightBuffers[engine->GetFrame() % MAX_CONCURRENT_FRAME],
+                                   0,
+                                   2,
+                                   BufferUsageBits::Storage);
                 driver->BindTexture(engine->GetDefaultPrefilteredEnv()->GetHandle(), 0, 3, TextureUsageBits::Sampled);
                 driver->BindTexture(engine->GetBRDFLut()->GetHandle(), 0, 4, TextureUsageBits::Sampled);
+                driver->BindBuffer(self->m_ClusterLightGridBuffer, 0, 5, BufferUsageBits::Storage);
+                driver->BindBuffer(self->m_ClusterLightIndexBuffer, 0, 6, BufferUsageBits::Storage);
                 driver->BindTexture(color0, 1, 0, TextureUsageBits::Sampled);
                 driver->BindTexture(color1, 1, 1, TextureUsageBits::Sampled);
                 driver->BindTexture(color2, 1, 2, TextureUsageBits::Sampled);
                 driver->BindTexture(color3, 1, 3, TextureUsageBits::Sampled);
+                driver->BindTexture(depth, 1, 4, TextureUsageBits::SampledDepthStencil);
 
+                // background pixels sample the environment directly, no separate skybox draw
                 driver->Draw(3, 0);
-                if (true)
+
+                driver->EndRenderPass(rt.rt);
+            });
+    }
+
+    void Renderer::DispatchOcclusionCulling(FrameGraph& fg, OcclusionCullPhase phase)
+    {
+        struct OcclusionCullData
+        {
+            FrameGraphResourceHandle<FrameGraphTexture> hiZ;
+        };
+
+        // early tests against the previous frame's pyramid, late against the one built from the early depth
+        OcclusionCullConstant constant {};
+        constant.unitCount = m_SceneRenderUnit.size();
+        constant.phase     = static_cast<uint32_t>(phase);
+        constant.hiZLevels = m_HiZDescription.levels;
+        if (phase == OcclusionCullPhase::Early)
+        {
+            constant.hiZViewProjection = m_HiZViewProjection;
+            constant.hiZValid          = m_HiZValid;
+        }
+        else
+        {
+            constant.hiZViewProjection = m_GlobalShaderData.vp;
+            constant.hiZValid          = true;
+        }
+
+        fg.AddPass<OcclusionCullData>(
+            phase == OcclusionCullPhase::Early ? "occlusion cull early" : "occlusion cull late",
+            [](FrameGraph* fg, PassNode* node, OcclusionCullData* data) {
+                data->hiZ = fg->GetBlackboard().Get("hiZ");
+                fg->Read(node, data->hiZ, TextureUsageBits::Sampled);
+
+                // the indirect draw buffers aren't tracked by the graph, keep it alive
+                node->SideEffect();
+            },
+            [engine = m_Engine, driver = m_Driver, self = this, constant](
+                FrameGraph* fg, OcclusionCullData* data, PassRenderTarget rt) {
+                if (constant.unitCount == 0)
                 {
-                    driver->SetRasterState({Culling::BackFace, FrontFace::CounterClockwise, true, false, false});
-                    driver->BindShaderSet(engine->GetShaderSet("skybox")->GetHandle());
-                    driver->BindTexture(
-                        engine->GetDefaultPrefilteredEnv()->GetHandle(), 0, 1, TextureUsageBits::Sampled);
-                    auto skyboxMesh = engine->GetSkyboxMesh();
-                    auto meshlet    = skyboxMesh->GetSubmeshes()[0];
-                    driver->BindVertexBuffer(skyboxMesh->GetVertexBuffer());
-                    driver->BindIndexBuffer(skyboxMesh->GetIndexBuffer());
-                    driver->DrawIndexed(meshlet.baseVertex, meshlet.baseIndex, meshlet.indexCount);
+                    return;
                 }
 
-                driver->EndRenderPass(rt.rt);
+                auto frame      = engine->GetFrame() % MAX_CONCURRENT_FRAME;
+                auto drawBuffer = constant.phase == 0 ? self->m_EarlyDrawBuffer : self->m_LateDrawBuffer;
+                auto hiZ        = static_cast<VirtualResource*>(fg->GetResource(data->hiZ))->GetRHITexture();
+
+                driver->BindShaderSet(engine->GetShaderSet("occlusionCull")->GetHandle());
+                driver->BindBuffer(self->m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
+                driver->BindBuffer(self->m_OcclusionUnitBuffers[frame], 0, 1, BufferUsageBits::Storage);
+                driver->BindBuffer(drawBuffer, 0, 2, BufferUsageBits::Storage);
+                driver->BindBuffer(self->m_EarlyDrawBuffer, 0, 3, BufferUsageBits::Storage);
+                driver->BindTexture(hiZ, 0, 4, TextureUsageBits::Sampled);
+
+                OcclusionCullConstant pc = constant;
+                driver->BindConstantBuffer(0, sizeof(OcclusionCullConstant), ShaderStageBits::Compute, &pc);
+
+                uint32_t groupCount =
+                    constant.unitCount % 64 == 0 ? constant.unitCount / 64 : constant.unitCount / 64 + 1;
+                driver->Dispatch(groupCount, 1, 1);
+            });
+    }
+
+    void Renderer::BuildHiZ(FrameGraph& fg)
+    {
+        struct HiZBuildData
+        {
+            FrameGraphResourceHandle<FrameGraphTexture> input;
+            FrameGraphResourceHandle<FrameGraphTexture> output;
+        };
+
+        // level 0 takes the max of the depth footprint, every other level reduces the one above it
+        for (uint32_t i = 0; i < m_HiZDescription.levels; i++)
+        {
+            fg.AddPass<HiZBuildData>(
+                "hi-z build " + std::to_string(i),
+                [i = i](FrameGraph* fg, PassNode* node, HiZBuildData* data) {
+                    auto& blackboard = fg->GetBlackboard();
+                    auto  hiZ        = blackboard.Get("hiZ");
+
+                    FrameGraphTexture::SubresourceDescriptor sub {};
+                    sub.baseLayer  = 0;
+                    sub.layerCount = 1;
+                    sub.levelCount = 1;
+
+                    if (i == 0)
+                    {
+                        data->input = blackboard.Get("geometryDepthStencil");
+                        fg->Read(node, data->input, TextureUsageBits::SampledDepthStencil);
+                    }
+                    else
+                    {
+                        sub.baseLevel = i - 1;
+                        data->input   = fg->CreateSubresource(hiZ, sub);
+                        fg->Read(node, data->input, TextureUsageBits::Sampled);
+                    }
+
+                    sub.baseLevel = i;
+                    data->output  = fg->CreateSubresource(hiZ, sub);
+                    fg->Write(node, data->output, TextureUsageBits::Storage);
+
+                    node->SideEffect();
+                },
+                [engine = m_Engine, driver = m_Driver, desc = m_HiZDescription, dimension = GetRenderDimension(), i = i](
+                    FrameGraph* fg, HiZBuildData* data, PassRenderTarget) {
+                    struct HiZBuildConstant
+                    {
+                        glm::ivec2 inputSize;
+                        glm::ivec2 outputSize;
+                    };
+
+                    // the depth is only valid inside the rendered region
+                    HiZBuildConstant pc {};
+                    pc.outputSize = glm::ivec2(std::max(desc.width >> i, 1u), std::max(desc.height >> i, 1u));
+                    pc.inputSize  = i == 0 ? glm::ivec2(dimension.first, dimension.second) :
+                                             glm::ivec2(std::max(desc.width >> (i - 1), 1u),
+                                                        std::max(desc.height >> (i - 1), 1u));
+
+                    auto input  = static_cast<VirtualResource*>(fg->GetResource(data->input));
+                    auto output = static_cast<VirtualResource*>(fg->GetResource(data->output));
+
+                    driver->BindShaderSet(engine->GetShaderSet("hiZBuild")->GetHandle());
+                    driver->BindTexture(
+                        output->GetRHITexture(), output->GetViewRange(), 0, 0, TextureUsageBits::Storage);
+                    if (i == 0)
+                    {
+                        driver->BindTexture(input->GetRHITexture(), 0, 1, TextureUsageBits::SampledDepthStencil);
+                    }
+                    else
+                    {
+                        driver->BindTexture(
+                            input->GetRHITexture(), input->GetViewRange(), 0, 1, TextureUsageBits::Sampled);
+                    }
+                    driver->BindConstantBuffer(0, sizeof(HiZBuildConstant), ShaderStageBits::Compute, &pc);
+
+                    uint32_t groupCountX =
+                        pc.outputSize.x % 16 == 0 ? pc.outputSize.x / 16 : pc.outputSize.x / 16 + 1;
+                    uint32_t groupCountY =
+                        pc.outputSize.y % 16 == 0 ? pc.outputSize.y / 16 : pc.outputSize.y / 16 + 1;
+                    driver->Dispatch(groupCountX, groupCountY, 1);
+                });
+        }
+    }
+
+    void Renderer::GeneratePendingMips(FrameGraph& fg)
+    {
+        struct MipGenerationData
+        {
+        };
+
+        for (auto texture : m_PendingMipTextures)
+        {
+            fg.AddPass<MipGenerationData>(
+                "generate mips",
+                [](FrameGraph* fg, PassNode* node, MipGenerationData* data) {
+                    // the texture is not a frame graph resource, keep the pass alive on its own
+                    node->SideEffect();
+                },
+                [driver = m_Driver, downsampler = &m_Downsampler, handle = texture->GetHandle(),
+                 desc = texture->GetDescription()](FrameGraph* fg, MipGenerationData* data, PassRenderTarget) {
+                    ViewRange base  = {0, 1, 0, 1};
+                    ViewRange chain = {0, 1, 1, desc.levels - 1};
+
+                    // transitions are recorded by hand, every level ends up readable by the material passes
+                    driver->SetupBarrier(handle, base, TextureUsageBits::Sampled, PipelineTypeBits::Compute);
+                    driver->SetupBarrier(handle, chain, TextureUsageBits::Storage, PipelineTypeBits::Compute);
+                    downsampler->Dispatch(handle, desc.width, desc.height, desc.levels - 1, false);
+                    driver->SetupBarrier(handle, chain, TextureUsageBits::Sampled, PipelineTypeBits::Compute);
+                });
+        }
+        m_PendingMipTextures.clear();
+    }
+
+    void Renderer::DispatchLightCulling(FrameGraph& fg)
+    {
+        struct LightCullingData
+        {
+        };
+
+        fg.AddPass<LightCullingData>(
+            "light culling",
+            [](FrameGraph* fg, PassNode* node, LightCullingData* data) {
+                // only touches buffers, keep it alive so the lighting pass sees the clusters
+                node->SideEffect();
+            },
+            [engine = m_Engine, driver = m_Driver, self = this](
+                FrameGraph* fg, LightCullingData* data, PassRenderTarget rt) {
+                driver->BindBuffer(self->m_GlobalRingBuffer->GetHandle(), 0, 0, BufferUsageBits::StorageDynamic);
+                driver->BindBuffer(self->m_PointLightBuffers[engine->GetFrame() % MAX_CONCURRENT_FRAME],
+                                   0,
+                                   1,
+                                   BufferUsageBits::Storage);
+                driver->BindBuffer(self->m_ClusterLightGridBuffer, 0, 2, BufferUsageBits::Storage);
+                driver->BindBuffer(self->m_ClusterLightIndexBuffer, 0, 3, BufferUsageBits::Storage);
+                driver->BindShaderSet(engine->GetShaderSet("clusterLightCulling")->GetHandle());
+
+                // one invocation per cluster, 128 per group
+                uint32_t groupCount = CLUSTER_COUNT % 128 == 0 ? CLUSTER_COUNT / 128 : CLUSTER_COUNT / 128 + 1;
+                driver->Dispatch(groupCount, 1, 1);
             });
     }
 
@@ -649,8 +1625,7 @@ namespace Zephyr
                 colorDesc.pipelines = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
 
                 passData->color = fg->CreateTexture(colorDesc, true);
-                passData->input = fg->GetBlackboard().Get("postCompute");
-                // passData->input = fg->GetBlackboard().Get("colorOutput");
+                passData->input = fg->GetBlackboard().Get("postComposite");
 
                 fg->Write(passNode, passData->color, TextureUsageBits::ColorAttachment);
                 fg->Read(passNode, passData->input, TextureUsageBits::Sampled);
@@ -664,80 +1639,36 @@ namespace Zephyr
 
                 fg->SetRenderTarget(passNode, rtDesc);
             },
-            [engine = m_Engine, driver = m_Driver](FrameGraph* fg, ResolvePassData* m_Data, PassRenderTarget rt) {
+            [engine = m_Engine, driver = m_Driver, settings = m_PostProcess, fxaa = m_FXAAConstant](
+                FrameGraph* fg, ResolvePassData* m_Data, PassRenderTarget rt) {
                 auto dimension  = engine->GetWindowDimension();
                 auto colorInput = static_cast<VirtualResource*>(fg->GetResource(m_Data->input))->GetRHITexture();
                 auto dither     = engine->GetDither()->GetHandle();
 
+                // fxaa runs here on the graded image, so the swapchain write is the only extra full screen pass
+                std::vector<uint32_t> specialization = {settings.fxaa, settings.dither};
+                FXAAConstant          pc             = fxaa;
+
                 driver->SetViewportScissor({0, dimension.second, (int)dimension.first, -(int)dimension.second},
                                            {0, 0, dimension.first, dimension.second});
                 driver->SetRasterState({Culling::None, FrontFace::CounterClockwise, false, false, false});
-                driver->BindTexture(colorInput, 0, 0, TextureUsageBits::Sampled);
+                driver->BindTexture(colorInput, 0, 0, TextureUsageBits::Sampled, SamplerWrap::ClampToEdge);
                 driver->BindTexture(dither, 0, 1, TextureUsageBits::Sampled, SamplerWrap::Repeat);
                 // bind shader
-                driver->BindShaderSet(engine->GetShaderSet("resolve")->GetHandle());
+                driver->BindShaderSet(engine->GetShaderSet("resolve", specialization)->GetHandle());
+                driver->BindConstantBuffer(0, sizeof(FXAAConstant), ShaderStageBits::Fragment, &pc);
                 driver->BeginRenderPass(rt.rt);
                 driver->Draw(3, 0);
                 driver->EndRenderPass(rt.rt);
             });
     }
 
-    void Renderer::DispatchPostProcessingCompute(FrameGraph& fg)
-    {
-        struct PostProcessingComputePassData
-        {
-            FrameGraphResourceHandle<FrameGraphTexture> input;
-            FrameGraphResourceHandle<FrameGraphTexture> storage;
-        };
-        auto computePass = fg.AddPass<PostProcessingComputePassData>(
-            "post compute",
-            [engine = m_Engine](FrameGraph* fg, PassNode* passNode, PostProcessingComputePassData* data) {
-                data->input = fg->GetBlackboard().Get("fxaa");
-
-                std::pair<uint32_t, uint32_t> windowDimension = engine->GetWindowDimension();
-
-                TextureDescription desc {};
-                desc.width     = windowDimension.first;
-                desc.height    = windowDimension.second;
-                desc.depth     = 1;
-                desc.levels    = 1;
-                desc.samples   = 1;
-                desc.format    = TextureFormat::RGBA16_SFLOAT;
-                desc.usage     = TextureUsageBits::Storage | TextureUsageBits::Sampled;
-                desc.sampler   = SamplerType::Sampler2D;
-                desc.pipelines = PipelineTypeBits::Graphics | PipelineTypeBits::Compute;
-
-                data->storage = fg->CreateTexture(desc);
-
-                fg->Write(passNode, data->storage, TextureUsageBits::Storage);
-                fg->Read(passNode, data->input, TextureUsageBits::Sampled);
-                fg->GetBlackboard().Set("postCompute", data->storage);
-            },
-            [engine = m_Engine,
-             driver = m_Driver](FrameGraph* fg, PostProcessingComputePassData* m_Data, PassRenderTarget rt) {
-                auto dimension  = engine->GetWindowDimension();
-                auto input      = static_cast<VirtualResource*>(fg->GetResource(m_Data->input))->GetRHITexture();
-                auto inputRange = static_cast<VirtualResource*>(fg->GetResource(m_Data->input))->GetViewRange();
-                auto storage    = static_cast<VirtualResource*>(fg->GetResource(m_Data->storage))->GetRHITexture();
-
-                driver->BindTexture(storage, 0, 0, TextureUsageBits::Storage);
-                driver->BindTexture(input, inputRange, 0, 1, TextureUsageBits::Sampled);
-                // bind shader
-                driver->BindShaderSet(engine->GetShaderSet("postCompute")->GetHandle());
-
-                uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
-                uint32_t groupCountY = dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
-                driver->Dispatch(groupCountX, groupCountY, 1);
-            });
-    }
-
     void Renderer::DispatchBloomCompute(FrameGraph& fg)
     {
         struct BloomComputeData
         {
             FrameGraphResourceHandle<FrameGraphTexture> downsample;
             FrameGraphResourceHandle<FrameGraphTexture> upsample;
-            FrameGraphResourceHandle<FrameGraphTexture> composite;
             float                                       threshold;
             float                                       downsampleCount;
         };
@@ -764,18 +1695,10 @@ namespace Zephyr
 
                 desc.levels--;
                 data->upsample = fg->CreateTexture(desc);
-                // we dont need mipmaps for the composite image
-                // DON'T USE RGBA8 HERE EVEN IF WE'RE DOING TONEMAPPING IN COMPOSITE
-                // USING RGBA8 WILL CAUSE SEVERE COLOR BANDING ISSUE
-                desc.levels = 1;
-                desc.format = TextureFormat::RGBA16_SFLOAT;
-
-                data->composite = fg->CreateTexture(desc);
 
                 auto& blackboard = fg->GetBlackboard();
                 blackboard.Set("bloomDownsample", data->downsample);
                 blackboard.Set("bloomUpsample", data->upsample);
-                blackboard.Set("bloomComposite", data->composite);
             },
             [](FrameGraph* fg, BloomComputeData* data, PassRenderTarget) {});
 
@@ -809,13 +1732,16 @@ namespace Zephyr
                 auto& blackboard = fg->GetBlackboard();
                 blackboard.Set("bloomPrefilterResult", data->prefilterTarget);
             },
-            [engine = m_Engine, driver = m_Driver](FrameGraph* fg, PrefilterData* data, PassRenderTarget) {
+            [engine = m_Engine, driver = m_Driver, viewport = GetRenderViewport()](
+                FrameGraph* fg, PrefilterData* data, PassRenderTarget) {
                 struct BloomPrefilterConstant
                 {
                     glm::vec4 data;
+                    glm::vec4 viewport;
                 };
 
-                BloomPrefilterConstant pc = {{1., .0, 0., 0.}};
+                // bloom stays at output resolution, the prefilter upscales the rendered region
+                BloomPrefilterConstant pc = {{1., .0, 0., 0.}, viewport};
 
                 auto dimension = engine->GetWindowDimension();
                 driver->BindShaderSet(engine->GetShaderSet("bloomPrefilter")->GetHandle());
@@ -826,75 +1752,122 @@ namespace Zephyr
                     static_cast<VirtualResource*>(fg->GetResource(data->prefilterTarget))->GetViewRange();
                 driver->BindTexture(storage, storageRange, 0, 0, TextureUsageBits::Storage);
                 driver->BindTexture(input, 0, 1, TextureUsageBits::Sampled);
-                driver->BindConstantBuffer(0, sizeof(glm::vec4), ShaderStageBits::Compute, &pc);
+                driver->BindConstantBuffer(0, sizeof(BloomPrefilterConstant), ShaderStageBits::Compute, &pc);
 
                 uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
                 uint32_t groupCountY = dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
                 driver->Dispatch(groupCountX, groupCountY, 1);
             });
         // downsample
-
-        for (uint32_t i = 0; i < m_BloomDownsampleCount; i++)
+        auto dimension = m_Engine->GetWindowDimension();
+        if (m_Downsampler.IsSupported() && SinglePassDownsampler::Fits(dimension.first, dimension.second))
         {
-            struct DownSampleData
+            struct DownsampleData
             {
                 FrameGraphResourceHandle<FrameGraphTexture> input;
                 FrameGraphResourceHandle<FrameGraphTexture> output;
             };
 
-            auto downsamplePass = fg.AddPass<DownSampleData>(
-                "downsample " + std::to_string(i),
-                [i = i](FrameGraph* fg, PassNode* node, DownSampleData* data) {
+            // the whole chain in one dispatch, karis average on the first reduction against fireflies
+            fg.AddPass<DownsampleData>(
+                "bloom downsample",
+                [count = m_BloomDownsampleCount](FrameGraph* fg, PassNode* node, DownsampleData* data) {
                     auto& blackboard      = fg->GetBlackboard();
                     auto  downsampleImage = blackboard.Get("bloomDownsample");
 
-                    if (i == 0)
-                    {
-                        data->input = blackboard.Get("bloomPrefilterResult");
-                    }
-                    else
-                    {
-                        data->input = blackboard.Get("bloomDownsampleResult" + std::to_string(i));
-                    }
+                    data->input = blackboard.Get("bloomPrefilterResult");
 
                     FrameGraphTexture::SubresourceDescriptor desc {};
                     desc.baseLayer  = 0;
                     desc.layerCount = 1;
-                    desc.baseLevel  = i + 1;
-                    desc.levelCount = 1;
+                    desc.baseLevel  = 1;
+                    desc.levelCount = count;
                     data->output    = fg->CreateSubresource(downsampleImage, desc);
 
-                    auto name = "bloomDownsampleResult" + std::to_string(i + 1);
-
-                    blackboard.Set("bloomDownsampleResult" + std::to_string(i + 1), data->output);
+                    // upsample still reads the levels one by one
+                    desc.levelCount = 1;
+                    for (uint32_t i = 1; i <= count; i++)
+                    {
+                        desc.baseLevel = i;
+                        blackboard.Set("bloomDownsampleResult" + std::to_string(i),
+                                       fg->CreateSubresource(downsampleImage, desc));
+                    }
 
                     fg->Read(node, data->input, TextureUsageBits::Sampled);
                     fg->Write(node, data->output, TextureUsageBits::Storage);
                 },
-                [i, self = this, engine = m_Engine, driver = m_Driver](
-                    FrameGraph* fg, DownSampleData* data, PassRenderTarget) {
+                [count = m_BloomDownsampleCount, engine = m_Engine, downsampler = &m_Downsampler](
+                    FrameGraph* fg, DownsampleData* data, PassRenderTarget) {
                     auto dimension = engine->GetWindowDimension();
-                    driver->BindShaderSet(engine->GetShaderSet("bloomDownsample")->GetHandle());
+                    auto output    = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetRHITexture();
 
-                    auto input      = static_cast<VirtualResource*>(fg->GetResource(data->input))->GetRHITexture();
-                    auto inputRange = static_cast<VirtualResource*>(fg->GetResource(data->input))->GetViewRange();
+                    downsampler->Dispatch(output, dimension.first, dimension.second, count, true);
+                });
+        }
+        else
+        {
+            for (uint32_t i = 0; i < m_BloomDownsampleCount; i++)
+            {
+                struct DownSampleData
+                {
+                    FrameGraphResourceHandle<FrameGraphTexture> input;
+                    FrameGraphResourceHandle<FrameGraphTexture> output;
+                };
 
-                    auto output      = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetRHITexture();
-                    auto outputRange = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetViewRange();
+                auto downsamplePass = fg.AddPass<DownSampleData>(
+                    "downsample " + std::to_string(i),
+                    [i = i](FrameGraph* fg, PassNode* node, DownSampleData* data) {
+                        auto& blackboard      = fg->GetBlackboard();
+                        auto  downsampleImage = blackboard.Get("bloomDownsample");
 
-                    driver->BindTexture(output, outputRange, 0, 0, TextureUsageBits::Storage);
-                    driver->BindTexture(input, inputRange, 0, 1, TextureUsageBits::Sampled, SamplerWrap::ClampToEdge);
+                        if (i == 0)
+                        {
+                            data->input = blackboard.Get("bloomPrefilterResult");
+                        }
+                        else
+                        {
+                            data->input = blackboard.Get("bloomDownsampleResult" + std::to_string(i));
+                        }
 
-                    driver->BindConstantBuffer(0, 4, ShaderStageBits::Compute, (void*)&i);
+                        FrameGraphTexture::SubresourceDescriptor desc {};
+                        desc.baseLayer  = 0;
+                        desc.layerCount = 1;
+                        desc.baseLevel  = i + 1;
+                        desc.levelCount = 1;
+                        data->output    = fg->CreateSubresource(downsampleImage, desc);
 
-                    uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
-                    uint32_t groupCountY =
-                        dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
+                        auto name = "bloomDownsampleResult" + std::to_string(i + 1);
 
-                    auto x = groupCountX / pow(2, i + 1);
-                    auto y = groupCountY / pow(2, i + 1);
-                    driver->Dispatch(ceil(x), ceil(y), 1);
-                });
+                        blackboard.Set("bloomDownsampleResult" + std::to_string(i + 1), data->output);
+
+                        fg->Read(node, data->input, TextureUsageBits::Sampled);
+                        fg->Write(node, data->output, TextureUsageBits::Storage);
+                    },
+                    [i, self = this, engine = m_Engine, driver = m_Driver](
+                        FrameGraph* fg, DownSampleData* data, PassRenderTarget) {
+                        auto dimension = engine->GetWindowDimension();
+                        driver->BindShaderSet(engine->GetShaderSet("bloomDownsample")->GetHandle());
+
+                        auto input      = static_cast<VirtualResource*>(fg->GetResource(data->input))->GetRHITexture();
+                        auto inputRange = static_cast<VirtualResource*>(fg->GetResource(data->input))->GetViewRange();
+
+                        auto output      = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetRHITexture();
+                        auto outputRange = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetViewRange();
+
+                        driver->BindTexture(output, outputRange, 0, 0, TextureUsageBits::Storage);
+                        driver->BindTexture(input, inputRange, 0, 1, TextureUsageBits::Sampled, SamplerWrap::ClampToEdge);
+
+                        driver->BindConstantBuffer(0, 4, ShaderStageBits::Compute, (void*)&i);
+
+                        uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
+                        uint32_t groupCountY =
+                            dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
+
+                        auto x = groupCountX / pow(2, i + 1);
+                        auto y = groupCountY / pow(2, i + 1);
+                        driver->Dispatch(ceil(x), ceil(y), 1);
+                    });
+            }
         }
         //// upsample
         for (uint32_t i = 0; i < m_BloomDownsampleCount; i++)
@@ -973,109 +1946,73 @@ namespace Zephyr
                     driver->Dispatch(ceil(x), ceil(y), 1);
                 });
         }
-        //// final composite
-
-        struct FinalCompositeData
-        {
-            FrameGraphResourceHandle<FrameGraphTexture> upsampleResult;
-            FrameGraphResourceHandle<FrameGraphTexture> original;
-            FrameGraphResourceHandle<FrameGraphTexture> output;
-        };
-
-        auto compositePass = fg.AddPass<FinalCompositeData>(
-            "bloom composite",
-            [engine = m_Engine](FrameGraph* fg, PassNode* node, FinalCompositeData* data) {
-                std::pair<uint32_t, uint32_t> windowDimension = engine->GetWindowDimension();
-                auto&                         blackboard      = fg->GetBlackboard();
-
-                data->upsampleResult = blackboard.Get("bloomUpsampleResult0");
-                data->original       = blackboard.Get("colorOutput");
-
-                TextureDescription desc {};
-                desc.width     = windowDimension.first;
-                desc.height    = windowDimension.second;
-                desc.depth     = 1;
-                desc.levels    = 1;
-                desc.format    = TextureFormat::RGBA16_SFLOAT;
-                desc.pipelines = PipelineTypeBits::Compute | PipelineTypeBits::Graphics;
-                desc.sampler   = SamplerType::Sampler2D;
-                desc.usage     = TextureUsageBits::Storage | TextureUsageBits::Sampled;
-                desc.samples   = 1;
-
-                data->output = blackboard.Get("bloomComposite");
-                // data->output = fg->CreateTexture(desc);
-
-                fg->Read(node, data->upsampleResult, TextureUsageBits::Sampled);
-                fg->Read(node, data->original, TextureUsageBits::Sampled);
-
-                fg->Write(node, data->output, TextureUsageBits::Storage);
-            },
-            [engine = m_Engine, driver = m_Driver](FrameGraph* fg, FinalCompositeData* data, PassRenderTarget) {
-                auto dimension = engine->GetWindowDimension();
-                driver->BindShaderSet(engine->GetShaderSet("bloomComposite")->GetHandle());
-
-                auto input0 = static_cast<VirtualResource*>(fg->GetResource(data->upsampleResult))->GetRHITexture();
-                auto inputRange0 = static_cast<VirtualResource*>(fg->GetResource(data->upsampleResult))->GetViewRange();
-
-                auto input1      = static_cast<VirtualResource*>(fg->GetResource(data->original))->GetRHITexture();
-                auto inputRange1 = static_cast<VirtualResource*>(fg->GetResource(data->original))->GetViewRange();
-
-                auto output      = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetRHITexture();
-                auto outputRange = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetViewRange();
-
-                driver->BindTexture(output, outputRange, 0, 0, TextureUsageBits::Storage);
-                driver->BindTexture(input0, inputRange0, 0, 1, TextureUsageBits::Sampled);
-                driver->BindTexture(input1, inputRange1, 0, 2, TextureUsageBits::Sampled);
-
-                uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
-                uint32_t groupCountY = dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
-
-                driver->Dispatch(groupCountX, groupCountY, 1);
-            });
     }
-    void Renderer::DispatchFXAACompute(FrameGraph& fg)
+
+    void Renderer::DispatchPostComposite(FrameGraph& fg)
     {
-        struct FXAAData
+        struct PostCompositeData
         {
-            FrameGraphResourceHandle<FrameGraphTexture> input;
+            FrameGraphResourceHandle<FrameGraphTexture> bloom;
+            FrameGraphResourceHandle<FrameGraphTexture> hdrColor;
             FrameGraphResourceHandle<FrameGraphTexture> output;
         };
 
-        auto fxaa = fg.AddPass<FXAAData>(
-            "fxaa",
-            [engine = m_Engine](FrameGraph* fg, PassNode* node, FXAAData* data) {
-                auto dimension = engine->GetWindowDimension();
+        // bloom composite, grading and tonemapping share one read of the hdr color
+        fg.AddPass<PostCompositeData>(
+            "post composite",
+            [engine = m_Engine, bloom = m_PostProcess.bloom](FrameGraph* fg, PassNode* node, PostCompositeData* data) {
+                auto  dimension  = engine->GetWindowDimension();
+                auto& blackboard = fg->GetBlackboard();
 
                 TextureDescription desc {};
                 desc.width     = dimension.first;
                 desc.height    = dimension.second;
                 desc.depth     = 1;
                 desc.levels    = 1;
-                desc.format    = TextureFormat::RGBA16_UNORM;
-                desc.usage     = TextureUsageBits::Storage | TextureUsageBits::Sampled;
+                // DON'T USE RGBA8 HERE EVEN IF THE OUTPUT IS TONEMAPPED AND GAMMA ENCODED
+                // DITHERING ONLY HAPPENS IN RESOLVE, RGBA8 WOULD BAND BEFORE IT
+                desc.format    = TextureFormat::RGBA16_SFLOAT;
+                desc.pipelines = PipelineTypeBits::Compute | PipelineTypeBits::Graphics;
                 desc.sampler   = SamplerType::Sampler2D;
+                desc.usage     = TextureUsageBits::Storage | TextureUsageBits::Sampled;
                 desc.samples   = 1;
-                desc.pipelines = PipelineTypeBits::Compute | PipelineTypeBits::Graphics;
 
-                data->output = fg->CreateTexture(desc);
-                data->input  = fg->GetBlackboard().Get("bloomComposite");
+                data->hdrColor = blackboard.Get("colorOutput");
+                data->output   = fg->CreateTexture(desc);
 
+                fg->Read(node, data->hdrColor, TextureUsageBits::Sampled);
+                if (bloom)
+                {
+                    data->bloom = blackboard.Get("bloomUpsampleResult0");
+                    fg->Read(node, data->bloom, TextureUsageBits::Sampled);
+                }
                 fg->Write(node, data->output, TextureUsageBits::Storage);
-                fg->Read(node, data->input, TextureUsageBits::Sampled);
 
-                fg->GetBlackboard().Set("fxaa", data->output);
+                blackboard.Set("postComposite", data->output);
             },
-            [engine = m_Engine, driver = m_Driver, self = this](FrameGraph* fg, FXAAData* data, PassRenderTarget) {
+            [engine   = m_Engine,
+             driver   = m_Driver,
+             settings = m_PostProcess,
+             grading  = m_ColorGrading,
+             viewport = GetRenderViewport()](FrameGraph* fg, PostCompositeData* data, PassRenderTarget) {
                 auto dimension = engine->GetWindowDimension();
 
-                driver->BindShaderSet(engine->GetShaderSet("fxaa")->GetHandle());
+                std::vector<uint32_t> specialization = {settings.bloom, settings.colorGrading, settings.tonemap};
+                driver->BindShaderSet(engine->GetShaderSet("postComposite", specialization)->GetHandle());
 
-                auto output = static_cast<VirtualResource*>(fg->GetResource(data->output))->GetRHITexture();
-                auto input  = static_cast<VirtualResource*>(fg->GetResource(data->input))->GetRHITexture();
+                auto hdrColor = static_cast<VirtualResource*>(fg->GetResource(data->hdrColor));
+                auto output   = static_cast<VirtualResource*>(fg->GetResource(data->output));
+                // without bloom the binding still needs a valid view, the shader never reads it
+                auto bloom = settings.bloom ? static_cast<VirtualResource*>(fg->GetResource(data->bloom)) : hdrColor;
 
-                driver->BindTexture(output, 0, 0, TextureUsageBits::Storage);
-                driver->BindTexture(input, 0, 1, TextureUsageBits::Sampled);
-                driver->BindConstantBuffer(0, sizeof(FXAAConstant), ShaderStageBits::Compute, &self->m_FXAAConstant);
+                driver->BindTexture(output->GetRHITexture(), output->GetViewRange(), 0, 0, TextureUsageBits::Storage);
+                driver->BindTexture(bloom->GetRHITexture(), bloom->GetViewRange(), 0, 1, TextureUsageBits::Sampled);
+                driver->BindTexture(
+                    hdrColor->GetRHITexture(), hdrColor->GetViewRange(), 0, 2, TextureUsageBits::Sampled);
+
+                // the hdr color is upscaled to output resolution here
+                PostCompositeConstant pc {grading, viewport};
+                driver->BindConstantBuffer(0, sizeof(PostCompositeConstant), ShaderStageBits::Compute, &pc);
 
                 uint32_t groupCountX = dimension.first % 16 == 0 ? dimension.first / 16 : dimension.first / 16 + 1;
                 uint32_t groupCountY = dimension.second % 16 == 0 ? dimension.second / 16 : dimension.second / 16 + 1;
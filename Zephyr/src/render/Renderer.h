@@ -2,15 +2,41 @@
 #include "RenderResourceManager.h"
 #include "pch.h"
 #include "render/Camera.h"
+#include "render/DynamicResolution.h"
+#include "core/math/AABB.h"
 #include "render/Light.h"
+#include "render/SinglePassDownsampler.h"
+#include "rhi/RHIBuffer.h"
 
 namespace Zephyr
 {
-    inline constexpr uint32_t MAX_POINT_LIGHT_COUNT = 1000;
+    // view space light clusters: screen tiles x exponential depth slices, must match the shaders
+    inline constexpr uint32_t CLUSTER_GRID_X         = 16;
+    inline constexpr uint32_t CLUSTER_GRID_Y         = 9;
+    inline constexpr uint32_t CLUSTER_GRID_Z         = 24;
+    inline constexpr uint32_t CLUSTER_COUNT          = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+    // the culling shader keeps the first lights it finds per cluster and drops the rest
+    inline constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+    // initial point light buffer capacity, grows on demand
+    inline constexpr uint32_t POINT_LIGHT_INITIAL_CAPACITY = 1024;
+    // initial occlusion culling buffer capacity in render units, grows on demand
+    inline constexpr uint32_t OCCLUSION_CULL_INITIAL_CAPACITY = 1024;
+    // estimated overdraw at which the automatic depth pre-pass turns on, and below which it turns off again
+    inline constexpr float DEPTH_PREPASS_ENABLE_OVERDRAW  = 2.5f;
+    inline constexpr float DEPTH_PREPASS_DISABLE_OVERDRAW = 1.8f;
+    // render unit visibility bits, bit i is shadow cascade i
+    inline constexpr uint8_t UNIT_VISIBLE_CASCADES = 0xF;
+    inline constexpr uint8_t UNIT_VISIBLE_CAMERA   = 1 << 4;
+    inline constexpr uint8_t UNIT_VISIBLE_ALL      = UNIT_VISIBLE_CASCADES | UNIT_VISIBLE_CAMERA;
+    // render scales of the last frames, gpu timings arrive at most this many frames late
+    inline constexpr uint32_t RENDER_SCALE_HISTORY = 2 * MAX_CONCURRENT_FRAME + 2;
+
     class Engine;
     class Driver;
     class Mesh;
+    class DynamicBVH;
     class Buffer;
+    class Texture;
     class MaterialInstance;
     class FrameGraph;
 
@@ -20,24 +46,72 @@ namespace Zephyr
         std::vector<glm::mat4>  transforms;
         DirectionalLight        light;
         Camera                  camera;
+        // a cluster shades at most MAX_LIGHTS_PER_CLUSTER of the lights in view, see GetClusterOverflowFrames
         std::vector<PointLight> pointLights;
+        // world bounds with meshes / pointLights indices as user data, without them nothing is culled on the cpu
+        const DynamicBVH* meshBounds       = nullptr;
+        const DynamicBVH* pointLightBounds = nullptr;
     };
 
+    // all units share the global geometry pool buffers, offsets are global
     struct SceneRenderUnit
     {
-        Handle<RHIBuffer> vertex;
-        Handle<RHIBuffer> index;
         uint32_t          vertexOffset;
         uint32_t          indexOffset;
         uint32_t          indexCount;
         glm::mat4         transform;
         MaterialInstance* material;
+        // local space bounds of the submesh
+        AABB bounds;
+    };
+
+    // the persistent shadow map keeps a cascade until its light matrix or a caster inside it changes
+    struct ShadowCascadeCache
+    {
+        glm::mat4 lightVP = glm::mat4(0.f);
+        bool      dirty   = true;
+    };
+
+    // caster state of the previous frame, used to find casters that moved
+    struct ShadowCasterState
+    {
+        uint32_t  indexOffset;
+        glm::mat4 transform;
+        AABB      worldBounds;
+    };
+
+    // world space bounds and draw arguments of a render unit, must match occlusionCull.comp
+    struct OcclusionCullUnit
+    {
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+        uint32_t  indexCount;
+        uint32_t  firstIndex;
+        int32_t   vertexOffset;
+        uint32_t  _padding;
+    };
+
+    struct OcclusionCullConstant
+    {
+        glm::mat4 hiZViewProjection;
+        uint32_t  unitCount;
+        uint32_t  phase;
+        uint32_t  hiZValid;
+        uint32_t  hiZLevels;
+    };
+
+    // two phase occlusion culling, early draws what was visible last frame, late draws what got disoccluded
+    enum class OcclusionCullPhase : uint32_t
+    {
+        Early = 0,
+        Late  = 1,
     };
 
-    struct PointLightShaderData
+    // header of the point light storage buffer, the light array follows at a 16 byte offset (std430)
+    struct PointLightShaderHeader
     {
-        PointLight pointLights[MAX_POINT_LIGHT_COUNT];
-        uint32_t   activePointLight;
+        uint32_t activePointLight;
+        uint32_t _padding[3];
     };
 
     struct GlobalRenderShaderData
@@ -57,6 +131,29 @@ namespace Zephyr
         glm::mat4 lightVPCascade3;
         glm::vec2 cascadeSplits[4];
         glm::vec4 cascadeSphereInfo[4];
+        glm::mat4 inverseProjection;
+        glm::vec4 clusterInfo; // x: zNear y: zFar z: width w: height
+        glm::mat4 inverseViewProjection;
+    };
+
+    // how the shadow cascades are filled, picked from the driver capabilities
+    enum class ShadowRenderMode
+    {
+        // one pass and one full draw list replay per cascade
+        PerCascade,
+        // one pass, every draw instanced per cascade and routed with gl_Layer
+        Layered,
+        // one pass, every draw broadcast to all cascades with a view mask
+        Multiview,
+    };
+
+    // depth-only pass ahead of the g-buffer pass, which then shades each pixel once with an EQUAL depth test
+    enum class DepthPrepassMode
+    {
+        Off,
+        On,
+        // follow the overdraw estimate of the scene
+        Auto,
     };
 
     struct FXAAConstant
@@ -66,6 +163,35 @@ namespace Zephyr
         float sharpness         = .1;
     };
 
+    // the color grading part of the postComposite.comp.glsl push constant
+    struct ColorGradingConstant
+    {
+        glm::vec4 colorFilter = glm::vec4(1.f);
+        // in stops
+        float exposure   = 0.f;
+        float contrast   = 1.f;
+        float saturation = 1.f;
+        float _padding   = 0.f;
+    };
+
+    // matches the push constant of postComposite.comp.glsl
+    struct PostCompositeConstant
+    {
+        ColorGradingConstant grading;
+        // xy: uv scale of the rendered region zw: uv clamp
+        glm::vec4 viewport;
+    };
+
+    // every switch is a specialization constant of the fused post passes, changing one compiles a new variant
+    struct PostProcessSettings
+    {
+        bool bloom        = true;
+        bool colorGrading = true;
+        bool tonemap      = true;
+        bool fxaa         = true;
+        bool dither       = true;
+    };
+
     class Renderer
     {
     public:
@@ -75,38 +201,118 @@ namespace Zephyr
 
         void Render(const SceneRenderData& scene);
 
+        // take effect from the next rendered frame
+        inline void SetPostProcessSettings(const PostProcessSettings& settings) { m_PostProcess = settings; }
+        inline void SetColorGrading(const ColorGradingConstant& grading) { m_ColorGrading = grading; }
+
+        inline const PostProcessSettings&  GetPostProcessSettings() const { return m_PostProcess; }
+        inline const ColorGradingConstant& GetColorGrading() const { return m_ColorGrading; }
+
+        // frames with more point lights in view than a cluster holds, a cluster reached by more of them dropped some
+        inline uint64_t GetClusterOverflowFrames() const { return m_ClusterOverflowFrames; }
+
     private:
         void PrepareScene();
+        void CullScene();
         void SetupGlobalRenderData();
         void SetupPointLightData();
+        void ReservePointLightBuffers(uint32_t count);
         void PrepareCascadedShadowData();
+        void UpdateShadowCascadeCache(const glm::mat4* cascadeVP);
+        void InvalidateShadowCascades(const AABB& worldBounds);
+        void SetupOcclusionCullData();
+        void ReserveOcclusionCullBuffers(uint32_t count);
+        void UpdateDepthPrepass();
+        float EstimateOverdraw();
+        TextureDescription GetSceneDepthDescription();
+        std::pair<uint32_t, uint32_t> GetRenderDimension();
+        glm::vec4                     GetRenderViewport();
 
         void DrawShadowMap(FrameGraph& fg);
+        void DrawShadowMapSinglePass(FrameGraph& fg, FrameGraphResourceHandle<FrameGraphTexture> shadow);
         void DrawForward(FrameGraph& fg);
         void DrawDeferred(FrameGraph& fg);
+        void DrawDepthPrepass(FrameGraph& fg, OcclusionCullPhase phase);
+        void DrawGeometry(FrameGraph& fg, OcclusionCullPhase phase);
+        void DispatchOcclusionCulling(FrameGraph& fg, OcclusionCullPhase phase);
+        void BuildHiZ(FrameGraph& fg);
+        void DispatchLightCulling(FrameGraph& fg);
+        void GeneratePendingMips(FrameGraph& fg);
         void DrawResolve(FrameGraph& fg);
-        void DispatchPostProcessingCompute(FrameGraph& fg);
         void DispatchBloomCompute(FrameGraph& fg);
-        void DispatchFXAACompute(FrameGraph& fg);
+        void DispatchPostComposite(FrameGraph& fg);
 
     private:
-        Engine*         m_Engine;
-        Driver*         m_Driver;
-        SceneRenderData m_Scene;
+        Engine*                m_Engine;
+        Driver*                m_Driver;
+        // owned by the caller of Render, only valid during it
+        const SceneRenderData* m_Scene = nullptr;
 
         std::vector<SceneRenderUnit> m_SceneRenderUnit;
+        // units of mesh i are [m_MeshUnits[i], m_MeshUnits[i + 1])
+        std::vector<uint32_t> m_MeshUnits;
+        // UNIT_VISIBLE_* bits of every unit, from the mesh bounds of the scene
+        std::vector<uint8_t>  m_UnitVisibility;
 
         Buffer*                m_GlobalRingBuffer = nullptr;
         GlobalRenderShaderData m_GlobalShaderData = {};
-        Buffer*                m_PointLightBuffer = nullptr;
-        PointLightShaderData   m_PointLightData   = {};
+
+        // host visible, one per frame in flight so the cpu never writes lights the gpu is still reading
+        Handle<RHIBuffer> m_PointLightBuffers[MAX_CONCURRENT_FRAME];
+        uint32_t          m_PointLightCapacity = 0;
+        // lights in the camera frustum, when the scene has light bounds
+        std::vector<PointLight> m_VisiblePointLights;
+        uint64_t                m_ClusterOverflowFrames = 0;
+
+        // gpu only, written by the culling pass and read by the lighting pass in the same frame
+        Handle<RHIBuffer> m_ClusterLightGridBuffer;
+        Handle<RHIBuffer> m_ClusterLightIndexBuffer;
 
         RenderResourceManager m_Manager;
 
         float    m_CascadeTransitionScale = .3;
         uint32_t m_ShadowMapResolution    = 2048;
+
+        ShadowRenderMode m_ShadowRenderMode = ShadowRenderMode::PerCascade;
+
+        // shadow map lives across frames, only dirty cascades are redrawn
+        bool                           m_CacheShadowCascades = true;
+        Handle<RHITexture>             m_ShadowMap;
+        TextureDescription             m_ShadowMapDescription {};
+        ShadowCascadeCache             m_ShadowCascadeCache[4];
+        std::vector<ShadowCasterState> m_ShadowCasters;
+
+        // geometry is culled on the gpu against a hi-z pyramid kept from the previous frame
+        bool               m_OcclusionCulling = true;
+        Handle<RHIBuffer>  m_OcclusionUnitBuffers[MAX_CONCURRENT_FRAME];
+        Handle<RHIBuffer>  m_EarlyDrawBuffer;
+        Handle<RHIBuffer>  m_LateDrawBuffer;
+        uint32_t           m_OcclusionCapacity = 0;
+        Handle<RHITexture> m_HiZ;
+        TextureDescription m_HiZDescription {};
+        // the hi-z is only usable after it was built once at the current size
+        bool      m_HiZValid          = false;
+        glm::mat4 m_HiZViewProjection = glm::mat4(1.f);
+
+        DepthPrepassMode m_DepthPrepassMode  = DepthPrepassMode::Auto;
+        bool             m_DepthPrepass      = false;
+        float            m_EstimatedOverdraw = 0.f;
+
         uint32_t m_BloomDownsampleCount   = 7;
 
+        // bloom downsample chain and runtime texture mips in one dispatch each
+        SinglePassDownsampler m_Downsampler;
+        std::vector<Texture*> m_PendingMipTextures;
+
+        PostProcessSettings  m_PostProcess {};
+        ColorGradingConstant m_ColorGrading {};
+
+        // render targets keep the window size, only the viewport shrinks
+        DynamicResolution m_DynamicResolution;
+        float             m_RenderScale = 1.f;
+        // the scale every recent frame was rendered at, by frame index
+        float    m_FrameScales[RENDER_SCALE_HISTORY] {};
+        uint64_t m_MeasuredFrame = ~0ull;
         // the smaller the threshold is, the more we do fxaa->better result, slower performance
         FXAAConstant m_FXAAConstant {};
     };
@@ -0,0 +1,97 @@
+#include "SinglePassDownsampler.h"
+#include "engine/Engine.h"
+#include "rhi/Driver.h"
+#include "rhi/RHIEnums.h"
+
+namespace Zephyr
+{
+    SinglePassDownsampler::SinglePassDownsampler(Engine* engine, Driver* driver) : m_Engine(engine), m_Driver(driver)
+    {
+        ReserveSlots(SPD_INITIAL_SLOT_CAPACITY);
+    }
+
+    void SinglePassDownsampler::Shutdown() { m_Driver->DestroyBuffer(m_ScratchBuffer); }
+
+    void SinglePassDownsampler::BeginFrame(uint32_t dispatchCount)
+    {
+        ReserveSlots(dispatchCount);
+        m_NextSlot = 0;
+    }
+
+    void SinglePassDownsampler::ReserveSlots(uint32_t count)
+    {
+        if (count <= m_SlotCapacity)
+        {
+            return;
+        }
+
+        uint32_t capacity = std::max(m_SlotCapacity, SPD_INITIAL_SLOT_CAPACITY);
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+
+        if (m_SlotCapacity != 0)
+        {
+            m_Driver->WaitIdle();
+            m_Driver->DestroyBuffer(m_ScratchBuffer);
+        }
+
+        BufferDescription desc {};
+        desc.memoryType   = BufferMemoryType::Static;
+        desc.size         = capacity * sizeof(SpdSlot);
+        desc.pipelines    = PipelineTypeBits::Compute;
+        desc.shaderStages = ShaderStageBits::Compute;
+        desc.usage        = BufferUsageBits::Storage;
+
+        m_ScratchBuffer = m_Driver->CreateBuffer(desc);
+
+        // the counters start at zero, after that the last group of every dispatch puts its counter back
+        std::vector<uint8_t>   zero(desc.size, 0);
+        BufferUpdateDescriptor update {};
+        update.srcOffset = 0;
+        update.dstOffset = 0;
+        update.data      = zero.data();
+        update.size      = desc.size;
+        m_Driver->UpdateBuffer(update, m_ScratchBuffer);
+
+        m_SlotCapacity = capacity;
+    }
+
+    void SinglePassDownsampler::Dispatch(Handle<RHITexture> texture,
+                                         uint32_t           width,
+                                         uint32_t           height,
+                                         uint32_t           mipCount,
+                                         bool               karisAverage)
+    {
+        assert(m_NextSlot < m_SlotCapacity);
+        assert(mipCount > 0 && mipCount <= SPD_MAX_MIP_COUNT);
+        assert(Fits(width, height));
+
+        SpdConstant pc {};
+        pc.mipCount     = mipCount;
+        pc.slot         = m_NextSlot++;
+        pc.karisAverage = karisAverage ? 1 : 0;
+
+        m_Driver->BindShaderSet(m_Engine->GetShaderSet("spd")->GetHandle());
+        m_Driver->BindTexture(texture, {0, 1, 0, 1}, 0, 0, TextureUsageBits::Sampled, SamplerWrap::ClampToEdge);
+        // every binding needs a valid view, the ones past the end of the chain repeat the last mip and stay unwritten
+        for (uint32_t i = 1; i <= SPD_MAX_MIP_COUNT; i++)
+        {
+            m_Driver->BindTexture(texture, {0, 1, std::min(i, mipCount), 1}, 0, i, TextureUsageBits::Storage);
+        }
+        m_Driver->BindBuffer(m_ScratchBuffer, 0, SPD_MAX_MIP_COUNT + 1, BufferUsageBits::Storage);
+        m_Driver->BindConstantBuffer(0, sizeof(SpdConstant), ShaderStageBits::Compute, &pc);
+
+        uint32_t groupCountX = width % SPD_TILE_SIZE == 0 ? width / SPD_TILE_SIZE : width / SPD_TILE_SIZE + 1;
+        uint32_t groupCountY = height % SPD_TILE_SIZE == 0 ? height / SPD_TILE_SIZE : height / SPD_TILE_SIZE + 1;
+        m_Driver->Dispatch(groupCountX, groupCountY, 1);
+    }
+
+    bool SinglePassDownsampler::IsSupported() const { return m_Driver->GetCapabilities().storageWriteWithoutFormat; }
+
+    bool SinglePassDownsampler::Fits(uint32_t width, uint32_t height)
+    {
+        return width <= SPD_MAX_SIZE && height <= SPD_MAX_SIZE;
+    }
+} // namespace Zephyr
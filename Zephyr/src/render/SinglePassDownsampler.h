@@ -0,0 +1,68 @@
+#pragma once
+#include "pch.h"
+#include "rhi/Handle.h"
+#include "rhi/RHIBuffer.h"
+#include "rhi/RHITexture.h"
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    class Driver;
+    class Engine;
+
+    // must match the constants in spd.comp.glsl
+    inline constexpr uint32_t SPD_TILE_SIZE     = 64;
+    inline constexpr uint32_t SPD_MAX_MIP_COUNT = 12;
+    inline constexpr uint32_t SPD_MAX_SIZE      = SPD_TILE_SIZE << 6;
+    inline constexpr uint32_t SPD_MAX_GROUPS    = (SPD_MAX_SIZE / SPD_TILE_SIZE) * (SPD_MAX_SIZE / SPD_TILE_SIZE);
+
+    inline constexpr uint32_t SPD_INITIAL_SLOT_CAPACITY = 4;
+
+    struct SpdConstant
+    {
+        uint32_t mipCount;
+        uint32_t slot;
+        uint32_t karisAverage;
+        uint32_t _padding;
+    };
+
+    struct SpdSlot
+    {
+        uint32_t  counter;
+        uint32_t  _padding[3];
+        glm::vec4 texels[SPD_MAX_GROUPS];
+    };
+
+    /*
+        generates a whole mip chain of a 2d texture with one compute dispatch.
+        every workgroup reduces a 64x64 tile down to mip 6 in shared memory and publishes the result to a scratch
+        slot, the last group to bump the slot's atomic counter reduces those results down to the tail mips.
+        mip 0 has to be readable and mips 1..mipCount writable when Dispatch is recorded.
+    */
+    class SinglePassDownsampler final
+    {
+    public:
+        SinglePassDownsampler(Engine* engine, Driver* driver);
+        ~SinglePassDownsampler() = default;
+        void Shutdown();
+
+        // every dispatch recorded in a frame owns one scratch slot
+        void BeginFrame(uint32_t dispatchCount);
+
+        void Dispatch(Handle<RHITexture> texture, uint32_t width, uint32_t height, uint32_t mipCount, bool karisAverage);
+
+        bool        IsSupported() const;
+        static bool Fits(uint32_t width, uint32_t height);
+
+    private:
+        void ReserveSlots(uint32_t count);
+
+    private:
+        Engine* m_Engine;
+        Driver* m_Driver;
+
+        Handle<RHIBuffer> m_ScratchBuffer;
+        uint32_t          m_SlotCapacity = 0;
+        uint32_t          m_NextSlot     = 0;
+    };
+} // namespace Zephyr
@@ -0,0 +1,172 @@
+#include "GeometryPool.h"
+#include "Mesh.h"
+#include "rhi/Driver.h"
+
+namespace Zephyr
+{
+    GeometryFreeList::GeometryFreeList(uint32_t capacity) : m_Capacity(capacity) { m_FreeBlocks.insert({0, capacity}); }
+
+    GeometryAllocation GeometryFreeList::Allocate(uint32_t count)
+    {
+        if (count == 0)
+        {
+            return {};
+        }
+
+        for (auto iter = m_FreeBlocks.begin(); iter != m_FreeBlocks.end(); iter++)
+        {
+            if (iter->second < count)
+            {
+                continue;
+            }
+
+            GeometryAllocation allocation {iter->first, count};
+
+            // shrink the block from the front, drop it if fully consumed
+            uint32_t remainOffset = iter->first + count;
+            uint32_t remainCount  = iter->second - count;
+            m_FreeBlocks.erase(iter);
+            if (remainCount > 0)
+            {
+                m_FreeBlocks.insert({remainOffset, remainCount});
+            }
+
+            m_Used += count;
+            return allocation;
+        }
+
+        return {};
+    }
+
+    void GeometryFreeList::Free(const GeometryAllocation& allocation)
+    {
+        if (!allocation.IsValid())
+        {
+            return;
+        }
+        assert(allocation.offset + allocation.count <= m_Capacity);
+
+        uint32_t offset = allocation.offset;
+        uint32_t count  = allocation.count;
+
+        // merge with the next block
+        auto next = m_FreeBlocks.lower_bound(offset);
+        assert(next == m_FreeBlocks.end() || next->first >= offset + count);
+        if (next != m_FreeBlocks.end() && next->first == offset + count)
+        {
+            count += next->second;
+            next = m_FreeBlocks.erase(next);
+        }
+
+        // merge with the previous block
+        if (next != m_FreeBlocks.begin())
+        {
+            auto prev = std::prev(next);
+            assert(prev->first + prev->second <= offset);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += count;
+                m_Used -= allocation.count;
+                return;
+            }
+        }
+
+        m_FreeBlocks.insert({offset, count});
+        m_Used -= allocation.count;
+    }
+
+    GeometryPool::GeometryPool(Driver* driver, uint32_t vertexCapacity, uint32_t indexCapacity) :
+        m_Driver(driver), m_VertexFreeList(vertexCapacity), m_IndexFreeList(indexCapacity)
+    {
+        BufferDescription desc {};
+        desc.size         = vertexCapacity * sizeof(Vertex);
+        desc.usage        = BufferUsageBits::Vertex;
+        desc.memoryType   = BufferMemoryType::Static;
+        desc.pipelines    = PipelineTypeBits::Graphics;
+        desc.shaderStages = ShaderStageBits::Vertex;
+
+        m_VertexBuffer = driver->CreateBuffer(desc);
+
+        desc.size = vertexCapacity * sizeof(glm::vec3);
+
+        m_PositionBuffer = driver->CreateBuffer(desc);
+
+        desc.size  = indexCapacity * sizeof(uint32_t);
+        desc.usage = BufferUsageBits::Index;
+
+        m_IndexBuffer = driver->CreateBuffer(desc);
+    }
+
+    void GeometryPool::Shutdown()
+    {
+        m_Driver->DestroyBuffer(m_VertexBuffer);
+        m_Driver->DestroyBuffer(m_PositionBuffer);
+        m_Driver->DestroyBuffer(m_IndexBuffer);
+    }
+
+    GeometryAllocation GeometryPool::AllocateVertices(uint32_t count)
+    {
+        auto allocation = m_VertexFreeList.Allocate(count);
+        if (!allocation.IsValid())
+        {
+            printf("Geometry pool out of vertex space: requested %u, used %u/%u\n",
+                   count,
+                   m_VertexFreeList.GetUsed(),
+                   m_VertexFreeList.GetCapacity());
+            assert(false);
+        }
+        return allocation;
+    }
+
+    GeometryAllocation GeometryPool::AllocateIndices(uint32_t count)
+    {
+        auto allocation = m_IndexFreeList.Allocate(count);
+        if (!allocation.IsValid())
+        {
+            printf("Geometry pool out of index space: requested %u, used %u/%u\n",
+                   count,
+                   m_IndexFreeList.GetUsed(),
+                   m_IndexFreeList.GetCapacity());
+            assert(false);
+        }
+        return allocation;
+    }
+
+    void GeometryPool::FreeVertices(const GeometryAllocation& allocation) { m_VertexFreeList.Free(allocation); }
+
+    void GeometryPool::FreeIndices(const GeometryAllocation& allocation) { m_IndexFreeList.Free(allocation); }
+
+    void GeometryPool::UploadVertices(const GeometryAllocation& allocation, const Vertex* vertices)
+    {
+        BufferUpdateDescriptor update {};
+        update.data      = (void*)vertices;
+        update.size      = allocation.count * sizeof(Vertex);
+        update.srcOffset = 0;
+        update.dstOffset = allocation.offset * sizeof(Vertex);
+
+        m_Driver->UpdateBuffer(update, m_VertexBuffer);
+
+        std::vector<glm::vec3> positions(allocation.count);
+        for (uint32_t i = 0; i < allocation.count; i++)
+        {
+            positions[i] = {vertices[i].px, vertices[i].py, vertices[i].pz};
+        }
+
+        update.data      = positions.data();
+        update.size      = allocation.count * sizeof(glm::vec3);
+        update.dstOffset = allocation.offset * sizeof(glm::vec3);
+
+        m_Driver->UpdateBuffer(update, m_PositionBuffer);
+    }
+
+    void GeometryPool::UploadIndices(const GeometryAllocation& allocation, const uint32_t* indices)
+    {
+        BufferUpdateDescriptor update {};
+        update.data      = (void*)indices;
+        update.size      = allocation.count * sizeof(uint32_t);
+        update.srcOffset = 0;
+        update.dstOffset = allocation.offset * sizeof(uint32_t);
+
+        m_Driver->UpdateBuffer(update, m_IndexBuffer);
+    }
+} // namespace Zephyr
@@ -0,0 +1,82 @@
+#pragma once
+#include "core/macro.h"
+#include "pch.h"
+#include "rhi/Handle.h"
+#include "rhi/RHIBuffer.h"
+
+namespace Zephyr
+{
+    class Driver;
+    struct Vertex;
+
+    inline constexpr uint32_t GEOMETRY_POOL_VERTEX_CAPACITY = 1 << 20;
+    inline constexpr uint32_t GEOMETRY_POOL_INDEX_CAPACITY  = 1 << 22;
+
+    // a contiguous range of elements(vertices or indices) inside one of the pool buffers
+    struct GeometryAllocation
+    {
+        uint32_t offset = 0;
+        uint32_t count  = 0;
+
+        inline bool IsValid() const { return count != 0; }
+    };
+
+    /*
+        first-fit free list over a range of elements. free blocks are keyed by offset so that
+        neighbouring blocks can be coalesced when a range is returned
+    */
+    class GeometryFreeList
+    {
+    public:
+        GeometryFreeList(uint32_t capacity);
+
+        GeometryAllocation Allocate(uint32_t count);
+        void               Free(const GeometryAllocation& allocation);
+
+        inline uint32_t GetCapacity() const { return m_Capacity; }
+        inline uint32_t GetUsed() const { return m_Used; }
+
+    private:
+        uint32_t                     m_Capacity;
+        uint32_t                     m_Used = 0;
+        std::map<uint32_t, uint32_t> m_FreeBlocks;
+    };
+
+    /*
+        global geometry storage. every mesh uploads its vertices and indices into one big vertex buffer
+        and one big index buffer, so the renderer can bind them once and draw everything with offsets.
+        positions are mirrored into a tightly packed stream that depth-only passes fetch instead of full vertices
+    */
+    class GeometryPool final
+    {
+    public:
+        GeometryPool(Driver* driver, uint32_t vertexCapacity, uint32_t indexCapacity);
+        ~GeometryPool() = default;
+        DISALE_COPY_AND_MOVE(GeometryPool);
+
+        void Shutdown();
+
+        // an invalid allocation when the pool has no room left
+        GeometryAllocation AllocateVertices(uint32_t count);
+        GeometryAllocation AllocateIndices(uint32_t count);
+        void               FreeVertices(const GeometryAllocation& allocation);
+        void               FreeIndices(const GeometryAllocation& allocation);
+
+        void UploadVertices(const GeometryAllocation& allocation, const Vertex* vertices);
+        void UploadIndices(const GeometryAllocation& allocation, const uint32_t* indices);
+
+        inline Handle<RHIBuffer> GetVertexBuffer() const { return m_VertexBuffer; }
+        inline Handle<RHIBuffer> GetPositionBuffer() const { return m_PositionBuffer; }
+        inline Handle<RHIBuffer> GetIndexBuffer() const { return m_IndexBuffer; }
+
+    private:
+        Driver* m_Driver;
+
+        GeometryFreeList m_VertexFreeList;
+        GeometryFreeList m_IndexFreeList;
+
+        Handle<RHIBuffer> m_VertexBuffer;
+        Handle<RHIBuffer> m_PositionBuffer;
+        Handle<RHIBuffer> m_IndexBuffer;
+    };
+} // namespace Zephyr
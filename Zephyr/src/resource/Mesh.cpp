@@ -1,5 +1,6 @@
 #include "Mesh.h"
-#include "rhi/Driver.h"
+#include "GeometryPool.h"
+#include <cstdlib>
 
 namespace Zephyr
 {
@@ -7,45 +8,41 @@ namespace Zephyr
 
     void Mesh::SetMaterials(const std::vector<MaterialInstance*>& materials) { m_Materials = materials; }
 
-    void Mesh::InitResource(Driver* driver)
+    void Mesh::InitResource(GeometryPool* pool)
     {
-        BufferDescription desc {};
-        desc.size         = m_Vertices.size() * sizeof(Vertex);
-        desc.usage        = BufferUsageBits::Vertex;
-        desc.memoryType   = BufferMemoryType::Static;
-        desc.pipelines    = PipelineTypeBits::Graphics;
-        desc.shaderStages = ShaderStageBits::Vertex;
-
-        auto vb = driver->CreateBuffer(desc);
-
-        desc.size  = m_Indices.size() * sizeof(uint32_t);
-        desc.usage = BufferUsageBits::Index;
-
-        auto ib = driver->CreateBuffer(desc);
-
-        // upload data into it
-        BufferUpdateDescriptor update {};
-        update.data      = (void*)m_Vertices.data();
-        update.size      = m_Vertices.size() * sizeof(Vertex);
-        update.srcOffset = 0;
-        update.dstOffset = 0;
-
-        driver->UpdateBuffer(update, vb);
-
-        update.data      = (void*)m_Indices.data();
-        update.size      = m_Indices.size() * sizeof(uint32_t);
-        update.srcOffset = 0;
-        update.dstOffset = 0;
-
-        driver->UpdateBuffer(update, ib);
-
-        m_VertexBuffer = vb;
-        m_IndexBuffer  = ib;
+        m_Pool = pool;
+
+        // suballocate from the global vertex/index buffers and upload data into it
+        m_VertexAllocation = pool->AllocateVertices(m_Vertices.size());
+        m_IndexAllocation  = pool->AllocateIndices(m_Indices.size());
+
+        // an invalid range would alias the start of the pool and draw another mesh's geometry, release builds
+        // have to stop here too
+        if ((!m_Vertices.empty() && !m_VertexAllocation.IsValid()) ||
+            (!m_Indices.empty() && !m_IndexAllocation.IsValid()))
+        {
+            printf("Mesh with %zu vertices and %zu indices doesn't fit into the geometry pool\n",
+                   m_Vertices.size(),
+                   m_Indices.size());
+            std::abort();
+        }
+
+        pool->UploadVertices(m_VertexAllocation, m_Vertices.data());
+        pool->UploadIndices(m_IndexAllocation, m_Indices.data());
+
+        for (auto& submesh : m_Submeshes)
+        {
+            submesh.globalVertexOffset = m_VertexAllocation.offset + submesh.baseVertex;
+            submesh.globalIndexOffset  = m_IndexAllocation.offset + submesh.baseIndex;
+        }
     }
 
-    void Mesh::Destroy(Driver* driver)
+    void Mesh::Destroy(GeometryPool* pool)
     {
-        driver->DestroyBuffer(m_VertexBuffer);
-        driver->DestroyBuffer(m_IndexBuffer);
+        pool->FreeVertices(m_VertexAllocation);
+        pool->FreeIndices(m_IndexAllocation);
+
+        m_VertexAllocation = {};
+        m_IndexAllocation  = {};
     }
-} // namespace Zephyr
\ No newline at end of file
+} // namespace Zephyr
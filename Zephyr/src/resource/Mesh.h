@@ -2,6 +2,7 @@
 #include "core/math/AABB.h"
 #include "glm/glm.hpp"
 #include "pch.h"
+#include "resource/GeometryPool.h"
 #include "rhi/Handle.h"
 #include "rhi/RHIBuffer.h"
 
@@ -32,6 +33,9 @@ namespace Zephyr
         uint32_t vertexCount;
         uint32_t indexCount;
         uint32_t materialIndex;
+        // offsets into the global geometry pool buffers, filled in when the mesh is uploaded
+        uint32_t globalVertexOffset = 0;
+        uint32_t globalIndexOffset  = 0;
 
         glm::mat4 transform      = glm::mat4(1.f);
         glm::mat4 localTransform = glm::mat4(1.f);
@@ -45,15 +49,15 @@ namespace Zephyr
     public:
         void SetMaterials(const std::vector<MaterialInstance*>& materials);
 
-        void InitResource(Driver* driver);
-        void Destroy(Driver* driver);
+        void InitResource(GeometryPool* pool);
+        void Destroy(GeometryPool* pool);
 
         inline const std::vector<Vertex>&            GetVertices() { return m_Vertices; }
         inline const std::vector<uint32_t>&          GetIndices() { return m_Indices; }
         inline const std::vector<Submesh>&           GetSubmeshes() { return m_Submeshes; }
         inline const std::vector<MaterialInstance*>& GetMaterials() { return m_Materials; }
-        inline Handle<RHIBuffer>                     GetVertexBuffer() { return m_VertexBuffer; }
-        inline Handle<RHIBuffer>                     GetIndexBuffer() { return m_IndexBuffer; }
+        inline Handle<RHIBuffer>                     GetVertexBuffer() { return m_Pool->GetVertexBuffer(); }
+        inline Handle<RHIBuffer>                     GetIndexBuffer() { return m_Pool->GetIndexBuffer(); }
 
     protected:
         Mesh();
@@ -64,8 +68,9 @@ namespace Zephyr
         std::vector<uint32_t>          m_Indices;
         std::vector<Submesh>           m_Submeshes;
         std::vector<MaterialInstance*> m_Materials;
-        Handle<RHIBuffer>              m_VertexBuffer;
-        Handle<RHIBuffer>              m_IndexBuffer;
+        GeometryPool*                  m_Pool = nullptr;
+        GeometryAllocation             m_VertexAllocation;
+        GeometryAllocation             m_IndexAllocation;
 
         AABB m_Aabb;
 
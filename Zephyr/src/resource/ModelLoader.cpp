@@ -4,6 +4,7 @@
 #include "Mesh.h"
 #include "ResourceManager.h"
 #include "Texture.h"
+#include "core/profile/Profiler.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -48,6 +49,7 @@ namespace Zephyr
 
     Mesh* ModelLoader::LoadModel(const std::string& path)
     {
+        ZEPHYR_PROFILE_ZONE("ModelLoader::LoadModel");
         auto iter = m_MeshCache.find(path);
         if (iter != m_MeshCache.end())
         {
@@ -1,12 +1,15 @@
 #include "ResourceManager.h"
+#include "GeometryPool.h"
 #include "Material.h"
 #include "MaterialInstance.h"
 #include "Mesh.h"
 #include "ShaderSet.h"
 #include "Texture.h"
+#include "core/profile/Profiler.h"
 #include "engine/Engine.h"
 #include "platform/Path.h"
 #include "preset/geometry/BoxMesh.h"
+#include "render/SinglePassDownsampler.h"
 #include "rhi/Driver.h"
 
 namespace Zephyr
@@ -59,10 +62,13 @@ namespace Zephyr
 
         for (auto& mesh : m_Meshes)
         {
-            mesh->Destroy(driver);
+            mesh->Destroy(m_GeometryPool);
             delete mesh;
         }
 
+        m_GeometryPool->Shutdown();
+        delete m_GeometryPool;
+
         for (auto& material : m_Materials)
         {
             delete material.second;
@@ -81,6 +87,8 @@ namespace Zephyr
         InitMaterials(driver);
         InitDefaultTextures(driver);
 
+        m_GeometryPool = new GeometryPool(driver, GEOMETRY_POOL_VERTEX_CAPACITY, GEOMETRY_POOL_INDEX_CAPACITY);
+
         m_SkyboxMesh = CreateMesh(BoxMeshDescription {2.f, 2.f, 2.f});
         // create materials
     }
@@ -106,6 +114,14 @@ namespace Zephyr
         auto dgShader = new ShaderSet(shaderDesc, driver);
         m_ShaderSets.insert({"deferredGeometry", dgShader});
 
+        // depth pre-pass, fetches the position stream only
+        shaderDesc.vertex     = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/depthPrepass.vert.spv"));
+        shaderDesc.fragment   = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/cascadeShadow.frag.spv"));
+        shaderDesc.vertexType = VertexType::PositionOnly;
+
+        auto depthPrepassShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"depthPrepass", depthPrepassShader});
+
         // deferred lighting
         shaderDesc.vertex     = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/deferredLighting.vert.spv"));
         shaderDesc.fragment   = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/deferredLighting.frag.spv"));
@@ -122,6 +138,24 @@ namespace Zephyr
         auto shadowShader = new ShaderSet(shaderDesc, driver);
         m_ShaderSets.insert({"shadow", shadowShader});
 
+        // single pass cascade shadow, only loaded when the device can route a draw to several layers
+        if (driver->GetCapabilities().layeredRendering)
+        {
+            shaderDesc.vertex =
+                LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/cascadeShadowLayered.vert.spv"));
+
+            auto shadowLayeredShader = new ShaderSet(shaderDesc, driver);
+            m_ShaderSets.insert({"shadowLayered", shadowLayeredShader});
+        }
+        else if (driver->GetCapabilities().multiview)
+        {
+            shaderDesc.vertex =
+                LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/cascadeShadowMultiview.vert.spv"));
+
+            auto shadowMultiviewShader = new ShaderSet(shaderDesc, driver);
+            m_ShaderSets.insert({"shadowMultiview", shadowMultiviewShader});
+        }
+
         // skybox
         shaderDesc.vertex   = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/skybox.vert.spv"));
         shaderDesc.fragment = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/skybox.frag.spv"));
@@ -129,12 +163,6 @@ namespace Zephyr
         auto skyboxShader = new ShaderSet(shaderDesc, driver);
         m_ShaderSets.insert({"skybox", skyboxShader});
 
-        // post
-        shaderDesc.pipeline = PipelineTypeBits::Compute;
-        shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/post.comp.spv"));
-
-        auto postShader = new ShaderSet(shaderDesc, driver);
-        m_ShaderSets.insert({"postCompute", postShader});
         // bloom prefilter
         shaderDesc.pipeline = PipelineTypeBits::Compute;
         shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/bloomPrefilter.comp.spv"));
@@ -156,21 +184,38 @@ namespace Zephyr
         auto bloomUpsampleShader = new ShaderSet(shaderDesc, driver);
         m_ShaderSets.insert({"bloomUpsample", bloomUpsampleShader});
 
-        // bloom composite
+        // bloom composite, color grading and tonemapping, effects are toggled through specialization
         shaderDesc.pipeline = PipelineTypeBits::Compute;
-        shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/bloomComposite.comp.spv"));
+        shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/postComposite.comp.spv"));
 
-        auto bloomCompositeShader = new ShaderSet(shaderDesc, driver);
-        m_ShaderSets.insert({"bloomComposite", bloomCompositeShader});
+        auto postCompositeShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"postComposite", postCompositeShader});
 
-        // fxaa
+        // clustered light culling
         shaderDesc.pipeline = PipelineTypeBits::Compute;
-        shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/fxaa.comp.spv"));
+        shaderDesc.compute  = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/clusterLightCulling.comp.spv"));
+
+        auto clusterLightCullingShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"clusterLightCulling", clusterLightCullingShader});
+
+        // hi-z occlusion culling
+        shaderDesc.compute = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/hiZBuild.comp.spv"));
+
+        auto hiZBuildShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"hiZBuild", hiZBuildShader});
+
+        shaderDesc.compute = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/occlusionCull.comp.spv"));
 
-        auto fxaaShader = new ShaderSet(shaderDesc, driver);
-        m_ShaderSets.insert({"fxaa", fxaaShader});
+        auto occlusionCullShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"occlusionCull", occlusionCullShader});
 
-        // resolve
+        // single pass mip chain generation
+        shaderDesc.compute = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/spd.comp.spv"));
+
+        auto spdShader = new ShaderSet(shaderDesc, driver);
+        m_ShaderSets.insert({"spd", spdShader});
+
+        // fxaa and dither into the swapchain
         shaderDesc.pipeline   = PipelineTypeBits::Graphics;
         shaderDesc.vertex     = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/quad.vert.spv"));
         shaderDesc.fragment   = LoadShaderFromFile(Path::GetFilePath("/asset/shader/spv/resolve.frag.spv"));
@@ -378,14 +423,40 @@ namespace Zephyr
 
     Texture* ResourceManager::CreateTexture(const std::string& path, bool srgb, bool flip)
     {
-        auto texture = m_TextureLoader.Load(path, srgb, flip);
-        m_Engine->GetDriver()->GenerateMips(texture->GetHandle());
+        ZEPHYR_PROFILE_ZONE("ResourceManager::CreateTexture(path)");
+        auto driver      = m_Engine->GetDriver();
+        bool storageMips = driver->GetCapabilities().storageWriteWithoutFormat;
+        auto texture     = m_TextureLoader.Load(path, srgb, flip, storageMips);
+
+        // the renderer builds storage mip chains with the single pass downsampler in its next frame
+        auto& desc = texture->GetDescription();
+        if ((desc.usage & TextureUsageBits::Storage) && desc.levels > 1 &&
+            SinglePassDownsampler::Fits(desc.width, desc.height))
+        {
+            if (std::find(m_PendingMipTextures.begin(), m_PendingMipTextures.end(), texture) ==
+                m_PendingMipTextures.end())
+            {
+                m_PendingMipTextures.push_back(texture);
+            }
+        }
+        else
+        {
+            driver->GenerateMips(texture->GetHandle());
+        }
 
         return texture;
     }
 
     Texture* ResourceManager::CreateTexture(std::string path[6]) { return m_TextureLoader.Load(path); }
 
+    std::vector<Texture*> ResourceManager::TakePendingMipTextures()
+    {
+        std::vector<Texture*> pending;
+        pending.swap(m_PendingMipTextures);
+
+        return pending;
+    }
+
     Buffer* ResourceManager::CreateBuffer(const BufferDescription& desc)
     {
         auto buffer = new Buffer(desc, m_Engine->GetDriver());
@@ -396,10 +467,11 @@ namespace Zephyr
 
     Mesh* ResourceManager::CreateMesh(const std::string& path)
     {
+        ZEPHYR_PROFILE_ZONE("ResourceManager::CreateMesh(path)");
         // TODO: better hierachy
         auto mesh = m_ModelLoader.LoadModel(Path::GetFilePath(path));
 
-        mesh->InitResource(m_Engine->GetDriver());
+        mesh->InitResource(m_GeometryPool);
 
         m_Meshes.push_back(mesh);
 
@@ -412,7 +484,7 @@ namespace Zephyr
         m_Meshes.push_back(mesh);
         auto mi = CreateMaterialInstance(ShadingModel::Lit);
         mesh->SetMaterials({mi});
-        mesh->InitResource(m_Engine->GetDriver());
+        mesh->InitResource(m_GeometryPool);
         return mesh;
     }
 
@@ -465,4 +537,34 @@ namespace Zephyr
         return iter->second;
     }
 
+    ShaderSet* ResourceManager::GetShaderSet(const std::string& name, const std::vector<uint32_t>& specialization)
+    {
+        std::string key = name;
+        for (auto value : specialization)
+        {
+            key += "#" + std::to_string(value);
+        }
+
+        auto iter = m_ShaderSets.find(key);
+        if (iter != m_ShaderSets.end())
+        {
+            return iter->second;
+        }
+
+        auto base = GetShaderSet(name);
+        if (!base)
+        {
+            return nullptr;
+        }
+
+        // variants are compiled the first time they're asked for and live as long as the base shader set
+        ShaderSetDescription desc = base->m_Description;
+        desc.specialization       = specialization;
+
+        auto variant = new ShaderSet(desc, m_Engine->GetDriver());
+        m_ShaderSets.insert({key, variant});
+
+        return variant;
+    }
+
 } // namespace Zephyr
\ No newline at end of file
@@ -20,6 +20,7 @@ namespace Zephyr
     class MaterialInstance;
     class ShaderSet;
     class Driver;
+    class GeometryPool;
 
     class ResourceManager final
     {
@@ -45,6 +46,8 @@ namespace Zephyr
         Material* GetMaterial(const std::string& name);
 
         ShaderSet* GetShaderSet(const std::string& name);
+        // same shaders with their specialization constants set, e.g. to toggle effects of an uber shader
+        ShaderSet* GetShaderSet(const std::string& name, const std::vector<uint32_t>& specialization);
 
         inline Texture* GetWhiteTexture() const { return m_WhiteTexture; }
         inline Texture* GetBlackTexture() const { return m_BlackTexture; }
@@ -54,6 +57,11 @@ namespace Zephyr
         inline Texture* GetDither() const { return m_DitherTexture; }
         inline Mesh*    GetSkyboxMesh() { return m_SkyboxMesh; }
 
+        inline GeometryPool* GetGeometryPool() { return m_GeometryPool; }
+
+        // textures still waiting for their mip chain, the caller takes over generating them
+        std::vector<Texture*> TakePendingMipTextures();
+
     private:
         void InitShaderSets(Driver* driver);
         void InitMaterials(Driver* driver);
@@ -70,7 +78,10 @@ namespace Zephyr
         std::vector<MaterialInstance*>              m_MaterialInstances;
         // this is just cache, m_Textures owns the texture;
         std::unordered_map<std::string, Texture*> m_TexturePathMap;
+        std::vector<Texture*>                     m_PendingMipTextures;
         Mesh*                                     m_SkyboxMesh = nullptr;
+        // every mesh is suballocated from here
+        GeometryPool* m_GeometryPool = nullptr;
 
         Texture* m_DefaultSkybox = nullptr;
         Texture* m_DefaultPrefilterEnv = nullptr;
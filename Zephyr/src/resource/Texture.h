@@ -13,6 +13,7 @@ namespace Zephyr
     public:
         void Update(const TextureUpdateDescriptor& desc, Driver* driver);
         inline Handle<RHITexture> GetHandle() const { return m_Handle; } 
+        inline const TextureDescription& GetDescription() const { return m_Description; }
     private:
         Texture(const TextureDescription& desc, Driver* driver);
         virtual ~Texture() = default;
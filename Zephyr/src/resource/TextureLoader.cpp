@@ -1,6 +1,7 @@
 #include "TextureLoader.h"
 #include "ResourceManager.h"
 #include "Texture.h"
+#include "core/profile/Profiler.h"
 #include "engine/Engine.h"
 #include "rhi/RHIEnums.h"
 #include <stb_image.h>
@@ -11,8 +12,9 @@ namespace Zephyr
 
     TextureLoader::~TextureLoader() {}
 
-    Texture* TextureLoader::Load(const std::string& path, bool srgb, bool flip)
+    Texture* TextureLoader::Load(const std::string& path, bool srgb, bool flip, bool storageMips)
     {
+        ZEPHYR_PROFILE_ZONE("TextureLoader::Load");
         auto iter = m_TextureCache.find(path);
 
         if (iter != m_TextureCache.end())
@@ -62,6 +64,12 @@ namespace Zephyr
         textureDesc.usage     = TextureUsageBits::Sampled;
         textureDesc.levels    = 1;
         textureDesc.levels    = log2(std::max(width, height)) + 1;
+        // srgb formats can't be storage images, those keep blitting their mips
+        if (storageMips && imageFormat != TextureFormat::RGBA8_SRGB)
+        {
+            textureDesc.pipelines |= PipelineTypeBits::Compute;
+            textureDesc.usage |= TextureUsageBits::Storage;
+        }
         // TODO: support multisampling
         textureDesc.samples = 1;
 
@@ -85,6 +93,7 @@ namespace Zephyr
 
     Texture* TextureLoader::Load(std::string path[6])
     {
+        ZEPHYR_PROFILE_ZONE("TextureLoader::Load(cube)");
         // load
         uint8_t* imageData[6] = {};
         uint32_t imageSize[6] = {};
@@ -138,6 +147,7 @@ namespace Zephyr
 
     Texture* TextureLoader::LoadEnv(const std::string& path)
     {
+        ZEPHYR_PROFILE_ZONE("TextureLoader::LoadEnv");
 
         std::ifstream   file(path, std::ios::binary | std::ios::ate);
         std::streamsize size = file.tellg();
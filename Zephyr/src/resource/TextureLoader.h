@@ -14,7 +14,8 @@ namespace Zephyr
         TextureLoader(ResourceManager* manager);
         ~TextureLoader();
 
-        Texture* Load(const std::string& path, bool srgb = false, bool flip = true);
+        // storageMips makes the mip chain writable from compute, ignored for srgb formats
+        Texture* Load(const std::string& path, bool srgb = false, bool flip = true, bool storageMips = false);
         Texture* Load(std::string path[6]);
         Texture* LoadEnv(const std::string& path);
     private:
@@ -292,6 +292,9 @@ namespace Zephyr
         submesh.indexCount    = m_Indices.size();
         submesh.vertexCount   = m_Vertices.size();
         submesh.materialIndex = 0;
+        submesh.aabb          = AABB({-halfWidth, -halfHeight, -halfDepth}, {halfWidth, halfHeight, halfDepth});
+
+        m_Aabb = submesh.aabb;
     }
 
     BoxMesh::~BoxMesh() {}
@@ -12,4 +12,15 @@ namespace Zephyr
 
         assert(false);
     }
+
+    Driver* Driver::CreateHeadless(DriverType backend, uint32_t width, uint32_t height)
+    {
+        switch (backend)
+        {
+            case DriverType::Vulkan:
+                return new VulkanDriver(width, height);
+        }
+
+        assert(false);
+    }
 } // namespace Zephyr::backend
\ No newline at end of file
@@ -11,6 +11,58 @@ namespace Zephyr
 {
     class Mesh;
     class Window;
+
+    // optional backend features, queried once at device creation
+    struct DriverCapabilities
+    {
+        // vertex shader can select the render target layer, one draw can feed every layer through instancing
+        bool layeredRendering = false;
+        // render pass broadcasts every draw to several layers through a view mask
+        bool multiview = false;
+        // storage images can be written without a format qualifier in the shader
+        bool storageWriteWithoutFormat = false;
+        // gpu time of frames and profiled scopes
+        bool timestamps = false;
+        // primitive and fragment counts of profiled graphics scopes
+        bool pipelineStatistics = false;
+    };
+
+    struct GpuScopeTiming
+    {
+        std::string name;
+        // milliseconds
+        float time = 0.f;
+        // only graphics scopes recorded with statistics enabled have counts
+        bool     hasStatistics = false;
+        uint64_t primitives    = 0;
+        uint64_t fragments     = 0;
+    };
+
+    // resolved queries of one finished frame
+    struct GpuFrameTimings
+    {
+        bool     valid = false;
+        uint64_t frame = 0;
+        // milliseconds from the first to the last command of the frame
+        float                       frameTime = -1.f;
+        std::vector<GpuScopeTiming> scopes;
+    };
+
+    // what the last ended frame recorded, memory is what is allocated at that point
+    struct DriverStatistics
+    {
+        uint32_t drawCalls          = 0;
+        uint32_t dispatches         = 0;
+        uint32_t pipelineBinds      = 0;
+        uint32_t descriptorSetBinds = 0;
+        // descriptor sets allocated and written because the cache had no match
+        uint32_t descriptorSetWrites = 0;
+        uint32_t submits             = 0;
+        // bytes
+        uint64_t bufferMemory  = 0;
+        uint64_t textureMemory = 0;
+    };
+
     /*
         Zephyr engine backend
         Driver instance controls all backend resources like render context, swapchain,
@@ -21,8 +73,12 @@ namespace Zephyr
     {
     public:
         static Driver* Create(DriverType backend, Window* window);
+        // renders into offscreen images, no window or presentation engine involved
+        static Driver* CreateHeadless(DriverType backend, uint32_t width, uint32_t height);
         virtual ~Driver() {}
 
+        virtual const DriverCapabilities& GetCapabilities() = 0;
+
         // rhi functions
         //  resource allocation
         virtual Handle<RHIBuffer>       CreateBuffer(const BufferDescription& desc)                            = 0;
@@ -50,6 +106,11 @@ namespace Zephyr
         virtual void EndFrame()                                                                    = 0;
         virtual void WaitAndPresent()                                                              = 0;
         virtual void DrawIndexed(uint32_t vertexOffset, uint32_t indexOffset, uint32_t indexCount) = 0;
+        virtual void DrawIndexedInstanced(uint32_t vertexOffset,
+                                          uint32_t indexOffset,
+                                          uint32_t indexCount,
+                                          uint32_t instanceCount)                                  = 0;
+        virtual void DrawIndexedIndirect(Handle<RHIBuffer> buffer, uint32_t offset)                = 0;
         virtual void Draw(uint32_t vertexCount, uint32_t vertexOffset)                             = 0;
         virtual void Dispatch(uint32_t x, uint32_t y, uint32_t z)                                  = 0;
 
@@ -82,5 +143,17 @@ namespace Zephyr
                                   PipelineType       pipeline) = 0;
 
         virtual void WaitIdle() = 0;
+
+        // milliseconds the gpu spent on the last finished frame, negative when timestamps are unavailable
+        virtual float GetGpuFrameTime() = 0;
+
+        // brackets the commands recorded in between with timestamps on the queue of the pipeline, scopes don't nest
+        virtual void BeginGpuScope(const std::string& name, PipelineType pipeline) = 0;
+        virtual void EndGpuScope(PipelineType pipeline)                            = 0;
+        // counts primitives and fragments of graphics scopes, off by default
+        virtual void SetPipelineStatistics(bool enabled) = 0;
+        // the latest frame whose queries were resolved, it lags behind by the frames in flight
+        virtual const GpuFrameTimings& GetGpuTimings() = 0;
+        virtual const DriverStatistics& GetStatistics() = 0;
     };
 } // namespace Zephyr
\ No newline at end of file
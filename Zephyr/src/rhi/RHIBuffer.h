@@ -21,6 +21,16 @@ namespace Zephyr
         void*    data;
         uint32_t size;
     };
+    // matches VkDrawIndexedIndirectCommand
+    struct DrawIndexedIndirectCommand
+    {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t  vertexOffset;
+        uint32_t firstInstance;
+    };
+
     class RHIBuffer
     {
     public:
@@ -27,7 +27,8 @@ namespace Zephyr
             Uniform        = Index << 1,
             UniformDynamic = Uniform << 1,
             Storage        = UniformDynamic << 1,
-            StorageDynamic = Storage << 1
+            StorageDynamic = Storage << 1,
+            Indirect       = StorageDynamic << 1
         };
     };
 
@@ -70,6 +71,18 @@ namespace Zephyr
         CounterClockwise
     };
 
+    enum class CompareOp
+    {
+        Never = 0,
+        Less,
+        Equal,
+        LessOrEqual,
+        Greater,
+        NotEqual,
+        GreaterOrEqual,
+        Always
+    };
+
     struct TextureUsageBits
     {
         enum : uint32_t
@@ -101,6 +114,9 @@ namespace Zephyr
         DEFAULT = 0,
 
         R8_UNORM = 1,
+        R32_SFLOAT,
+        RG16_UNORM,
+        R11G11B10_UFLOAT,
 
         RGBA8_UNORM,
         RGBA8_SNORM,
@@ -167,6 +183,8 @@ namespace Zephyr
         None = 0,
         Static,
         Dynamic,
+        // position stream of the geometry pool only, for depth-only passes
+        PositionOnly,
     };
 
     struct PipelineTypeBits
@@ -259,11 +277,13 @@ namespace Zephyr
         bool      depthTestEnabled;
         bool      depthWriteEnabled;
         bool      enableAlphaBlend = true;
+        CompareOp depthCompare     = CompareOp::LessOrEqual;
 
         bool operator==(const RasterState& rhs) const
         {
             return rhs.cull == cull && rhs.frontFace == frontFace && depthTestEnabled == rhs.depthTestEnabled &&
-                   depthWriteEnabled == rhs.depthWriteEnabled && enableAlphaBlend == rhs.enableAlphaBlend;
+                   depthWriteEnabled == rhs.depthWriteEnabled && enableAlphaBlend == rhs.enableAlphaBlend &&
+                   depthCompare == rhs.depthCompare;
         }
     };
 } // namespace Zephyr
\ No newline at end of file
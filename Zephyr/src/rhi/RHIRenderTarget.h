@@ -12,10 +12,12 @@ namespace Zephyr
         TextureUsage usage;
         bool         clear = true;
         bool         save  = true;
+        // more than one layer makes this a layered attachment
+        uint32_t     layerCount = 1;
         bool         operator==(const AttachmentDescriptor& rhs) const
         {
             return layer == rhs.layer && level == rhs.level && usage == rhs.usage && clear == rhs.clear &&
-                   save == rhs.save;
+                   save == rhs.save && layerCount == rhs.layerCount;
         }
     };
 
@@ -25,10 +27,12 @@ namespace Zephyr
         bool                              useDepthStencil;
         AttachmentDescriptor              depthStencil;
         bool                              present = false;
+        // layered attachments are broadcast with a view mask instead of selecting the layer in the shader
+        bool multiview = false;
 
         bool operator==(const RenderTargetDescription& rhs) const
         {
-            if (rhs.present != present)
+            if (rhs.present != present || rhs.multiview != multiview)
             {
                 return false;
             }
@@ -66,11 +70,12 @@ namespace Zephyr
             {
                 r ^= std::hash<uint32_t>()(color.layer) ^ std::hash<uint32_t>()(color.level) ^
                      std::hash<uint32_t>()(color.usage) ^ std::hash<bool>()(color.clear) ^
-                     std::hash<bool>()(color.save);
+                     std::hash<bool>()(color.save) ^ std::hash<uint32_t>()(color.layerCount);
             }
             r ^= std::hash<bool>()(t.useDepthStencil) ^ std::hash<uint32_t>()(t.depthStencil.layer) ^
                  std::hash<uint32_t>()(t.depthStencil.level) ^ std::hash<uint32_t>()(t.depthStencil.usage) ^
-                 std::hash<bool>()(t.depthStencil.clear) ^ std::hash<bool>()(t.depthStencil.save);
+                 std::hash<bool>()(t.depthStencil.clear) ^ std::hash<bool>()(t.depthStencil.save) ^
+                 std::hash<uint32_t>()(t.depthStencil.layerCount) ^ std::hash<bool>()(t.multiview);
 
             return r;
         }
@@ -10,6 +10,8 @@ namespace Zephyr
         std::vector<uint32_t> vertex;
         std::vector<uint32_t> fragment;
         std::vector<uint32_t> compute;
+        // values for constant_id 0..n-1, shared by every stage
+        std::vector<uint32_t> specialization;
     };
 
     class RHIShaderSet
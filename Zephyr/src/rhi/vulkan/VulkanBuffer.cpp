@@ -46,6 +46,7 @@ namespace Zephyr
 
         VK_CHECK(vkAllocateMemory(context.Device(), &memoryAllocateInfo, nullptr, &m_Memory),
                  "Buffer Memory Allocation");
+        m_MemorySize = requiredSize;
 
         vkBindBufferMemory(context.Device(), m_Buffer, m_Memory, 0);
 
@@ -25,6 +25,7 @@ namespace Zephyr
         inline uint32_t       GetOffset(uint32_t index) const { return m_RingBufferAlignment * index; }
         inline VkDeviceMemory GetMemory() const { return m_Memory; }
         inline void*          GetMapped() { return m_DataPtr; }
+        inline VkDeviceSize   GetMemorySize() const { return m_MemorySize; }
 
     private:
         uint32_t GetBufferSize(VulkanDriver* driver, uint32_t size, BufferUsage usage, BufferMemoryType type);
@@ -32,6 +33,7 @@ namespace Zephyr
     private:
         VkBuffer       m_Buffer = VK_NULL_HANDLE;
         VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+        VkDeviceSize   m_MemorySize = 0;
 
         BufferDescription m_Description;
         // when the buffer is a ringbuffer, the actual size is x times the normal size,
@@ -4,12 +4,12 @@
 
 namespace Zephyr
 {
-    VulkanContext::VulkanContext() { 
-        CreateInstance();
+    VulkanContext::VulkanContext(bool headless) { 
+        CreateInstance(headless);
         PickPhysicalDevice();
         GetDepthFormat();
         GetQueueFamilyIndices();
-        CreateLogicalDevice();
+        CreateLogicalDevice(headless);
         CreateCommandPool();
         CreateDescriptorPool();
         CreateTimeQuery();
@@ -19,6 +19,14 @@ namespace Zephyr
 
     void VulkanContext::Cleanup() {
         vkDeviceWaitIdle(m_Device);
+        if (m_TimestampQueryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_Device, m_TimestampQueryPool, nullptr);
+        }
+        if (m_PipelineStatisticsQueryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_Device, m_PipelineStatisticsQueryPool, nullptr);
+        }
         vkDestroyDescriptorPool(m_Device, m_GlobalDescriptorPool, nullptr);
         vkDestroyCommandPool(m_Device, m_GlobalGraphicsCommandPool, nullptr);
         vkDestroyCommandPool(m_Device, m_GlobalComputeCommandPool, nullptr);
@@ -75,7 +83,7 @@ namespace Zephyr
         vkFreeCommandBuffers(m_Device, m_GlobalGraphicsCommandPool, 1, &cb);
     }
 
-    void VulkanContext::CreateInstance() { 
+    void VulkanContext::CreateInstance(bool headless) { 
         m_Validation = new VulkanValidation();
 
         VkApplicationInfo appInfo {};
@@ -90,6 +98,10 @@ namespace Zephyr
         // 3: debug utils
         std::vector<const char*> extensions = {
             VK_KHR_SURFACE_EXTENSION_NAME, "VK_KHR_win32_surface", VK_EXT_DEBUG_UTILS_EXTENSION_NAME};
+        if (headless)
+        {
+            extensions = {VK_EXT_DEBUG_UTILS_EXTENSION_NAME};
+        }
 
         VkInstanceCreateInfo createInfo {};
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -128,6 +140,15 @@ namespace Zephyr
                 break;
             }
         }
+        // integrated or software devices(lavapipe on ci machines) otherwise
+        if (!m_PhysicalDevice)
+        {
+            VkPhysicalDeviceProperties prop;
+            vkGetPhysicalDeviceProperties(deviceList[0], &prop);
+
+            printf("No Discrete GPU, falling back to: %s\n", prop.deviceName);
+            m_PhysicalDevice = deviceList[0];
+        }
         assert(m_PhysicalDevice);
 
         // get queue family properties(for later queue creation)
@@ -216,7 +237,7 @@ namespace Zephyr
                m_QueueFamilyIndices.transfer > -1);
     }
 
-    void VulkanContext::CreateLogicalDevice() { 
+    void VulkanContext::CreateLogicalDevice(bool headless) { 
         // queue info
         float priority = 1.0f;
 
@@ -240,7 +261,11 @@ namespace Zephyr
         std::vector<const char*> layers {};
 
         // extensions
-        std::vector<const char*> extensions {"VK_KHR_swapchain"};
+        std::vector<const char*> extensions {};
+        if (!headless)
+        {
+            extensions.push_back("VK_KHR_swapchain");
+        }
 
         for (auto& extension : extensions)
         {
@@ -248,6 +273,38 @@ namespace Zephyr
             assert(IsDeviceExtensionSupported(extension));
         }
 
+        // optional features for single pass layered rendering(gl_Layer from the vertex shader, or multiview)
+        VkPhysicalDeviceVulkan11Features supported11 {};
+        supported11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+        VkPhysicalDeviceVulkan12Features supported12 {};
+        supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        supported12.pNext = &supported11;
+        VkPhysicalDeviceFeatures2 supported {};
+        supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported.pNext = &supported12;
+        vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &supported);
+
+        m_SupportsShaderOutputLayer = supported12.shaderOutputLayer == VK_TRUE;
+        m_SupportsMultiview         = supported11.multiview == VK_TRUE;
+        m_SupportsStorageWriteWithoutFormat =
+            supported.features.shaderStorageImageWriteWithoutFormat == VK_TRUE;
+        m_SupportsPipelineStatisticsQuery = supported.features.pipelineStatisticsQuery == VK_TRUE;
+
+        VkPhysicalDeviceVulkan11Features enabled11 {};
+        enabled11.sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+        enabled11.multiview = supported11.multiview;
+        VkPhysicalDeviceVulkan12Features enabled12 {};
+        enabled12.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        enabled12.shaderOutputLayer = supported12.shaderOutputLayer;
+        enabled12.pNext             = &enabled11;
+        VkPhysicalDeviceFeatures2 enabled {};
+        enabled.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        enabled.pNext = &enabled12;
+        // lets one compute shader write mip chains of any color format
+        enabled.features.shaderStorageImageWriteWithoutFormat = supported.features.shaderStorageImageWriteWithoutFormat;
+        // primitive and fragment counts for the gpu profiler
+        enabled.features.pipelineStatisticsQuery = supported.features.pipelineStatisticsQuery;
+
         VkDeviceCreateInfo createInfo {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.queueCreateInfoCount = queueCreateInfo.size();
@@ -256,6 +313,7 @@ namespace Zephyr
         createInfo.ppEnabledLayerNames  = layers.data();
         createInfo.enabledExtensionCount   = extensions.size();
         createInfo.ppEnabledExtensionNames = extensions.data();
+        createInfo.pNext                   = &enabled;
 
         VK_CHECK(vkCreateDevice(m_PhysicalDevice, &createInfo, nullptr, &m_Device), "Device Creation");
 
@@ -303,7 +361,41 @@ namespace Zephyr
     }
 
     void VulkanContext::CreateTimeQuery() {
-        // TODO: implement
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+
+        // a frame is split across the graphics and compute queue, both have to write comparable timestamps
+        bool supported = properties.limits.timestampComputeAndGraphics == VK_TRUE &&
+                         m_QueueFamilyProperties[m_QueueFamilyIndices.graphics].timestampValidBits != 0 &&
+                         m_QueueFamilyProperties[m_QueueFamilyIndices.compute].timestampValidBits != 0;
+        if (!supported)
+        {
+            return;
+        }
+
+        m_TimestampPeriod = properties.limits.timestampPeriod;
+
+        VkQueryPoolCreateInfo createInfo {};
+        createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+        createInfo.queryCount = TIMESTAMP_QUERIES_PER_FRAME * MAX_CONCURRENT_FRAME;
+
+        VK_CHECK(vkCreateQueryPool(m_Device, &createInfo, nullptr, &m_TimestampQueryPool), "Timestamp Query Pool Creation");
+
+        if (!m_SupportsPipelineStatisticsQuery)
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo statisticsInfo {};
+        statisticsInfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsInfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount         = GPU_SCOPES_PER_FRAME * MAX_CONCURRENT_FRAME;
+        statisticsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        VK_CHECK(vkCreateQueryPool(m_Device, &statisticsInfo, nullptr, &m_PipelineStatisticsQueryPool),
+                 "Pipeline Statistics Query Pool Creation");
     }
 
     bool VulkanContext::IsDeviceExtensionSupported(const char* extension)
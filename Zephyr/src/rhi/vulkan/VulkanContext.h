@@ -1,11 +1,17 @@
 #pragma once
 #include "pch.h"
 #include "VulkanCommon.h"
+#include "rhi/RHIEnums.h"
 
 namespace Zephyr
 {
     class VulkanValidation;
 
+    // profiled scopes a frame can record, later ones are dropped
+    inline constexpr uint32_t GPU_SCOPES_PER_FRAME = 128;
+    // the frame's first and last command, then a begin and end pair for every scope
+    inline constexpr uint32_t TIMESTAMP_QUERIES_PER_FRAME = 2 + 2 * GPU_SCOPES_PER_FRAME;
+
     struct QueueFamilyIndices
     {
         int graphics = -1;
@@ -15,7 +21,8 @@ namespace Zephyr
     class VulkanContext final
     {
     public:
-        VulkanContext();
+        // a headless context needs neither surface nor swapchain extensions
+        explicit VulkanContext(bool headless = false);
         ~VulkanContext();
 
         inline QueueFamilyIndices QueueIndices() const { return m_QueueFamilyIndices; }
@@ -24,12 +31,21 @@ namespace Zephyr
         inline VkDescriptorPool   GetDescriptorPool() const { return m_GlobalDescriptorPool; }
         inline VkQueue            GetQueueGraphics() const { return m_GraphicsQueue; }
         inline VkQueue            GetQueueCompute() const { return m_ComputeQueue; }
+        inline bool               SupportsShaderOutputLayer() const { return m_SupportsShaderOutputLayer; }
+        inline bool               SupportsMultiview() const { return m_SupportsMultiview; }
+        inline bool SupportsStorageWriteWithoutFormat() const { return m_SupportsStorageWriteWithoutFormat; }
+        inline bool        SupportsTimestamps() const { return m_TimestampQueryPool != VK_NULL_HANDLE; }
+        inline VkQueryPool GetTimestampQueryPool() const { return m_TimestampQueryPool; }
+        // nanoseconds per timestamp tick
+        inline float GetTimestampPeriod() const { return m_TimestampPeriod; }
+        inline bool  SupportsPipelineStatistics() const { return m_PipelineStatisticsQueryPool != VK_NULL_HANDLE; }
+        inline VkQueryPool GetPipelineStatisticsQueryPool() const { return m_PipelineStatisticsQueryPool; }
     private:
-        void CreateInstance();
+        void CreateInstance(bool headless);
         void PickPhysicalDevice();
         void GetDepthFormat();
         void GetQueueFamilyIndices();
-        void CreateLogicalDevice();
+        void CreateLogicalDevice(bool headless);
         void CreateCommandPool();
         void CreateDescriptorPool();
         void CreateTimeQuery();
@@ -56,6 +72,16 @@ namespace Zephyr
         VkCommandPool m_GlobalGraphicsCommandPool;
         VkCommandPool m_GlobalComputeCommandPool;
         VkDescriptorPool m_GlobalDescriptorPool;
+        // optional features, enabled at device creation when the physical device has them
+        bool m_SupportsShaderOutputLayer = false;
+        bool m_SupportsMultiview         = false;
+        bool m_SupportsStorageWriteWithoutFormat = false;
+        // TIMESTAMP_QUERIES_PER_FRAME queries for every frame in flight
+        VkQueryPool m_TimestampQueryPool = VK_NULL_HANDLE;
+        float       m_TimestampPeriod    = 0.f;
+        // one query per scope, input assembly primitives and fragment shader invocations
+        bool        m_SupportsPipelineStatisticsQuery = false;
+        VkQueryPool m_PipelineStatisticsQueryPool     = VK_NULL_HANDLE;
 
         friend class VulkanSwapchain;
         friend class VulkanDriver;
@@ -9,13 +9,27 @@
 
 namespace Zephyr
 {
-    VulkanDriver::VulkanDriver(Window* window, bool headless) :
-        m_PipelineCache(this), m_SamplerCache(this), m_Window(window), m_Headless(headless)
+    VulkanDriver::VulkanDriver(Window* window) :
+        m_Window(window), m_Context(false), m_PipelineCache(this), m_SamplerCache(this)
     {
-        if (!headless)
-        {
-            m_Swapchain = new VulkanSwapchain(window, this);
-        }
+        m_Swapchain = new VulkanSwapchain(window, this);
+        Init();
+    }
+
+    VulkanDriver::VulkanDriver(uint32_t width, uint32_t height) :
+        m_Window(nullptr), m_Context(true), m_PipelineCache(this), m_SamplerCache(this), m_Headless(true)
+    {
+        m_Swapchain = new VulkanSwapchain(width, height, this);
+        Init();
+    }
+
+    void VulkanDriver::Init()
+    {
+        m_Capabilities.layeredRendering = m_Context.SupportsShaderOutputLayer();
+        m_Capabilities.multiview        = m_Context.SupportsMultiview();
+        m_Capabilities.storageWriteWithoutFormat = m_Context.SupportsStorageWriteWithoutFormat();
+        m_Capabilities.timestamps                = m_Context.SupportsTimestamps();
+        m_Capabilities.pipelineStatistics        = m_Context.SupportsPipelineStatistics();
 
         m_CommandPoolGraphics.resize(MAX_FRAME_IN_FLIGHT);
         m_CommandPoolCompute.resize(MAX_FRAME_IN_FLIGHT);
@@ -45,10 +59,7 @@ namespace Zephyr
     VulkanDriver::~VulkanDriver()
     {
         vkDeviceWaitIdle(m_Context.Device());
-        if (!m_Headless)
-        {
-            m_Swapchain->Shutdown();
-        }
+        m_Swapchain->Shutdown();
         m_PipelineCache.Shutdown();
         m_SamplerCache.Shutdown();
         auto device = m_Context.Device();
@@ -100,6 +111,7 @@ namespace Zephyr
         auto handle = GetHandle<RHIBuffer>();
         auto buffer = new VulkanBuffer(this, desc);
         m_ResourceCache.insert({handle.id, buffer});
+        m_BufferMemory += buffer->GetMemorySize();
 
         return handle;
     }
@@ -109,6 +121,7 @@ namespace Zephyr
         auto handle  = GetHandle<RHITexture>();
         auto texture = new VulkanTexture(this, desc);
         m_ResourceCache.insert({handle.id, texture});
+        m_TextureMemory += texture->GetMemorySize();
 
         return handle;
     }
@@ -150,12 +163,7 @@ namespace Zephyr
         return handle;
     }
 
-    Handle<RHITexture> VulkanDriver::GetSwapchainImage()
-    {
-        auto r = m_Swapchain->GetTexture();
-        auto a = GetResource<VulkanTexture>(r);
-        return m_Swapchain->GetTexture();
-    }
+    Handle<RHITexture> VulkanDriver::GetSwapchainImage() { return m_Swapchain->GetTexture(); }
 
     void VulkanDriver::UpdateBuffer(const BufferUpdateDescriptor& desc, Handle<RHIBuffer> handle)
     {
@@ -194,6 +202,7 @@ namespace Zephyr
         {
             return;
         }
+        m_BufferMemory -= buffer->GetMemorySize();
         buffer->Destroy(this);
         delete buffer;
         m_ResourceCache.erase(handle.id);
@@ -206,6 +215,7 @@ namespace Zephyr
         {
             return;
         }
+        m_TextureMemory -= texture->GetMemorySize();
         texture->Destroy(this);
         delete texture;
         m_ResourceCache.erase(handle.id);
@@ -252,6 +262,8 @@ namespace Zephyr
     bool VulkanDriver::BeginFrame(uint64_t frame)
     {
         m_CurrentFrameIndex = frame % MAX_CONCURRENT_FRAME;
+        m_CurrentFrame      = frame;
+        m_Statistics        = {};
 
         m_Swapchain->PrepareFrame(m_CurrentFrameIndex);
 
@@ -296,9 +308,151 @@ namespace Zephyr
             m_SemaphoreInUse[m_CurrentFrameIndex].clear();
         }
 
+        ResolveFrameQueries();
+
         return true;
     }
 
+    void VulkanDriver::BeginFrameQueries(VkCommandBuffer cb, PipelineType pipeline)
+    {
+        if (!m_FrameTimestampBegun && m_Context.SupportsTimestamps())
+        {
+            uint32_t first = m_CurrentFrameIndex * TIMESTAMP_QUERIES_PER_FRAME;
+            vkCmdResetQueryPool(cb, m_Context.GetTimestampQueryPool(), first, TIMESTAMP_QUERIES_PER_FRAME);
+            vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_Context.GetTimestampQueryPool(), first);
+
+            m_FrameTimestampBegun = true;
+        }
+
+        // statistics queries count graphics work, they are reset and used on the graphics queue only
+        if (!m_FrameStatisticsBegun && pipeline == PipelineTypeBits::Graphics && m_Context.SupportsPipelineStatistics())
+        {
+            vkCmdResetQueryPool(cb,
+                                m_Context.GetPipelineStatisticsQueryPool(),
+                                m_CurrentFrameIndex * GPU_SCOPES_PER_FRAME,
+                                GPU_SCOPES_PER_FRAME);
+
+            m_FrameStatisticsBegun = true;
+        }
+    }
+
+    void VulkanDriver::ResolveFrameQueries()
+    {
+        m_FrameTimestampBegun  = false;
+        m_FrameStatisticsBegun = false;
+        m_GpuScopeOpen         = false;
+
+        auto scopes = std::move(m_GpuScopes[m_CurrentFrameIndex]);
+        m_GpuScopes[m_CurrentFrameIndex].clear();
+
+        if (!m_FrameTimestampPending[m_CurrentFrameIndex])
+        {
+            return;
+        }
+        m_FrameTimestampPending[m_CurrentFrameIndex] = false;
+
+        // this slot's previous frame has finished by now, so the results never stall
+        uint32_t              count = 2 + 2 * scopes.size();
+        std::vector<uint64_t> timestamps(count);
+        auto                  result = vkGetQueryPoolResults(m_Context.Device(),
+                                            m_Context.GetTimestampQueryPool(),
+                                            m_CurrentFrameIndex * TIMESTAMP_QUERIES_PER_FRAME,
+                                            count,
+                                            timestamps.size() * sizeof(uint64_t),
+                                            timestamps.data(),
+                                            sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        float    period = m_Context.GetTimestampPeriod() / 1000000.f;
+        uint32_t first  = m_CurrentFrameIndex * TIMESTAMP_QUERIES_PER_FRAME;
+
+        m_GpuTimings.valid     = true;
+        m_GpuTimings.frame     = m_FrameTimestampFrame[m_CurrentFrameIndex];
+        m_GpuTimings.frameTime = (timestamps[1] - timestamps[0]) * period;
+        m_GpuTimings.scopes.clear();
+
+        for (auto& scope : scopes)
+        {
+            uint32_t index  = scope.timestamp - first;
+            auto&    timing = m_GpuTimings.scopes.emplace_back();
+            timing.name     = std::move(scope.name);
+            timing.time     = (timestamps[index + 1] - timestamps[index]) * period;
+
+            if (scope.statistics < 0)
+            {
+                continue;
+            }
+
+            // in bit order of the pool's statistics: input assembly primitives, fragment shader invocations
+            uint64_t statistics[2];
+            result = vkGetQueryPoolResults(m_Context.Device(),
+                                           m_Context.GetPipelineStatisticsQueryPool(),
+                                           scope.statistics,
+                                           1,
+                                           sizeof(statistics),
+                                           statistics,
+                                           sizeof(statistics),
+                                           VK_QUERY_RESULT_64_BIT);
+            if (result == VK_SUCCESS)
+            {
+                timing.hasStatistics = true;
+                timing.primitives    = statistics[0];
+                timing.fragments     = statistics[1];
+            }
+        }
+    }
+
+    void VulkanDriver::BeginGpuScope(const std::string& name, PipelineType pipeline)
+    {
+        auto& scopes = m_GpuScopes[m_CurrentFrameIndex];
+        if (!m_Context.SupportsTimestamps() || m_GpuScopeOpen || scopes.size() >= GPU_SCOPES_PER_FRAME)
+        {
+            return;
+        }
+
+        auto cb = pipeline == PipelineTypeBits::Graphics ? PrepareCommandBufferGraphics() : PrepareCommandBufferCompute();
+
+        uint32_t index  = scopes.size();
+        auto&    scope  = scopes.emplace_back();
+        scope.name      = name;
+        scope.timestamp = m_CurrentFrameIndex * TIMESTAMP_QUERIES_PER_FRAME + 2 + 2 * index;
+
+        vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_Context.GetTimestampQueryPool(), scope.timestamp);
+
+        if (m_PipelineStatistics && pipeline == PipelineTypeBits::Graphics && m_Context.SupportsPipelineStatistics())
+        {
+            scope.statistics = m_CurrentFrameIndex * GPU_SCOPES_PER_FRAME + index;
+            vkCmdBeginQuery(cb, m_Context.GetPipelineStatisticsQueryPool(), scope.statistics, 0);
+        }
+
+        m_GpuScopeOpen = true;
+    }
+
+    // a pass never switches command buffers of its own queue, so the scope ends in the one it began in
+    void VulkanDriver::EndGpuScope(PipelineType pipeline)
+    {
+        if (!m_GpuScopeOpen)
+        {
+            return;
+        }
+
+        auto  cb    = pipeline == PipelineTypeBits::Graphics ? PrepareCommandBufferGraphics() : PrepareCommandBufferCompute();
+        auto& scope = m_GpuScopes[m_CurrentFrameIndex].back();
+
+        if (scope.statistics >= 0)
+        {
+            vkCmdEndQuery(cb, m_Context.GetPipelineStatisticsQueryPool(), scope.statistics);
+        }
+        vkCmdWriteTimestamp(
+            cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Context.GetTimestampQueryPool(), scope.timestamp + 1);
+
+        m_GpuScopeOpen = false;
+    }
+
     void VulkanDriver::EndFrame()
     {
         // explicitly transition the swapchain image layout
@@ -306,8 +460,24 @@ namespace Zephyr
         m_BoundVertexBuffer = VK_NULL_HANDLE;
         m_BoundIndexBuffer  = VK_NULL_HANDLE;
 
+        if (m_FrameTimestampBegun)
+        {
+            uint32_t last = m_CurrentFrameIndex * TIMESTAMP_QUERIES_PER_FRAME + 1;
+            vkCmdWriteTimestamp(PrepareCommandBufferGraphics(),
+                                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                m_Context.GetTimestampQueryPool(),
+                                last);
+            m_FrameTimestampPending[m_CurrentFrameIndex] = true;
+            m_FrameTimestampFrame[m_CurrentFrameIndex]   = m_CurrentFrame;
+            m_FrameTimestampBegun                        = false;
+        }
+
         SubmitJobGraphics(false, true);
         assert(m_CurrentCommandBufferCompute == VK_NULL_HANDLE);
+
+        m_FrameStatistics               = m_Statistics;
+        m_FrameStatistics.bufferMemory  = m_BufferMemory;
+        m_FrameStatistics.textureMemory = m_TextureMemory;
         // end command buffer and submit
         // vkEndCommandBuffer(m_CommandBufferGraphics[m_CurrentFrameIndex]);
         // vkEndCommandBuffer(m_CommandBufferCompute[m_CurrentFrameIndex]);
@@ -352,11 +522,45 @@ namespace Zephyr
         // this will bind all descriptors
         m_PipelineCache.BindDescriptor(cb);
 
-        // auto t1 = std::chrono::steady_clock::now();
         vkCmdDrawIndexed(cb, indexCount, 1, indexOffset, vertexOffset, 0);
-        // auto t2     = std::chrono::steady_clock::now();
-        // auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / 10000;
-        // std::cout << "single draw time: " << delta << std::endl;
+        m_Statistics.drawCalls++;
+    }
+
+    void VulkanDriver::DrawIndexedInstanced(uint32_t vertexOffset,
+                                            uint32_t indexOffset,
+                                            uint32_t indexCount,
+                                            uint32_t instanceCount)
+    {
+        if (m_CurrentCommandBufferCompute != VK_NULL_HANDLE)
+        {
+            SubmitJobCompute(true);
+        }
+
+        auto cb = PrepareCommandBufferGraphics();
+
+        m_PipelineCache.Begin(cb);
+        m_PipelineCache.BindDescriptor(cb);
+
+        vkCmdDrawIndexed(cb, indexCount, instanceCount, indexOffset, vertexOffset, 0);
+        m_Statistics.drawCalls++;
+    }
+
+    void VulkanDriver::DrawIndexedIndirect(Handle<RHIBuffer> buffer, uint32_t offset)
+    {
+        // the indirect arguments are usually written by a compute pass
+        if (m_CurrentCommandBufferCompute != VK_NULL_HANDLE)
+        {
+            SubmitJobCompute(true);
+        }
+
+        auto cb = PrepareCommandBufferGraphics();
+
+        m_PipelineCache.Begin(cb);
+        m_PipelineCache.BindDescriptor(cb);
+
+        auto vkBuffer = GetResource<VulkanBuffer>(buffer)->GetBuffer();
+        vkCmdDrawIndexedIndirect(cb, vkBuffer, offset, 1, sizeof(DrawIndexedIndirectCommand));
+        m_Statistics.drawCalls++;
     }
 
     void VulkanDriver::Draw(uint32_t vertexCount, uint32_t vertexOffset)
@@ -374,6 +578,7 @@ namespace Zephyr
         m_PipelineCache.BindDescriptor(cb);
 
         vkCmdDraw(cb, vertexCount, 1, vertexOffset, 0);
+        m_Statistics.drawCalls++;
     }
 
     void VulkanDriver::Dispatch(uint32_t x, uint32_t y, uint32_t z)
@@ -389,6 +594,7 @@ namespace Zephyr
         m_PipelineCache.BindDescriptor(cb);
 
         vkCmdDispatch(cb, x, y, z);
+        m_Statistics.dispatches++;
     }
 
     void VulkanDriver::BeginRenderPass(Handle<RHIRenderTarget> rt)
@@ -605,6 +811,7 @@ namespace Zephyr
         submit.pCommandBuffers      = &m_CurrentCommandBufferCompute;
 
         VK_CHECK(vkQueueSubmit(m_Context.GetQueueCompute(), 1, &submit, VK_NULL_HANDLE), "Compute Queue Submit");
+        m_Statistics.submits++;
 
         m_CurrentCommandBufferCompute = VK_NULL_HANDLE;
         m_CurrentSemaphoreGraphics    = VK_NULL_HANDLE;
@@ -626,7 +833,6 @@ namespace Zephyr
 
         // we might use result from previous compute job on either vertex or fragment
         std::vector<VkPipelineStageFlags> flags;
-        auto                              sem1 = m_Swapchain->GetImageAcquireSemaphore();
         // this submit consumes the current compute semaphore
         VkSubmitInfo submit {};
         submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -634,7 +840,8 @@ namespace Zephyr
         std::vector<VkSemaphore> semsWait;
         std::vector<VkSemaphore> semsSignal;
 
-        if (present)
+        // offscreen images are neither acquired nor presented, the fence alone paces the frames
+        if (present && !m_Headless)
         {
             semsWait.push_back(m_Swapchain->GetImageAcquireSemaphore());
             flags.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
@@ -644,7 +851,8 @@ namespace Zephyr
         if (m_CurrentSemaphoreCompute != VK_NULL_HANDLE)
         {
             semsWait.push_back(m_CurrentSemaphoreCompute);
-            flags.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+            flags.push_back(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
         }
 
         if (synchronize)
@@ -665,6 +873,7 @@ namespace Zephyr
         VK_CHECK(
             vkQueueSubmit(m_Context.GetQueueGraphics(), 1, &submit, present ? m_Swapchain->GetFence() : VK_NULL_HANDLE),
             "Graphics Queue Submit");
+        m_Statistics.submits++;
 
         m_CurrentCommandBufferGraphics = VK_NULL_HANDLE;
         m_CurrentSemaphoreCompute      = VK_NULL_HANDLE;
@@ -730,6 +939,7 @@ namespace Zephyr
             begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
             VK_CHECK(vkBeginCommandBuffer(m_CurrentCommandBufferGraphics, &begin), "Begin Graphics Command Buffer");
+            BeginFrameQueries(m_CurrentCommandBufferGraphics, PipelineTypeBits::Graphics);
 
             return m_CurrentCommandBufferGraphics;
         }
@@ -754,6 +964,7 @@ namespace Zephyr
         begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
         VK_CHECK(vkBeginCommandBuffer(m_CurrentCommandBufferGraphics, &begin), "Begin Graphics Command Buffer");
+        BeginFrameQueries(m_CurrentCommandBufferGraphics, PipelineTypeBits::Graphics);
 
         return m_CurrentCommandBufferGraphics;
     }
@@ -778,6 +989,7 @@ namespace Zephyr
             begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
             VK_CHECK(vkBeginCommandBuffer(m_CurrentCommandBufferCompute, &begin), "Begin Graphics Command Buffer");
+            BeginFrameQueries(m_CurrentCommandBufferCompute, PipelineTypeBits::Compute);
 
             return m_CurrentCommandBufferCompute;
         }
@@ -802,6 +1014,7 @@ namespace Zephyr
         begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
         VK_CHECK(vkBeginCommandBuffer(m_CurrentCommandBufferCompute, &begin), "Begin Graphics Command Buffer");
+        BeginFrameQueries(m_CurrentCommandBufferCompute, PipelineTypeBits::Compute);
 
         return m_CurrentCommandBufferCompute;
     }
@@ -17,13 +17,17 @@ namespace Zephyr
     class VulkanDriver final : public Driver
     {
     public:
-        VulkanDriver(Window* window, bool headless = false);
+        explicit VulkanDriver(Window* window);
+        // headless, renders into offscreen images of the given size without a window or surface
+        VulkanDriver(uint32_t width, uint32_t height);
         ~VulkanDriver() override;
 
         inline Window*        GetWindow() { return m_Window; }
         inline VulkanContext* GetContext() { return &m_Context; }
         inline uint32_t       GetCurrentFrameIndex() { return m_CurrentFrameIndex; }
 
+        const DriverCapabilities& GetCapabilities() override { return m_Capabilities; }
+
         // resource allocation
         Handle<RHIBuffer>       CreateBuffer(const BufferDescription& desc) override;
         Handle<RHITexture>      CreateTexture(const TextureDescription& desc) override;
@@ -33,6 +37,15 @@ namespace Zephyr
                                                    const std::vector<Handle<RHITexture>>& attachments) override;
         Handle<RHITexture>      CreateTexture(const TextureDescription& desc, VkImage image, VkFormat format);
         Handle<RHITexture>      GetSwapchainImage() override;
+        float                   GetGpuFrameTime() override { return m_GpuTimings.frameTime; }
+        // profiling
+        void                   BeginGpuScope(const std::string& name, PipelineType pipeline) override;
+        void                   EndGpuScope(PipelineType pipeline) override;
+        void                   SetPipelineStatistics(bool enabled) override { m_PipelineStatistics = enabled; }
+        const GpuFrameTimings& GetGpuTimings() override { return m_GpuTimings; }
+        const DriverStatistics& GetStatistics() override { return m_FrameStatistics; }
+        // counters of the frame being recorded
+        inline DriverStatistics& GetRecordingStatistics() { return m_Statistics; }
         // resource update
         void UpdateBuffer(const BufferUpdateDescriptor& desc, Handle<RHIBuffer> handle) override;
         void         UpdateTexture(const TextureUpdateDescriptor& desc, Handle<RHITexture> handle) override;
@@ -50,6 +63,11 @@ namespace Zephyr
         void EndFrame() override;
         void WaitAndPresent() override;
         void DrawIndexed(uint32_t vertexOffset, uint32_t indexOffset, uint32_t indexCount) override;
+        void DrawIndexedInstanced(uint32_t vertexOffset,
+                                  uint32_t indexOffset,
+                                  uint32_t indexCount,
+                                  uint32_t instanceCount) override;
+        void DrawIndexedIndirect(Handle<RHIBuffer> buffer, uint32_t offset) override;
         void Draw(uint32_t vertexCount, uint32_t vertexOffset) override;
         void Dispatch(uint32_t x, uint32_t y, uint32_t z) override;
 
@@ -108,6 +126,12 @@ namespace Zephyr
         }
 
         inline VkFormat GetSurfaceFormat() { return m_Swapchain->GetSurfaceFormat(); }
+        inline bool     IsHeadless() const { return m_Headless; }
+        // offscreen images end the frame ready to be copied out
+        inline VkImageLayout GetPresentLayout() const
+        {
+            return m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        }
 
     public:
         // synchronize indicates if there are graphics job after us and we need to provide a semaphore to sync with it
@@ -121,6 +145,12 @@ namespace Zephyr
         void SetupSemaphoreCompute();
         void SetupSemaphoreGraphics();
 
+        void Init();
+
+        // the first command buffer of a frame resets the frame's queries and writes the begin timestamp
+        void BeginFrameQueries(VkCommandBuffer cb, PipelineType pipeline);
+        void ResolveFrameQueries();
+
     private:
         Window*          m_Window;
         VulkanSwapchain* m_Swapchain = nullptr;
@@ -131,6 +161,8 @@ namespace Zephyr
 
         uint32_t m_CurrentFrameIndex = 0;
 
+        DriverCapabilities m_Capabilities {};
+
         uint32_t                            m_HandleIdNext = 0;
         std::unordered_map<HandleID, void*> m_ResourceCache;
         // command buffer and synchronization management
@@ -164,5 +196,30 @@ namespace Zephyr
         std::string m_DebugMarkerName;
 
         bool m_Headless = false;
+
+        // gpu frame timing, results are read back when the frame slot comes around again
+        struct GpuScopeQuery
+        {
+            std::string name;
+            // begin timestamp, the end one follows it
+            uint32_t timestamp = 0;
+            // -1 without pipeline statistics
+            int32_t statistics = -1;
+        };
+
+        uint64_t                   m_CurrentFrame          = 0;
+        bool                       m_FrameTimestampBegun   = false;
+        bool                       m_FrameStatisticsBegun  = false;
+        bool                       m_GpuScopeOpen          = false;
+        bool                       m_PipelineStatistics    = false;
+        bool                       m_FrameTimestampPending[MAX_CONCURRENT_FRAME] {};
+        uint64_t                   m_FrameTimestampFrame[MAX_CONCURRENT_FRAME] {};
+        std::vector<GpuScopeQuery> m_GpuScopes[MAX_CONCURRENT_FRAME];
+        GpuFrameTimings            m_GpuTimings {};
+
+        DriverStatistics m_Statistics {};
+        DriverStatistics m_FrameStatistics {};
+        uint64_t         m_BufferMemory  = 0;
+        uint64_t         m_TextureMemory = 0;
     };
 } // namespace Zephyr
\ No newline at end of file
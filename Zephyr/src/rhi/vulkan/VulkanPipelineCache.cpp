@@ -6,6 +6,7 @@
 #include "VulkanShaderSet.h"
 #include "VulkanTexture.h"
 #include "VulkanUtil.h"
+#include "core/profile/Profiler.h"
 #include "rhi/RHIBuffer.h"
 
 namespace Zephyr
@@ -197,6 +198,7 @@ namespace Zephyr
 
     void VulkanPipelineCache::Begin(VkCommandBuffer cb)
     {
+        ZEPHYR_PROFILE_ZONE("VulkanPipelineCache::Begin");
         assert(m_BoundShader);
         // assert(m_Viewport.IsValid());
         // assert(m_Scissor.IsValid());
@@ -210,6 +212,7 @@ namespace Zephyr
                 return;
             }
             vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pip);
+            m_Driver->GetRecordingStatistics().pipelineBinds++;
             m_FreshPipelineCompute        = true;
             m_CurrentBoundPipelineCompute = pip;
         }
@@ -222,6 +225,7 @@ namespace Zephyr
                 return;
             }
             vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pip);
+            m_Driver->GetRecordingStatistics().pipelineBinds++;
             m_FreshPipelineGraphics        = true;
             m_CurrentBoundPipelineGraphics = pip;
         }
@@ -230,6 +234,7 @@ namespace Zephyr
     // TODO: this is currently not very readable nor very efficient. need refactor
     void VulkanPipelineCache::BindDescriptor(VkCommandBuffer cb)
     {
+        ZEPHYR_PROFILE_ZONE("VulkanPipelineCache::BindDescriptor");
         for (auto& pc : m_BoundPushConstantList)
         {
             uint32_t a = *(uint32_t*)((uint8_t*)pc.data + pc.offset);
@@ -313,6 +318,7 @@ namespace Zephyr
                                             &descriptor,
                                             offsets.size(),
                                             offsets.data());
+                    m_Driver->GetRecordingStatistics().descriptorSetBinds++;
                 }
 
                 // clear other bound
@@ -399,6 +405,8 @@ namespace Zephyr
                                         &descriptorSet,
                                         offsets.size(),
                                         offsets.data());
+                m_Driver->GetRecordingStatistics().descriptorSetBinds++;
+                m_Driver->GetRecordingStatistics().descriptorSetWrites++;
                 DescriptorState s {m_DescriptorSetCache.size(), true};
 
                 m_PipelineDescriptorCache[pipeline][set].insert({cacheKey, s});
@@ -516,7 +524,7 @@ namespace Zephyr
         depthStencil.sType             = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
         depthStencil.depthWriteEnable  = m_CurrentRasterState.depthWriteEnabled ? VK_TRUE : VK_FALSE;
         depthStencil.depthTestEnable   = m_CurrentRasterState.depthTestEnabled ? VK_TRUE : VK_FALSE;
-        depthStencil.depthCompareOp    = VK_COMPARE_OP_LESS_OR_EQUAL;
+        depthStencil.depthCompareOp    = VulkanUtil::GetCompareOp(m_CurrentRasterState.depthCompare);
         depthStencil.stencilTestEnable = VK_FALSE;
 
         // default alpha blending option
@@ -607,6 +615,7 @@ namespace Zephyr
         createInfo.stage.module = shaderModule[0];
         createInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
         createInfo.stage.pName  = "main";
+        createInfo.stage.pSpecializationInfo = m_BoundShader->GetShaderStages()[0].pSpecializationInfo;
         createInfo.layout       = m_BoundShader->GetPipelineLayout();
 
         VkPipeline pipelineCompute;
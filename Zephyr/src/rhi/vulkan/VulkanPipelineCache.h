@@ -69,7 +69,8 @@ namespace Zephyr
         size_t operator()(const PipelineCacheKey& t) const
         {
             return hash_fn_rt()(t.rtDescriptor) ^ std::hash<void*>()(t.shader) ^
-                   std::hash<uint32_t>()((uint32_t)t.raster.cull) ^ std::hash<uint32_t>()((uint32_t)t.raster.frontFace);
+                   std::hash<uint32_t>()((uint32_t)t.raster.cull) ^ std::hash<uint32_t>()((uint32_t)t.raster.frontFace) ^
+                   std::hash<uint32_t>()((uint32_t)t.raster.depthCompare);
         }
     };
 
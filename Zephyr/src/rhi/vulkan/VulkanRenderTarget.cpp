@@ -8,10 +8,19 @@ namespace Zephyr
     VulkanRenderTarget::VulkanRenderTarget(VulkanDriver*                          driver,
                                            const RenderTargetDescription&         desc,
                                            const std::vector<Handle<RHITexture>>& attachments) :
-        m_Descriptor(desc)
+        m_Descriptor(desc), m_PresentLayout(driver->GetPresentLayout())
     {
         auto& context = *driver->GetContext();
 
+        for (auto& color : desc.color)
+        {
+            m_LayerCount = std::max(m_LayerCount, color.layerCount);
+        }
+        if (desc.useDepthStencil)
+        {
+            m_LayerCount = std::max(m_LayerCount, desc.depthStencil.layerCount);
+        }
+
         // create render pass
         // note that we dont need subpass dependencies. we'll handle layout transition explicitly with
         // image memory barrier
@@ -31,9 +40,10 @@ namespace Zephyr
                 cd.storeOp        = color.save ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
                 cd.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
                 cd.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                cd.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-                cd.finalLayout =
-                    desc.present ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                // loaded attachments have to keep their contents
+                cd.initialLayout  = color.clear || desc.present ? VK_IMAGE_LAYOUT_UNDEFINED :
+                                                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                cd.finalLayout = desc.present ? m_PresentLayout : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
                 i++;
             }
@@ -85,6 +95,18 @@ namespace Zephyr
             createInfo.subpassCount    = 1;
             createInfo.pSubpasses      = &subpass;
 
+            // broadcast every draw to all layers, gl_ViewIndex tells the shader which one it is
+            uint32_t                        viewMask = (1u << m_LayerCount) - 1;
+            VkRenderPassMultiviewCreateInfo multiviewInfo {};
+            multiviewInfo.sType        = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+            multiviewInfo.subpassCount = 1;
+            multiviewInfo.pViewMasks   = &viewMask;
+            if (desc.multiview)
+            {
+                assert(driver->GetCapabilities().multiview);
+                createInfo.pNext = &multiviewInfo;
+            }
+
             VK_CHECK(vkCreateRenderPass(context.Device(), &createInfo, nullptr, &m_RenderPass), "Render Pass Creation");
         }
         // create framebuffer
@@ -98,7 +120,7 @@ namespace Zephyr
             {
                 ViewRange range {};
                 range.baseLayer  = color.layer;
-                range.layerCount = 1;
+                range.layerCount = color.layerCount;
                 range.baseLevel  = color.level;
                 range.levelCount = 1;
 
@@ -120,7 +142,7 @@ namespace Zephyr
             {
                 ViewRange range {};
                 range.baseLayer  = desc.depthStencil.layer;
-                range.layerCount = 1;
+                range.layerCount = desc.depthStencil.layerCount;
                 range.baseLevel  = desc.depthStencil.level;
                 range.levelCount = 1;
 
@@ -143,7 +165,8 @@ namespace Zephyr
             createInfo.pAttachments    = views.data();
             createInfo.width           = m_Width;
             createInfo.height          = m_Height;
-            createInfo.layers          = 1;
+            // multiview render passes require a single layer framebuffer
+            createInfo.layers = desc.multiview ? 1 : m_LayerCount;
 
             VK_CHECK(vkCreateFramebuffer(context.Device(), &createInfo, nullptr, &m_Framebuffer),
                      "Framebuffer Creation");
@@ -191,19 +214,24 @@ namespace Zephyr
 
         for (uint32_t i = 0; i < m_Descriptor.color.size(); i++)
         {
-            auto colorLayout =
-                m_Descriptor.present ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            auto colorLayout = m_Descriptor.present ? m_PresentLayout : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
             auto& color      = m_Colors[i];
             auto& descriptor = m_Descriptor.color[i];
-            color->SetLayout(0, descriptor.layer, colorLayout);
+            for (uint32_t layer = descriptor.layer; layer < descriptor.layer + descriptor.layerCount; layer++)
+            {
+                color->SetLayout(layer, descriptor.level, colorLayout);
+            }
         }
         if (m_Descriptor.useDepthStencil)
         {
             auto  dsLayout   = m_Descriptor.depthStencil.save ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL :
                                                                 VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
             auto& descriptor = m_Descriptor.depthStencil;
-            m_DepthStencil->SetLayout(0, descriptor.layer, dsLayout);
+            for (uint32_t layer = descriptor.layer; layer < descriptor.layer + descriptor.layerCount; layer++)
+            {
+                m_DepthStencil->SetLayout(layer, descriptor.level, dsLayout);
+            }
         }
 
         vkCmdEndRenderPass(cb);
@@ -30,8 +30,12 @@ namespace Zephyr
 
         uint32_t m_Width;
         uint32_t m_Height;
+        // layers written by a single draw, either through gl_Layer or the multiview mask
+        uint32_t m_LayerCount = 1;
 
         // whether we're rendering directly into the swapchain
         bool m_External = false;
+        // layout the swapchain image is left in, headless drivers keep it ready for a copy instead of presenting
+        VkImageLayout m_PresentLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     };
 } // namespace Zephyr
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace Zephyr
     VulkanShaderSet::VulkanShaderSet(VulkanDriver* driver, const ShaderSetDescription& desc) :
         m_PipelineType(desc.pipeline)
     {
+        SetupSpecialization(desc.specialization);
 
         if (desc.pipeline == PipelineTypeBits::Graphics)
         {
@@ -253,7 +254,30 @@ namespace Zephyr
         {
             assert(false);
         }
+
+        for (auto& stage : m_ShaderStages)
+        {
+            stage.pSpecializationInfo = m_SpecializationEntries.empty() ? nullptr : &m_SpecializationInfo;
+        }
+    }
+
+    void VulkanShaderSet::SetupSpecialization(const std::vector<uint32_t>& values)
+    {
+        m_SpecializationData = values;
+        m_SpecializationEntries.resize(values.size());
+        for (uint32_t i = 0; i < values.size(); i++)
+        {
+            m_SpecializationEntries[i].constantID = i;
+            m_SpecializationEntries[i].offset     = i * sizeof(uint32_t);
+            m_SpecializationEntries[i].size       = sizeof(uint32_t);
+        }
+
+        m_SpecializationInfo.mapEntryCount = m_SpecializationEntries.size();
+        m_SpecializationInfo.pMapEntries   = m_SpecializationEntries.data();
+        m_SpecializationInfo.dataSize      = m_SpecializationData.size() * sizeof(uint32_t);
+        m_SpecializationInfo.pData         = m_SpecializationData.data();
     }
+
     void VulkanShaderSet::SetupVertexLayout(VertexType type)
     {
         static VkVertexInputBindingDescription vibd {};
@@ -295,6 +319,25 @@ namespace Zephyr
         staticVertexInput.vertexAttributeDescriptionCount = sizeof(vabd) / sizeof(vabd[0]);
         staticVertexInput.pVertexAttributeDescriptions    = vabd;
 
+        // tightly packed positions, see GeometryPool
+        static VkVertexInputBindingDescription positionVibd {};
+        positionVibd.binding   = 0;
+        positionVibd.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        positionVibd.stride    = 12;
+
+        static VkVertexInputAttributeDescription positionVabd {};
+        positionVabd.binding  = 0;
+        positionVabd.format   = VK_FORMAT_R32G32B32_SFLOAT;
+        positionVabd.location = 0;
+        positionVabd.offset   = 0;
+
+        static VkPipelineVertexInputStateCreateInfo positionVertexInput {};
+        positionVertexInput.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        positionVertexInput.vertexBindingDescriptionCount   = 1;
+        positionVertexInput.pVertexBindingDescriptions      = &positionVibd;
+        positionVertexInput.vertexAttributeDescriptionCount = 1;
+        positionVertexInput.pVertexAttributeDescriptions    = &positionVabd;
+
         static VkPipelineVertexInputStateCreateInfo emptyVertexInput {};
         emptyVertexInput.sType                            = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         emptyVertexInput.vertexBindingDescriptionCount    = 0;
@@ -313,6 +356,9 @@ namespace Zephyr
             case VertexType::Dynamic:
                 assert(false);
                 break;
+            case VertexType::PositionOnly:
+                m_VertexState = positionVertexInput;
+                break;
             default:
                 assert(false);
         }
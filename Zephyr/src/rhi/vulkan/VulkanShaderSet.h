@@ -105,6 +105,7 @@ namespace Zephyr
         void Reflect(VulkanDriver* driver, const std::vector<uint32_t>& data, ShaderStage stage);
         void Compile(VulkanDriver* driver, const std::vector<std::vector<uint32_t>>& shaderCode);
         void SetupVertexLayout(VertexType type);
+        void SetupSpecialization(const std::vector<uint32_t>& values);
 
     private:
         PipelineType m_PipelineType;
@@ -119,6 +120,11 @@ namespace Zephyr
         std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStages;
         VkPipelineVertexInputStateCreateInfo           m_VertexState;
 
+        // referenced by every shader stage, so the owning shader set must not move
+        std::vector<uint32_t>                 m_SpecializationData;
+        std::vector<VkSpecializationMapEntry> m_SpecializationEntries;
+        VkSpecializationInfo                  m_SpecializationInfo {};
+
         friend class VulkanPipelineCache;
     };
 } // namespace Zephyr
\ No newline at end of file
@@ -13,6 +13,13 @@ namespace Zephyr
         // TODO: add window resize listener
     }
 
+    VulkanSwapchain::VulkanSwapchain(uint32_t width, uint32_t height, VulkanDriver* driver) :
+        m_Driver(driver), m_Window(nullptr), m_Context(driver->GetContext()), m_Offscreen(true)
+    {
+        CreateOffscreenImages(width, height);
+        CreateSyncObjects();
+    }
+
     void VulkanSwapchain::Shutdown()
     {
         for (auto& tex : m_SwapchainTextures)
@@ -26,8 +33,11 @@ namespace Zephyr
         VkDevice   device   = m_Context->m_Device;
         VkInstance instance = m_Context->m_Instance;
 
-        vkDestroySwapchainKHR(device, m_Swapchain, nullptr);
-        vkDestroySurfaceKHR(instance, m_Surface, nullptr);
+        if (!m_Offscreen)
+        {
+            vkDestroySwapchainKHR(device, m_Swapchain, nullptr);
+            vkDestroySurfaceKHR(instance, m_Surface, nullptr);
+        }
         for (auto& fence : m_Fences)
         {
             vkDestroyFence(device, fence, nullptr);
@@ -54,6 +64,14 @@ namespace Zephyr
 
         vkWaitForFences(device, 1, &m_Fences[m_CurrentFrameIndex], VK_TRUE, UINT64_MAX);
 
+        // offscreen images are never out of date, every frame in flight owns one
+        if (m_Offscreen)
+        {
+            m_CurrentImageIndex = m_CurrentFrameIndex;
+            vkResetFences(device, 1, &m_Fences[m_CurrentFrameIndex]);
+            return true;
+        }
+
         auto result = vkAcquireNextImageKHR(device,
                               m_Swapchain,
                               10000000000,
@@ -74,6 +92,10 @@ namespace Zephyr
 
     void VulkanSwapchain::WaitAndPresent()
     {
+        if (m_Offscreen)
+        {
+            return;
+        }
 
         //if (m_SwapchainStale)
         //{
@@ -228,6 +250,62 @@ namespace Zephyr
             i++;
         }
 
+        CreateSyncObjects();
+    }
+
+    void VulkanSwapchain::RecreateSwapchain()
+    {
+        VkSurfaceCapabilitiesKHR surfaceCapabilities;
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_Context->m_PhysicalDevice, m_Surface, &surfaceCapabilities);
+
+        uint32_t newWidth  = surfaceCapabilities.currentExtent.width;
+        uint32_t newHeight = surfaceCapabilities.currentExtent.height;
+
+        while (newWidth == 0 || newHeight == 0)
+        {
+            m_Window->GetFramebufferSize(&newWidth, &newHeight);
+            m_Window->WaitEvents();
+        }
+
+        if (newWidth == m_CurrentWidth && newHeight == m_CurrentHeight)
+        {
+            return;
+        }
+
+        m_CurrentWidth  = newWidth;
+        m_CurrentHeight = newHeight;
+
+        vkDeviceWaitIdle(m_Context->m_Device);
+        CreateSwapchain(newWidth, newHeight);
+    }
+
+    void VulkanSwapchain::CreateOffscreenImages(uint32_t width, uint32_t height)
+    {
+        m_CurrentWidth                 = width;
+        m_CurrentHeight                = height;
+        m_SelectedSurfaceFormat.format = VK_FORMAT_R8G8B8A8_UNORM;
+        m_ImageCount                   = MAX_CONCURRENT_FRAME;
+
+        m_SwapchainTextures.resize(m_ImageCount);
+        for (auto& texture : m_SwapchainTextures)
+        {
+            TextureDescription desc {};
+            desc.width     = width;
+            desc.height    = height;
+            desc.depth     = 1;
+            desc.format    = TextureFormat::RGBA8_UNORM;
+            desc.levels    = 1;
+            desc.pipelines = PipelineTypeBits::Graphics;
+            desc.sampler   = SamplerType::Sampler2D;
+            desc.samples   = 1;
+            desc.usage     = TextureUsageBits::ColorAttachment;
+
+            texture = m_Driver->CreateTexture(desc);
+        }
+    }
+
+    void VulkanSwapchain::CreateSyncObjects()
+    {
         // create sync object if necessary
         if (m_Fences.empty())
         {
@@ -256,30 +334,4 @@ namespace Zephyr
             }
         }
     }
-
-    void VulkanSwapchain::RecreateSwapchain()
-    {
-        VkSurfaceCapabilitiesKHR surfaceCapabilities;
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_Context->m_PhysicalDevice, m_Surface, &surfaceCapabilities);
-
-        uint32_t newWidth  = surfaceCapabilities.currentExtent.width;
-        uint32_t newHeight = surfaceCapabilities.currentExtent.height;
-
-        while (newWidth == 0 || newHeight == 0)
-        {
-            m_Window->GetFramebufferSize(&newWidth, &newHeight);
-            m_Window->WaitEvents();
-        }
-
-        if (newWidth == m_CurrentWidth && newHeight == m_CurrentHeight)
-        {
-            return;
-        }
-
-        m_CurrentWidth  = newWidth;
-        m_CurrentHeight = newHeight;
-
-        vkDeviceWaitIdle(m_Context->m_Device);
-        CreateSwapchain(newWidth, newHeight);
-    }
 } // namespace Zephyr
\ No newline at end of file
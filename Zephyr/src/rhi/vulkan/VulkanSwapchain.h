@@ -13,6 +13,8 @@ namespace Zephyr
     {
     public:
         VulkanSwapchain(Window* window, VulkanDriver* driver);
+        // headless, a ring of offscreen color images stands in for the presentable ones
+        VulkanSwapchain(uint32_t width, uint32_t height, VulkanDriver* driver);
         void Shutdown();
         ~VulkanSwapchain();
 
@@ -23,11 +25,9 @@ namespace Zephyr
         VkSemaphore        GetImageAcquireSemaphore() { return m_ImageAquireSemaphore[m_CurrentFrameIndex]; }
         VkSemaphore        GetPresentReadySemaphore() { return m_PresentReadySemaphore[m_CurrentFrameIndex]; }
         VkFence            GetFence() { return m_Fences[m_CurrentFrameIndex]; }
-        Handle<RHITexture> GetTexture() { 
-            123123;
-            
-            return m_SwapchainTextures[m_CurrentImageIndex]; }
+        Handle<RHITexture> GetTexture() { return m_SwapchainTextures[m_CurrentImageIndex]; }
         inline VkFormat    GetSurfaceFormat() const { return m_SelectedSurfaceFormat.format; }
+        inline bool        IsOffscreen() const { return m_Offscreen; }
 
     private:
         void CreateSurface();
@@ -35,12 +35,16 @@ namespace Zephyr
 
         void RecreateSwapchain();
 
+        void CreateOffscreenImages(uint32_t width, uint32_t height);
+        void CreateSyncObjects();
+
     private:
         VulkanDriver*  m_Driver;
         Window*        m_Window;
         VulkanContext* m_Context;
-        VkSurfaceKHR   m_Surface;
+        VkSurfaceKHR   m_Surface   = VK_NULL_HANDLE;
         VkSwapchainKHR m_Swapchain = VK_NULL_HANDLE;
+        bool           m_Offscreen = false;
 
         uint32_t m_CurrentFrameIndex = 0;
         uint32_t m_CurrentImageIndex = 0;
@@ -93,6 +93,7 @@ namespace Zephyr
             allocInfo.memoryTypeIndex = memoryTypeIndex;
 
             VK_CHECK(vkAllocateMemory(context.Device(), &allocInfo, nullptr, &m_Memory), "Texture Memory Allocation");
+            m_MemorySize = requiredSize;
 
             vkBindImageMemory(context.Device(), m_Image, m_Memory, 0);
         }
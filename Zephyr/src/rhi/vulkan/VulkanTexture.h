@@ -46,6 +46,8 @@ namespace Zephyr
         }
         inline TextureUsage GetUsage() const { return m_Description.usage; }
         inline VkImage      GetImage() const { return m_Image; }
+        // zero for external images
+        inline VkDeviceSize GetMemorySize() const { return m_MemorySize; }
 
     private:
         VkImageLayout GetLayout(uint32_t layer, uint32_t level);
@@ -61,6 +63,7 @@ namespace Zephyr
         TextureDescription m_Description;
         VkImage            m_Image  = VK_NULL_HANDLE;
         VkDeviceMemory     m_Memory = VK_NULL_HANDLE;
+        VkDeviceSize       m_MemorySize = 0;
 
         ViewRange   m_MainViewRange;
         VkImageView m_MainView = VK_NULL_HANDLE;
@@ -43,6 +43,10 @@ namespace Zephyr
             {
                 flag |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
             }
+            if (usage & BufferUsageBits::Indirect)
+            {
+                flag |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+            }
 
             return flag;
         }
@@ -100,6 +104,12 @@ namespace Zephyr
             {
                 case TextureFormat::R8_UNORM:
                     return VK_FORMAT_R8_UNORM;
+                case TextureFormat::R32_SFLOAT:
+                    return VK_FORMAT_R32_SFLOAT;
+                case TextureFormat::RG16_UNORM:
+                    return VK_FORMAT_R16G16_UNORM;
+                case TextureFormat::R11G11B10_UFLOAT:
+                    return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
                 case TextureFormat::RGBA8_UNORM:
                     return VK_FORMAT_R8G8B8A8_UNORM;
                 case TextureFormat::RGBA8_SNORM:
@@ -271,6 +281,31 @@ namespace Zephyr
             assert(false);
         }
 
+        static VkCompareOp GetCompareOp(CompareOp op)
+        {
+            switch (op)
+            {
+                case CompareOp::Never:
+                    return VK_COMPARE_OP_NEVER;
+                case CompareOp::Less:
+                    return VK_COMPARE_OP_LESS;
+                case CompareOp::Equal:
+                    return VK_COMPARE_OP_EQUAL;
+                case CompareOp::LessOrEqual:
+                    return VK_COMPARE_OP_LESS_OR_EQUAL;
+                case CompareOp::Greater:
+                    return VK_COMPARE_OP_GREATER;
+                case CompareOp::NotEqual:
+                    return VK_COMPARE_OP_NOT_EQUAL;
+                case CompareOp::GreaterOrEqual:
+                    return VK_COMPARE_OP_GREATER_OR_EQUAL;
+                case CompareOp::Always:
+                    return VK_COMPARE_OP_ALWAYS;
+            }
+
+            assert(false);
+        }
+
         static VkImageAspectFlags GetAspectMaskFromUsage(TextureUsage usage)
         {
             if (usage & TextureUsageBits::Storage)
@@ -0,0 +1,208 @@
+#include "Archetype.h"
+#include "scene/EntityRegistry.h"
+#include <algorithm>
+#include <new>
+
+namespace Zephyr
+{
+    namespace
+    {
+        uint32_t AlignUp(uint32_t offset, uint32_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+    } // namespace
+
+    Archetype::Archetype(const ComponentSignature& signature, EntityRegistry* registry, const ChangeClock* clock) :
+        m_Signature(signature), m_Registry(registry), m_Clock(clock)
+    {
+        std::fill(std::begin(m_Columns), std::end(m_Columns), -1);
+
+        uint32_t rowSize = sizeof(EntityHandle);
+        signature.ForEach([&](uint32_t id) {
+            auto& info = ComponentBase::GetInfo(id);
+            assert(info.alignment <= ARCHETYPE_CHUNK_ALIGNMENT);
+
+            m_Columns[id] = m_Components.size();
+            m_Components.push_back(&info);
+            rowSize += info.size + sizeof(uint32_t);
+        });
+        uint32_t chunkVersionSize = m_Components.size() * 2 * sizeof(uint32_t);
+
+        // padding between the arrays can push the layout over the chunk size, shrink until it fits.
+        // a row bigger than a chunk still gets a chunk of its own
+        m_Capacity = std::max((ARCHETYPE_CHUNK_SIZE - chunkVersionSize) / rowSize, 1u);
+        while (true)
+        {
+            uint32_t offset = sizeof(EntityHandle) * m_Capacity;
+            m_Offsets.clear();
+            for (auto info : m_Components)
+            {
+                offset = AlignUp(offset, info->alignment);
+                m_Offsets.push_back(offset);
+                offset += info->size * m_Capacity;
+            }
+            offset = AlignUp(offset, alignof(uint32_t));
+            m_VersionOffsets.clear();
+            for (uint32_t column = 0; column < m_Components.size(); column++)
+            {
+                m_VersionOffsets.push_back(offset);
+                offset += sizeof(uint32_t) * m_Capacity;
+            }
+            m_ChunkVersionOffset = offset;
+            offset += chunkVersionSize;
+
+            if (offset <= ARCHETYPE_CHUNK_SIZE || m_Capacity == 1)
+            {
+                m_ChunkBytes = std::max(offset, ARCHETYPE_CHUNK_SIZE);
+                break;
+            }
+            m_Capacity--;
+        }
+    }
+
+    Archetype::~Archetype()
+    {
+        for (auto& chunk : m_Chunks)
+        {
+            for (uint32_t column = 0; column < m_Components.size(); column++)
+            {
+                auto info = m_Components[column];
+                for (uint32_t row = 0; row < chunk.count; row++)
+                {
+                    info->destruct(chunk.data + m_Offsets[column] + row * info->size);
+                }
+            }
+            ::operator delete(chunk.data, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT));
+        }
+    }
+
+    void* Archetype::GetComponent(uint32_t column, uint32_t chunk, uint32_t row)
+    {
+        return m_Chunks[chunk].data + m_Offsets[column] + row * m_Components[column]->size;
+    }
+
+    void Archetype::Place(Entity* entity)
+    {
+        if (m_Chunks.empty() || m_Chunks.back().count == m_Capacity)
+        {
+            ArchetypeChunk chunk;
+            chunk.data = static_cast<uint8_t*>(::operator new(m_ChunkBytes, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT)));
+            std::fill_n(GetChunkVersions(chunk), m_Components.size() * 2, GetChangeVersion());
+            m_Chunks.push_back(chunk);
+        }
+
+        auto& chunk = m_Chunks.back();
+        reinterpret_cast<EntityHandle*>(chunk.data)[chunk.count] = entity->m_Handle;
+
+        entity->m_Archetype = this;
+        entity->m_Chunk     = m_Chunks.size() - 1;
+        entity->m_Row       = chunk.count;
+        entity->m_Signature = m_Signature;
+
+        chunk.count++;
+        m_EntityCount++;
+        m_Version++;
+        Touch(entity->m_Chunk, entity->m_Row);
+    }
+
+    void Archetype::Touch(uint32_t chunk, uint32_t row)
+    {
+        uint32_t version  = GetChangeVersion();
+        auto&    data     = m_Chunks[chunk];
+        auto     versions = GetChunkVersions(data);
+        for (uint32_t column = 0; column < m_Components.size(); column++)
+        {
+            GetRowVersions(column, data)[row] = version;
+            versions[column * 2]              = version;
+        }
+    }
+
+    void Archetype::Allocate(Entity* entity)
+    {
+        Place(entity);
+        for (uint32_t column = 0; column < m_Components.size(); column++)
+        {
+            m_Components[column]->construct(GetComponent(column, entity->m_Chunk, entity->m_Row));
+        }
+    }
+
+    void Archetype::Free(Entity* entity)
+    {
+        assert(entity->m_Archetype == this);
+        for (uint32_t column = 0; column < m_Components.size(); column++)
+        {
+            m_Components[column]->destruct(GetComponent(column, entity->m_Chunk, entity->m_Row));
+        }
+        RemoveRow(entity->m_Chunk, entity->m_Row);
+
+        entity->m_Archetype = nullptr;
+    }
+
+    void Archetype::MoveTo(Entity* entity, Archetype* dst)
+    {
+        assert(entity->m_Archetype == this && dst != this);
+        uint32_t chunk = entity->m_Chunk;
+        uint32_t row   = entity->m_Row;
+
+        dst->Place(entity);
+        for (uint32_t column = 0; column < m_Components.size(); column++)
+        {
+            auto info = m_Components[column];
+            auto src  = GetComponent(column, chunk, row);
+            if (dst->Has(info->id))
+            {
+                info->move(dst->GetComponent(dst->m_Columns[info->id], entity->m_Chunk, entity->m_Row), src);
+            }
+            else
+            {
+                info->destruct(src);
+            }
+        }
+        for (uint32_t column = 0; column < dst->m_Components.size(); column++)
+        {
+            auto info = dst->m_Components[column];
+            if (!Has(info->id))
+            {
+                info->construct(dst->GetComponent(column, entity->m_Chunk, entity->m_Row));
+            }
+        }
+
+        RemoveRow(chunk, row);
+    }
+
+    // the row's components are already destroyed or moved out
+    void Archetype::RemoveRow(uint32_t chunk, uint32_t row)
+    {
+        uint32_t lastChunk = m_Chunks.size() - 1;
+        uint32_t lastRow   = m_Chunks[lastChunk].count - 1;
+
+        if (chunk != lastChunk || row != lastRow)
+        {
+            auto  entities = reinterpret_cast<EntityHandle*>(m_Chunks[chunk].data);
+            auto  handle   = reinterpret_cast<EntityHandle*>(m_Chunks[lastChunk].data)[lastRow];
+            auto& last     = m_Registry->GetRecord(GetEntityIndex(handle));
+
+            for (uint32_t column = 0; column < m_Components.size(); column++)
+            {
+                m_Components[column]->move(GetComponent(column, chunk, row), GetComponent(column, lastChunk, lastRow));
+            }
+            entities[row] = handle;
+            last.m_Chunk  = chunk;
+            last.m_Row    = row;
+            Touch(chunk, row);
+        }
+
+        // the last chunk lost a row, readers comparing chunk versions have to notice
+        auto versions = GetChunkVersions(m_Chunks[lastChunk]);
+        for (uint32_t column = 0; column < m_Components.size(); column++)
+        {
+            versions[column * 2] = GetChangeVersion();
+        }
+
+        m_EntityCount--;
+        m_Version++;
+        if (--m_Chunks[lastChunk].count == 0)
+        {
+            ::operator delete(m_Chunks[lastChunk].data, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT));
+            m_Chunks.pop_back();
+        }
+    }
+} // namespace Zephyr
@@ -0,0 +1,227 @@
+#pragma once
+#include "pch.h"
+#include "scene/EntityHandle.h"
+#include "scene/component/Component.h"
+#include <atomic>
+
+namespace Zephyr
+{
+    class Entity;
+    class EntityRegistry;
+
+    // scene wide counter components are stamped with when they change, see Archetype::MarkChanged
+    using ChangeClock = std::atomic<uint32_t>;
+
+    inline constexpr uint32_t ARCHETYPE_CHUNK_SIZE      = 16 * 1024;
+    inline constexpr uint32_t ARCHETYPE_CHUNK_ALIGNMENT = 64;
+
+    struct ArchetypeChunk
+    {
+        uint8_t* data  = nullptr;
+        uint32_t count = 0;
+    };
+
+    class Archetype;
+
+    // the rows of one chunk, every column is a tightly packed array of count components
+    class ChunkView
+    {
+    public:
+        ChunkView(Archetype* archetype, ArchetypeChunk* chunk) : m_Archetype(archetype), m_Chunk(chunk) {}
+
+        inline uint32_t Count() const { return m_Chunk->count; }
+        inline const EntityHandle* GetEntities() const { return reinterpret_cast<EntityHandle*>(m_Chunk->data); }
+
+        // nullptr when the archetype doesn't have T. a non const T counts as a write of the whole column,
+        // ask for const T to only read
+        template<typename T>
+        T* Get() const;
+        // the same column without marking anything, for callers that mark the rows they write by hand
+        template<typename T>
+        T* GetColumn() const;
+
+        template<typename T>
+        bool Has() const;
+
+        // whether any row's T changed after version, rows added or removed count too
+        template<typename T>
+        bool IsChanged(uint32_t version) const;
+        template<typename T>
+        bool IsChanged(uint32_t row, uint32_t version) const;
+
+    private:
+        Archetype*      m_Archetype;
+        ArchetypeChunk* m_Chunk;
+    };
+
+    /*
+        storage of every entity with one exact component signature.
+        rows live in fixed size chunks, each chunk is laid out as an entity column followed by one array per
+        component. rows stay dense: removing one moves the last row of the archetype into the hole.
+        component pointers are only stable until the next structural change of the archetype.
+        every component column also keeps the change version of each row and two versions for the whole chunk:
+        the last change of any row, and the last write through ChunkView::Get that may have touched every row.
+    */
+    class Archetype final
+    {
+    public:
+        // rows moved by a removal get their records updated through registry, changes are stamped from clock
+        Archetype(const ComponentSignature& signature, EntityRegistry* registry, const ChangeClock* clock);
+        ~Archetype();
+
+        // appends a row of default constructed components
+        void Allocate(Entity* entity);
+        // destroys the entity's components
+        void Free(Entity* entity);
+        // moves the entity into dst, components dst lacks are destroyed and new ones default constructed
+        void MoveTo(Entity* entity, Archetype* dst);
+
+        inline const ComponentSignature& GetSignature() const { return m_Signature; }
+        inline uint32_t GetEntityCount() const { return m_EntityCount; }
+        // bumped whenever a row is added or removed, component pointers stay valid while it doesn't change
+        inline uint32_t GetVersion() const { return m_Version; }
+        inline uint32_t GetChunkCapacity() const { return m_Capacity; }
+        inline uint32_t GetChunkCount() const { return m_Chunks.size(); }
+        inline ChunkView GetChunk(uint32_t chunk) { return {this, &m_Chunks[chunk]}; }
+
+        inline bool Has(uint32_t id) const { return m_Columns[id] >= 0; }
+
+        inline void* GetColumn(uint32_t id, const ArchetypeChunk& chunk) const
+        {
+            int32_t column = m_Columns[id];
+            return column < 0 ? nullptr : chunk.data + m_Offsets[column];
+        }
+
+        // nullptr when the archetype doesn't have the component, marks the row changed
+        void* Get(uint32_t id, uint32_t chunk, uint32_t row)
+        {
+            auto column = static_cast<uint8_t*>(GetColumn(id, m_Chunks[chunk]));
+            if (column == nullptr)
+            {
+                return nullptr;
+            }
+            MarkChanged(id, chunk, row);
+            return column + row * ComponentBase::GetInfo(id).size;
+        }
+
+        // a non const T marks the row changed
+        template<typename T>
+        T* Get(uint32_t chunk, uint32_t row)
+        {
+            auto column = static_cast<T*>(GetColumn(T::ID, m_Chunks[chunk]));
+            if (column == nullptr)
+            {
+                return nullptr;
+            }
+            if constexpr (!std::is_const_v<T>)
+            {
+                MarkChanged(T::ID, chunk, row);
+            }
+            return column + row;
+        }
+
+        inline uint32_t GetChangeVersion() const { return m_Clock ? m_Clock->load(std::memory_order_relaxed) : 0; }
+
+        // for writes that bypass Get, like cached component pointers
+        void MarkChanged(uint32_t id, uint32_t chunk, uint32_t row)
+        {
+            uint32_t version                   = GetChangeVersion();
+            auto&    data                      = m_Chunks[chunk];
+            uint32_t column                    = m_Columns[id];
+            GetRowVersions(column, data)[row]  = version;
+            GetChunkVersions(data)[column * 2] = version;
+        }
+        // every row of the column in chunk
+        void MarkChanged(uint32_t id, const ArchetypeChunk& chunk)
+        {
+            uint32_t version                        = GetChangeVersion();
+            uint32_t column                         = m_Columns[id];
+            GetChunkVersions(chunk)[column * 2]     = version;
+            GetChunkVersions(chunk)[column * 2 + 1] = version;
+        }
+
+        bool IsChanged(uint32_t id, const ArchetypeChunk& chunk, uint32_t version) const
+        {
+            return GetChunkVersions(chunk)[m_Columns[id] * 2] > version;
+        }
+        bool IsChanged(uint32_t id, const ArchetypeChunk& chunk, uint32_t row, uint32_t version) const
+        {
+            uint32_t column = m_Columns[id];
+            return GetChunkVersions(chunk)[column * 2 + 1] > version || GetRowVersions(column, chunk)[row] > version;
+        }
+
+    private:
+        void* GetComponent(uint32_t column, uint32_t chunk, uint32_t row);
+        void  Place(Entity* entity);
+        void  RemoveRow(uint32_t chunk, uint32_t row);
+        // marks every column of the row changed
+        void  Touch(uint32_t chunk, uint32_t row);
+
+        inline uint32_t* GetRowVersions(uint32_t column, const ArchetypeChunk& chunk) const
+        {
+            return reinterpret_cast<uint32_t*>(chunk.data + m_VersionOffsets[column]);
+        }
+        inline uint32_t* GetChunkVersions(const ArchetypeChunk& chunk) const
+        {
+            return reinterpret_cast<uint32_t*>(chunk.data + m_ChunkVersionOffset);
+        }
+
+    private:
+        ComponentSignature m_Signature;
+        EntityRegistry*    m_Registry;
+        // sorted by component id
+        std::vector<const ComponentInfo*> m_Components;
+        // chunk offset of every component array, the entity column sits at 0
+        std::vector<uint32_t> m_Offsets;
+        // chunk offset of every column's row versions, then two chunk versions per column
+        std::vector<uint32_t> m_VersionOffsets;
+        uint32_t              m_ChunkVersionOffset = 0;
+        const ChangeClock*    m_Clock;
+        // column of every component id, -1 when absent
+        int16_t               m_Columns[MAX_COMPONENT_TYPES];
+        uint32_t              m_Capacity   = 0;
+        uint32_t              m_ChunkBytes = ARCHETYPE_CHUNK_SIZE;
+
+        std::vector<ArchetypeChunk> m_Chunks;
+        uint32_t                    m_EntityCount = 0;
+        uint32_t                    m_Version     = 0;
+    };
+
+    template<typename T>
+    T* ChunkView::Get() const
+    {
+        auto column = static_cast<T*>(m_Archetype->GetColumn(T::ID, *m_Chunk));
+        if constexpr (!std::is_const_v<T>)
+        {
+            if (column)
+            {
+                m_Archetype->MarkChanged(T::ID, *m_Chunk);
+            }
+        }
+        return column;
+    }
+
+    template<typename T>
+    T* ChunkView::GetColumn() const
+    {
+        return static_cast<T*>(m_Archetype->GetColumn(T::ID, *m_Chunk));
+    }
+
+    template<typename T>
+    bool ChunkView::IsChanged(uint32_t version) const
+    {
+        return m_Archetype->Has(T::ID) && m_Archetype->IsChanged(T::ID, *m_Chunk, version);
+    }
+
+    template<typename T>
+    bool ChunkView::IsChanged(uint32_t row, uint32_t version) const
+    {
+        return m_Archetype->Has(T::ID) && m_Archetype->IsChanged(T::ID, *m_Chunk, row, version);
+    }
+
+    template<typename T>
+    bool ChunkView::Has() const
+    {
+        return m_Archetype->Has(T::ID);
+    }
+} // namespace Zephyr
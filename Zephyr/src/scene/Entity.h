@@ -1,60 +1,27 @@
 #pragma once
 #include "pch.h"
+#include "scene/Archetype.h"
+#include "scene/EntityHandle.h"
 #include "scene/component/Component.h"
 
 namespace Zephyr
 {
+    /*
+        where an entity's components live. the components themselves are stored in the archetype of the
+        entity's component mask, structural changes go through the scene
+    */
     class Entity final
     {
     public:
         Entity() = default;
-        ~Entity()
-        {
-            for (auto& component : m_Components)
-            {
-                delete component.second;
-            }
-        }
-
-        template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
-        T* AddComponent()
-        {
-            if (HasComponent<T>())
-            {
-                return static_cast<T*>(m_Components.at(T::ID));
-            }
-
-            T* component = new T();
-
-            m_Components.insert({T::ID, component});
-
-            m_ComponentMask |= T::ID;
-
-            return component;
-        }
 
         template<typename T>
-        void RemoveComponent()
+        bool HasComponent() const
         {
-            if (!HasComponent<T>())
-            {
-                return;
-            }
-
-            T* component = m_Components.at(T::ID);
-            delete component;
-            m_Components.erase(T::ID);
-            m_ComponentMask &= ~T::ID;
-        }
-
-        template<typename T>
-        bool HasComponent()
-        {
-            auto a      = T::ID;
-            auto result = m_ComponentMask & a;
-            return (m_ComponentMask & T::ID) != 0;
+            return m_Signature.Test(T::ID);
         }
 
+        // only valid until the next structural change of this entity's archetype
         template<typename T>
         T* GetComponent()
         {
@@ -62,16 +29,18 @@ namespace Zephyr
             {
                 return nullptr;
             }
-            return static_cast<T*>(m_Components.at(T::ID));
+            return m_Archetype->Get<T>(m_Chunk, m_Row);
         }
 
-        inline const std::unordered_map<uint32_t, ComponentBase*>& GetComponents() const { return m_Components; }
-
     public:
-        std::unordered_map<uint32_t, ComponentBase*> m_Components;
-        // note that for small component size, iterating through vector is actually faster than hashmap lookup
-        // need more tests after whole engine is finished
-        // std::vector<std::pair<uint32_t, ComponentBase*>> m_Components;
-        uint32_t m_ComponentMask = 0;
+        Archetype*         m_Archetype = nullptr;
+        uint32_t           m_Chunk     = 0;
+        uint32_t           m_Row       = 0;
+        ComponentSignature m_Signature;
+
+        // handle of the live entity using this record
+        EntityHandle m_Handle = InvalidEntityHandle;
+        // slot in the registry's dense array, next free record while the record is unused
+        uint32_t m_Dense = 0;
     };
-} // namespace Zephyr
\ No newline at end of file
+} // namespace Zephyr
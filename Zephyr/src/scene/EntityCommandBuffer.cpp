@@ -0,0 +1,68 @@
+#include "EntityCommandBuffer.h"
+#include "scene/Archetype.h"
+#include <new>
+
+namespace Zephyr
+{
+    EntityCommandBuffer::~EntityCommandBuffer()
+    {
+        // values of commands that were never played back
+        for (auto& command : m_Commands)
+        {
+            if (command.value)
+            {
+                ComponentBase::GetInfo(command.component).destruct(command.value);
+            }
+        }
+        for (auto& block : m_Blocks)
+        {
+            ::operator delete(block.data, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT));
+        }
+    }
+
+    EntityHandle EntityCommandBuffer::CreateEntity()
+    {
+        // index 0 would make the first one InvalidEntityHandle
+        auto handle = MakeEntityHandle(++m_CreateCount, 0);
+        m_Commands.push_back({EntityCommandType::Create, InvalidComponentId, handle, nullptr});
+
+        return handle;
+    }
+
+    void EntityCommandBuffer::RemoveEntity(EntityHandle entity)
+    {
+        m_Commands.push_back({EntityCommandType::Destroy, InvalidComponentId, entity, nullptr});
+    }
+
+    void EntityCommandBuffer::Reset()
+    {
+        m_Commands.clear();
+        m_CreateCount = 0;
+        m_Block       = 0;
+        m_Offset      = 0;
+    }
+
+    void* EntityCommandBuffer::Allocate(uint32_t size, uint32_t alignment)
+    {
+        assert(alignment <= ARCHETYPE_CHUNK_ALIGNMENT);
+        m_Offset = (m_Offset + alignment - 1) / alignment * alignment;
+
+        // move on to the next block that fits, blocks too small for this value are skipped until the next Reset
+        while (m_Block < m_Blocks.size() && m_Offset + size > m_Blocks[m_Block].size)
+        {
+            m_Block++;
+            m_Offset = 0;
+        }
+        if (m_Block == m_Blocks.size())
+        {
+            uint32_t blockSize = std::max(size, ENTITY_COMMAND_BLOCK_SIZE);
+            auto     data = static_cast<uint8_t*>(::operator new(blockSize, std::align_val_t(ARCHETYPE_CHUNK_ALIGNMENT)));
+            m_Blocks.push_back({data, blockSize});
+            m_Offset = 0;
+        }
+
+        void* storage = m_Blocks[m_Block].data + m_Offset;
+        m_Offset += size;
+        return storage;
+    }
+} // namespace Zephyr
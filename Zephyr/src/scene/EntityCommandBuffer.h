@@ -0,0 +1,99 @@
+#pragma once
+#include "pch.h"
+#include "core/macro.h"
+#include "scene/EntityHandle.h"
+#include "scene/component/Component.h"
+#include <new>
+
+namespace Zephyr
+{
+    // bytes of component values one block of a command buffer holds, bigger values get a block of their own
+    inline constexpr uint32_t ENTITY_COMMAND_BLOCK_SIZE = 16 * 1024;
+
+    enum class EntityCommandType : uint8_t
+    {
+        Create,
+        Destroy,
+        AddComponent,
+        RemoveComponent,
+    };
+
+    struct EntityCommand
+    {
+        EntityCommandType type;
+        uint32_t          component;
+        EntityHandle      entity;
+        // recorded component value, nullptr to default construct it
+        void*             value;
+    };
+
+    /*
+        structural changes recorded by one thread, applied later by Scene::PlaybackCommands.
+        CreateEntity hands out a pending handle that later commands of the same buffer can target, it only
+        becomes a real entity during playback. recorded values are moved into the components on playback
+    */
+    class EntityCommandBuffer final
+    {
+    public:
+        EntityCommandBuffer() = default;
+        ~EntityCommandBuffer();
+
+        DISALE_COPY_AND_MOVE(EntityCommandBuffer);
+
+        // pending handles have generation 0, which no live entity ever has
+        static inline bool IsPending(EntityHandle handle)
+        {
+            return handle != InvalidEntityHandle && GetEntityGeneration(handle) == 0;
+        }
+
+        EntityHandle CreateEntity();
+        void         RemoveEntity(EntityHandle entity);
+
+        // default constructed on playback, an existing component is kept as it is
+        template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
+        void AddComponent(EntityHandle entity)
+        {
+            m_Commands.push_back({EntityCommandType::AddComponent, T::ID, entity, nullptr});
+        }
+
+        // replaces the component if the entity already has one
+        template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
+        void AddComponent(EntityHandle entity, T value)
+        {
+            void* storage = Allocate(sizeof(T), alignof(T));
+            new (storage) T(std::move(value));
+            m_Commands.push_back({EntityCommandType::AddComponent, T::ID, entity, storage});
+        }
+
+        template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
+        void RemoveComponent(EntityHandle entity)
+        {
+            m_Commands.push_back({EntityCommandType::RemoveComponent, T::ID, entity, nullptr});
+        }
+
+        inline bool                              Empty() const { return m_Commands.empty(); }
+        inline const std::vector<EntityCommand>& GetCommands() const { return m_Commands; }
+
+        // forgets every command, the values have to be moved out or destroyed by the caller already
+        void Reset();
+
+    private:
+        void* Allocate(uint32_t size, uint32_t alignment);
+
+    private:
+        struct Block
+        {
+            uint8_t* data;
+            uint32_t size;
+        };
+
+        std::vector<EntityCommand> m_Commands;
+        // pending handles handed out since the last Reset
+        uint32_t                   m_CreateCount = 0;
+
+        // kept across Reset, m_Block is the one being filled
+        std::vector<Block> m_Blocks;
+        uint32_t           m_Block  = 0;
+        uint32_t           m_Offset = 0;
+    };
+} // namespace Zephyr
@@ -0,0 +1,17 @@
+#pragma once
+#include "pch.h"
+
+namespace Zephyr
+{
+    // low 32 bits index the scene's entity records, high 32 bits are the generation of that record.
+    // generations start at 1 so no live entity is ever InvalidEntityHandle
+    using EntityHandle                                = uint64_t;
+    inline constexpr EntityHandle InvalidEntityHandle = 0;
+
+    inline EntityHandle MakeEntityHandle(uint32_t index, uint32_t generation)
+    {
+        return (EntityHandle)generation << 32 | index;
+    }
+    inline uint32_t GetEntityIndex(EntityHandle handle) { return (uint32_t)handle; }
+    inline uint32_t GetEntityGeneration(EntityHandle handle) { return (uint32_t)(handle >> 32); }
+} // namespace Zephyr
@@ -0,0 +1,58 @@
+#include "EntityRegistry.h"
+
+namespace Zephyr
+{
+    EntityHandle EntityRegistry::Create()
+    {
+        uint32_t index;
+        uint32_t generation;
+        if (m_FreeHead != NoFreeRecord)
+        {
+            index      = m_FreeHead;
+            m_FreeHead = m_Records[index].m_Dense;
+            // the generation of a freed record was kept in its old handle
+            generation = GetEntityGeneration(m_Records[index].m_Handle) + 1;
+            // 0 is reserved for InvalidEntityHandle
+            generation = generation == 0 ? 1 : generation;
+        }
+        else
+        {
+            index      = m_Records.size();
+            generation = 1;
+            m_Records.emplace_back();
+        }
+
+        auto& record    = m_Records[index];
+        record          = Entity();
+        record.m_Handle = MakeEntityHandle(index, generation);
+        record.m_Dense  = m_Dense.size();
+        m_Dense.push_back(record.m_Handle);
+
+        return record.m_Handle;
+    }
+
+    bool EntityRegistry::Destroy(EntityHandle handle)
+    {
+        if (!IsAlive(handle))
+        {
+            return false;
+        }
+
+        uint32_t index  = GetEntityIndex(handle);
+        auto&    record = m_Records[index];
+
+        // swap-remove from the dense array
+        EntityHandle last                       = m_Dense.back();
+        m_Dense[record.m_Dense]                 = last;
+        m_Records[GetEntityIndex(last)].m_Dense = record.m_Dense;
+        m_Dense.pop_back();
+
+        // an index no handle to this record can have, IsAlive fails while the generation is kept for Create
+        record.m_Handle    = MakeEntityHandle(~0u, GetEntityGeneration(handle));
+        record.m_Archetype = nullptr;
+        record.m_Dense     = m_FreeHead;
+        m_FreeHead         = index;
+
+        return true;
+    }
+} // namespace Zephyr
@@ -0,0 +1,41 @@
+#pragma once
+#include "pch.h"
+#include "scene/Entity.h"
+
+namespace Zephyr
+{
+    /*
+        sparse set of entities.
+        records are indexed by the handle's index and never move while the entity lives, the dense array packs
+        the handles of live entities and is swap-removed. freed records form a list and are reused with a bumped
+        generation, so a handle to a removed entity never resolves to the entity that took its record.
+        create, destroy and lookup are all O(1).
+    */
+    class EntityRegistry final
+    {
+    public:
+        EntityHandle Create();
+        // false for handles that are stale or were never created
+        bool Destroy(EntityHandle handle);
+
+        inline bool IsAlive(EntityHandle handle) const
+        {
+            uint32_t index = GetEntityIndex(handle);
+            return index < m_Records.size() && m_Records[index].m_Handle == handle && handle != InvalidEntityHandle;
+        }
+
+        // nullptr for stale handles, the pointer is only valid until the next Create
+        inline Entity* Get(EntityHandle handle) { return IsAlive(handle) ? &m_Records[GetEntityIndex(handle)] : nullptr; }
+        inline Entity& GetRecord(uint32_t index) { return m_Records[index]; }
+
+        inline uint32_t                         GetCount() const { return m_Dense.size(); }
+        inline const std::vector<EntityHandle>& GetEntities() const { return m_Dense; }
+
+    private:
+        static constexpr uint32_t NoFreeRecord = ~0u;
+
+        std::vector<Entity>       m_Records;
+        std::vector<EntityHandle> m_Dense;
+        uint32_t                  m_FreeHead = NoFreeRecord;
+    };
+} // namespace Zephyr
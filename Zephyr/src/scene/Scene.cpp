@@ -0,0 +1,353 @@
+#include "Scene.h"
+#include "engine/Engine.h"
+
+namespace Zephyr
+{
+    Scene::Scene(Engine* engine, const std::string& name) :
+        m_Engine(engine), m_DebugName(name), m_JobSystem(engine ? engine->GetJobSystem() : nullptr)
+    {
+        ResizeCommandBuffers();
+    }
+
+    Scene::~Scene()
+    {
+        // destroys the components of every entity
+        for (auto& archetype : m_Archetypes)
+        {
+            delete archetype;
+        }
+
+        for (auto& system : m_Systems)
+        {
+            delete system.second;
+        }
+    }
+
+    EntityHandle Scene::CreateEntity()
+    {
+        auto handle = m_Entities.Create();
+        GetArchetype(ComponentSignature())->Allocate(m_Entities.Get(handle));
+
+        return handle;
+    }
+
+    bool Scene::RemoveEntity(EntityHandle handle)
+    {
+        Entity* entity = m_Entities.Get(handle);
+        if (entity == nullptr)
+        {
+            return false;
+        }
+
+        entity->m_Archetype->Free(entity);
+        return m_Entities.Destroy(handle);
+    }
+
+    void Scene::SetJobSystem(JobSystem* jobs)
+    {
+        // pending handles are tied to the buffer that made them
+        PlaybackCommands();
+
+        m_JobSystem = jobs;
+        ResizeCommandBuffers();
+        for (auto system : m_SystemOrder)
+        {
+            system->SetJobSystem(jobs);
+        }
+        for (auto& query : m_Queries)
+        {
+            query.second.result.SetJobSystem(jobs);
+        }
+    }
+
+    EntityCommandBuffer& Scene::GetCommandBuffer()
+    {
+        uint32_t thread = m_JobSystem ? m_JobSystem->GetThreadIndex() : 0;
+        return *m_CommandBuffers[thread];
+    }
+
+    void Scene::PlaybackCommands()
+    {
+        bool empty = true;
+        for (auto& buffer : m_CommandBuffers)
+        {
+            empty = empty && buffer->Empty();
+        }
+        if (empty)
+        {
+            return;
+        }
+        ZEPHYR_PROFILE_ZONE("Scene::PlaybackCommands");
+
+        constexpr uint32_t NoValue = ~0u;
+
+        // what every touched entity ends up as
+        struct Target
+        {
+            ComponentSignature signature;
+            // removed at some point, a component that is still there at the end was added back and starts over
+            ComponentSignature reset;
+            EntityHandle       handle;
+            bool               created;
+            bool               destroyed;
+            // head of the list of recorded values
+            uint32_t           values;
+        };
+        struct Value
+        {
+            uint32_t component;
+            void*    value;
+            uint32_t next;
+        };
+
+        std::vector<Target>                        targets;
+        std::vector<Value>                         values;
+        std::unordered_map<EntityHandle, uint32_t> existing;
+        std::vector<uint32_t>                      pending;
+
+        // destroys the recorded values of component, or of every component for InvalidComponentId
+        auto drop = [&](Target& target, uint32_t component) {
+            for (uint32_t value = target.values; value != NoValue; value = values[value].next)
+            {
+                auto& record = values[value];
+                if (record.value && (component == InvalidComponentId || record.component == component))
+                {
+                    ComponentBase::GetInfo(record.component).destruct(record.value);
+                    record.value = nullptr;
+                }
+            }
+        };
+
+        // fold the commands, in buffer order and recording order within a buffer
+        for (auto& buffer : m_CommandBuffers)
+        {
+            pending.clear();
+            for (auto& command : buffer->GetCommands())
+            {
+                if (command.type == EntityCommandType::Create)
+                {
+                    pending.push_back(targets.size());
+                    targets.push_back(
+                        {ComponentSignature(), ComponentSignature(), InvalidEntityHandle, true, false, NoValue});
+                    continue;
+                }
+
+                uint32_t index;
+                if (EntityCommandBuffer::IsPending(command.entity))
+                {
+                    index = GetEntityIndex(command.entity) - 1;
+                    assert(index < pending.size() && "pending handle used in another command buffer");
+                    index = pending[index];
+                }
+                else
+                {
+                    Entity* entity = m_Entities.Get(command.entity);
+                    if (entity == nullptr)
+                    {
+                        // stale handle, nothing to apply
+                        if (command.value)
+                        {
+                            ComponentBase::GetInfo(command.component).destruct(command.value);
+                        }
+                        continue;
+                    }
+
+                    auto iter = existing.insert({command.entity, (uint32_t)targets.size()});
+                    if (iter.second)
+                    {
+                        targets.push_back(
+                            {entity->m_Signature, ComponentSignature(), command.entity, false, false, NoValue});
+                    }
+                    index = iter.first->second;
+                }
+
+                auto& target = targets[index];
+                if (target.destroyed)
+                {
+                    if (command.value)
+                    {
+                        ComponentBase::GetInfo(command.component).destruct(command.value);
+                    }
+                    continue;
+                }
+
+                switch (command.type)
+                {
+                    case EntityCommandType::Destroy:
+                        target.destroyed = true;
+                        drop(target, InvalidComponentId);
+                        break;
+                    case EntityCommandType::AddComponent:
+                        target.signature.Set(command.component);
+                        if (command.value)
+                        {
+                            drop(target, command.component);
+                            values.push_back({command.component, command.value, target.values});
+                            target.values = values.size() - 1;
+                        }
+                        break;
+                    case EntityCommandType::RemoveComponent:
+                        target.signature.Reset(command.component);
+                        target.reset.Set(command.component);
+                        drop(target, command.component);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        // removals first, their rows are free before anything moves in
+        for (auto& target : targets)
+        {
+            if (target.destroyed && !target.created)
+            {
+                RemoveEntity(target.handle);
+            }
+        }
+
+        // group the rest by archetype in first seen order, so every archetype is filled in one go and every
+        // entity moves at most once
+        std::vector<Archetype*>                  archetypes;
+        std::unordered_map<Archetype*, uint32_t> groups;
+        std::vector<uint32_t>                    groupOf(targets.size(), NoValue);
+        std::vector<uint32_t>                    groupStart;
+        for (uint32_t i = 0; i < targets.size(); i++)
+        {
+            auto& target = targets[i];
+            if (target.destroyed)
+            {
+                continue;
+            }
+
+            auto archetype = GetArchetype(target.signature);
+            auto iter      = groups.insert({archetype, (uint32_t)archetypes.size()});
+            if (iter.second)
+            {
+                archetypes.push_back(archetype);
+                groupStart.push_back(0);
+            }
+            groupOf[i] = iter.first->second;
+            groupStart[groupOf[i]]++;
+        }
+
+        uint32_t offset = 0;
+        for (auto& start : groupStart)
+        {
+            uint32_t count = start;
+            start          = offset;
+            offset += count;
+        }
+        std::vector<uint32_t> order(offset);
+        for (uint32_t i = 0; i < targets.size(); i++)
+        {
+            if (groupOf[i] != NoValue)
+            {
+                order[groupStart[groupOf[i]]++] = i;
+            }
+        }
+
+        for (auto i : order)
+        {
+            auto&   target    = targets[i];
+            auto    archetype = archetypes[groupOf[i]];
+            Entity* entity;
+            if (target.created)
+            {
+                target.handle = m_Entities.Create();
+                entity        = m_Entities.Get(target.handle);
+                archetype->Allocate(entity);
+            }
+            else
+            {
+                entity = m_Entities.Get(target.handle);
+                if (entity->m_Archetype != archetype)
+                {
+                    entity->m_Archetype->MoveTo(entity, archetype);
+                }
+
+                // removing and adding back leaves a default constructed component, like it does right away
+                target.reset.ForEach([&](uint32_t component) {
+                    if (target.signature.Test(component))
+                    {
+                        auto& info = ComponentBase::GetInfo(component);
+                        void* dst  = archetype->Get(component, entity->m_Chunk, entity->m_Row);
+                        info.destruct(dst);
+                        info.construct(dst);
+                    }
+                });
+            }
+
+            for (uint32_t value = target.values; value != NoValue; value = values[value].next)
+            {
+                auto& record = values[value];
+                if (record.value)
+                {
+                    auto& info = ComponentBase::GetInfo(record.component);
+                    void* dst  = archetype->Get(record.component, entity->m_Chunk, entity->m_Row);
+                    info.destruct(dst);
+                    info.move(dst, record.value);
+                }
+            }
+        }
+
+        // the values still live in the buffers' blocks until everything above is applied
+        for (auto& buffer : m_CommandBuffers)
+        {
+            buffer->Reset();
+        }
+    }
+
+    void Scene::ResizeCommandBuffers()
+    {
+        uint32_t count = m_JobSystem ? m_JobSystem->GetWorkerCount() + 1 : 1;
+        while (m_CommandBuffers.size() < count)
+        {
+            m_CommandBuffers.emplace_back(new EntityCommandBuffer());
+        }
+        m_CommandBuffers.resize(count);
+    }
+
+    Archetype* Scene::GetArchetype(const ComponentSignature& signature)
+    {
+        auto iter = m_ArchetypeMap.find(signature);
+        if (iter != m_ArchetypeMap.end())
+        {
+            return iter->second;
+        }
+
+        auto archetype = new Archetype(signature, &m_Entities, &m_ChangeClock);
+        m_ArchetypeMap.insert({signature, archetype});
+        m_Archetypes.push_back(archetype);
+        m_Signatures.push_back(signature);
+
+        // a new archetype is the only thing that can change which archetypes a query matches
+        for (auto& system : m_Systems)
+        {
+            system.second->Match(archetype);
+        }
+        for (auto& query : m_Queries)
+        {
+            if (query.second.query.Qualify(signature))
+            {
+                query.second.result.Add(archetype);
+            }
+        }
+
+        return archetype;
+    }
+
+    Scene::CachedQuery Scene::CreateQuery(const Query& query) const
+    {
+        CachedQuery cached {query, {}};
+        cached.result.SetJobSystem(m_JobSystem);
+
+        std::vector<uint32_t> matches;
+        query.Filter(m_Signatures.data(), m_Signatures.size(), matches);
+        for (auto index : matches)
+        {
+            cached.result.Add(m_Archetypes[index]);
+        }
+        return cached;
+    }
+} // namespace Zephyr
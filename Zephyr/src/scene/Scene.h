@@ -1,26 +1,31 @@
 #pragma once
 #include "Entity.h"
+#include "EntityCommandBuffer.h"
+#include "EntityRegistry.h"
 #include "component/Component.h"
+#include "core/profile/Profiler.h"
 #include "pch.h"
 #include "system/System.h"
+#include "system/SystemScheduler.h"
 
 namespace Zephyr
 {
     class Engine;
 
-    using EntityHandle                                = intptr_t;
     using SystemHandle                                = intptr_t;
     inline constexpr SystemHandle InvalidSystemHandle = 0;
 
     /*
         A scene contains a list of entities and systems.
-        Entities contains their components(data only)
-        Systems use query to look for proper entity and update entity based on their components
+        Entities with the same component mask share an archetype, which stores their components in packed arrays
+        Systems use query to look for matching archetypes and update their components chunk by chunk
+        Systems that don't touch the same components tick in parallel, structural changes are not safe during Tick.
+        Systems record them in a command buffer instead, they are played back once every system ticked
     */
     class Scene final
     {
     public:
-        Scene(Engine* engine, const std::string& name) : m_Engine(engine), m_DebugName(name) {}
+        Scene(Engine* engine, const std::string& name);
         void Shutdown()
         {
             for (auto& system : m_Systems)
@@ -28,65 +33,95 @@ namespace Zephyr
                 system.second->Shutdown();
             }
         }
-        ~Scene()
+        ~Scene();
+
+        EntityHandle CreateEntity();
+        // false when the handle is stale, the index of a removed entity is reused with a new generation
+        bool         RemoveEntity(EntityHandle handle);
+        inline bool  IsAlive(EntityHandle handle) const { return m_Entities.IsAlive(handle); }
+
+        inline uint32_t                         GetEntityCount() const { return m_Entities.GetCount(); }
+        inline const std::vector<EntityHandle>& GetEntities() const { return m_Entities.GetEntities(); }
+
+        // moves the entity to the archetype with T, pointers to its other components are invalidated
+        template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
+        T* AddComponent(EntityHandle handle)
         {
-            for (auto& entity : m_Entities)
+            Entity* entity = m_Entities.Get(handle);
+            assert(entity && "stale entity handle");
+            if (entity == nullptr)
             {
-                delete entity;
+                return nullptr;
             }
 
-            for (auto& system : m_Systems)
+            if (!entity->HasComponent<T>())
             {
-                delete system.second;
+                entity->m_Archetype->MoveTo(entity, GetArchetype(entity->m_Signature.With(T::ID)));
             }
-        }
 
-        EntityHandle CreateEntity()
-        {
-            auto entity = new Entity();
-            m_Entities.push_back(entity);
-
-            return (EntityHandle)entity;
+            return entity->GetComponent<T>();
         }
 
         template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
-        T* AddComponent(EntityHandle handle)
+        void RemoveComponent(EntityHandle handle)
         {
-            Entity* entity = reinterpret_cast<Entity*>(handle);
-
-            return entity->AddComponent<T>();
+            Entity* entity = m_Entities.Get(handle);
+            if (entity && entity->HasComponent<T>())
+            {
+                entity->m_Archetype->MoveTo(entity, GetArchetype(entity->m_Signature.Without(T::ID)));
+            }
         }
 
         template<typename T, typename = std::enable_if_t<std::is_base_of_v<ComponentBase, T>>>
         T* GetComponent(EntityHandle handle)
         {
-            Entity* entity = reinterpret_cast<Entity*>(handle);
+            // nullptr for stale handles too
+            Entity* entity = m_Entities.Get(handle);
 
-            return entity->GetComponent<T>();
+            return entity ? entity->GetComponent<T>() : nullptr;
         }
 
-        bool RemoveEntity(EntityHandle handle)
+        // fn(T&...) for every entity that has all of T, outside of any system.
+        // the matching archetypes are cached per component set and kept up to date as archetypes get created
+        template<typename... T, typename F>
+        void Each(F&& fn)
         {
-            Entity* entity = reinterpret_cast<Entity*>(handle);
-            for (auto iter = m_Entities.begin(); iter != m_Entities.end(); iter++)
+            ComponentSignature signature {T::ID...};
+            auto               iter = m_Queries.find(signature);
+            if (iter == m_Queries.end())
             {
-                if (*iter == entity)
-                {
-                    delete entity;
-                    m_Entities.erase(iter);
-                    return true;
-                }
+                iter = m_Queries.insert({signature, CreateQuery(Query({T::ID...}, {}, {}))}).first;
             }
-
-            return false;
+            iter->second.result.Each<T...>(std::forward<F>(fn));
         }
 
+        inline const std::vector<Archetype*>& GetArchetypes() const { return m_Archetypes; }
+
+        // scenes created by the engine use the engine's job system, nullptr ticks every system on the calling thread
+        void SetJobSystem(JobSystem* jobs);
+
+        // the version changes are stamped with. a system run advances it and keeps the version before, so
+        // everything changed afterwards compares newer. 32 bits wrap after 4 billion system runs
+        inline uint32_t GetChangeVersion() const { return m_ChangeClock.load(std::memory_order_relaxed); }
+        inline uint32_t AdvanceChangeVersion() { return m_ChangeClock.fetch_add(1, std::memory_order_relaxed); }
+
+        // the calling thread's buffer, only the thread ticking the scene and job system workers may record.
+        // pending handles it creates are only understood by the same buffer
+        EntityCommandBuffer& GetCommandBuffer();
+        // applies and clears every recorded command. all changes to one entity are folded into a single move,
+        // then entities are moved archetype by archetype. Tick calls it after the systems ran
+        void                 PlaybackCommands();
+
         template<typename T, typename = std::enable_if_t<std::is_base_of_v<SystemBase, T>>>
         SystemHandle AddSystem()
         {
             auto system = new T(m_Engine);
+            system->SetScene(this);
+            system->MatchAll(m_Archetypes, m_Signatures);
+            system->SetJobSystem(m_JobSystem);
 
             m_Systems.insert({T::ID, system});
+            m_SystemOrder.push_back(system);
 
             return (SystemHandle)system;
         }
@@ -136,16 +171,44 @@ namespace Zephyr
 
         void Tick(float delta)
         {
-            for (auto& system : m_Systems)
-            {
-                system.second->Tick(delta, m_Entities);
-            }
+            ZEPHYR_PROFILE_ZONE("Scene::Tick");
+            m_Scheduler.Run(delta, m_SystemOrder, m_JobSystem);
+            PlaybackCommands();
         }
 
     private:
-        Engine*                                   m_Engine;
-        std::string                               m_DebugName;
-        std::vector<Entity*>                      m_Entities;
-        std::unordered_map<uint32_t, SystemBase*> m_Systems;
+        struct CachedQuery
+        {
+            Query       query;
+            QueryResult result;
+        };
+
+        Archetype*  GetArchetype(const ComponentSignature& signature);
+        // one buffer per job system thread
+        void        ResizeCommandBuffers();
+        CachedQuery CreateQuery(const Query& query) const;
+
+        template<typename V>
+        using SignatureMap = std::unordered_map<ComponentSignature, V, ComponentSignatureHash>;
+
+    private:
+        Engine*                                           m_Engine;
+        std::string                                       m_DebugName;
+        EntityRegistry                                    m_Entities;
+        std::unordered_map<uint32_t, SystemBase*>         m_Systems;
+        // the order systems were added in, conflicting systems tick in this order
+        std::vector<SystemBase*>                          m_SystemOrder;
+        SystemScheduler                                   m_Scheduler;
+        JobSystem*                                        m_JobSystem = nullptr;
+        // starts above 0 so everything is newer than a system that never ran
+        ChangeClock                                       m_ChangeClock {1};
+        std::vector<std::unique_ptr<EntityCommandBuffer>> m_CommandBuffers;
+        // in creation order, so iteration order doesn't depend on the hash map
+        std::vector<Archetype*>                           m_Archetypes;
+        // signature of every archetype packed together for batched query matching
+        std::vector<ComponentSignature>                   m_Signatures;
+        SignatureMap<Archetype*>                          m_ArchetypeMap;
+        // Each() queries by their all signature
+        SignatureMap<CachedQuery>                         m_Queries;
     };
 } // namespace Zephyr
\ No newline at end of file
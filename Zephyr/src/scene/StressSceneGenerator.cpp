@@ -0,0 +1,118 @@
+#include "StressSceneGenerator.h"
+#include "core/math/Random.h"
+#include "engine/Engine.h"
+#include "resource/MaterialInstance.h"
+#include "resource/Mesh.h"
+#include "resource/preset/geometry/BoxMesh.h"
+#include "scene/Scene.h"
+#include "scene/component/MeshComponent.h"
+#include "scene/component/MotionComponent.h"
+#include "scene/component/PointLightComponent.h"
+#include "scene/component/TransformComponent.h"
+#include "scene/system/preset/MotionSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Zephyr
+{
+    namespace
+    {
+        glm::vec3 Place(Random& random, const StressSceneDescription& desc, uint32_t index, uint32_t count)
+        {
+            // the random draws happen for both layouts so switching layout keeps everything else identical
+            glm::vec3 p = {random.Range(-desc.extent, desc.extent),
+                           random.Range(0.f, desc.height),
+                           random.Range(-desc.extent, desc.extent)};
+
+            if (desc.layout == StressLayout::Grid)
+            {
+                uint32_t side    = (uint32_t)std::ceil(std::sqrt((float)count));
+                float    spacing = side > 1 ? 2.f * desc.extent / (side - 1) : 0.f;
+                p.x              = (index % side) * spacing - desc.extent;
+                p.z              = (index / side) * spacing - desc.extent;
+                p.y              = 0.f;
+            }
+            return p;
+        }
+
+        void AddMotion(Random& random, Scene* scene, EntityHandle entity, const glm::mat4& rest)
+        {
+            auto motion    = scene->AddComponent<MotionComponent>(entity);
+            motion->rest   = rest;
+            motion->radius = random.Range(1.f, 5.f);
+            motion->speed  = random.Range(.5f, 2.f);
+            motion->phase  = random.Range(0.f, 6.2831853f);
+        }
+    } // namespace
+
+    void StressSceneGenerator::Generate(Engine* engine, Scene* scene, const StressSceneDescription& desc)
+    {
+        Random random(desc.seed);
+        bool   moving = false;
+
+        std::vector<Mesh*> meshes(std::max(desc.meshVariants, 1u));
+        for (auto& mesh : meshes)
+        {
+            BoxMeshDescription box {random.Range(desc.minSize, desc.maxSize),
+                                    random.Range(desc.minSize, desc.maxSize),
+                                    random.Range(desc.minSize, desc.maxSize)};
+            mesh = engine->CreateMesh(box);
+
+            auto material = engine->CreateMaterial(ShadingModel::Lit);
+            material->SetConstantBlock<glm::vec3>("albedo", {random.Float(), random.Float(), random.Float()});
+            material->SetConstantBlock<glm::vec3>("emission", {0., 0., 0.});
+            material->SetConstantBlock<float>("metalness", random.Float());
+            material->SetConstantBlock<float>("roughness", random.Range(.1f, 1.f));
+            mesh->SetMaterials({material});
+        }
+
+        for (uint32_t i = 0; i < desc.entityCount; i++)
+        {
+            auto  mesh     = meshes[random.Index(meshes.size())];
+            auto  position = Place(random, desc, i, desc.entityCount);
+            float yaw      = random.Range(0.f, 6.2831853f);
+            auto  rest     = glm::rotate(glm::translate(glm::mat4(1.), position), yaw, glm::vec3(0.f, 1.f, 0.f));
+            bool  isMoving = random.Float() < desc.movingFraction;
+
+            // each add moves the entity to another archetype, fill a component before adding the next
+            auto entity          = scene->CreateEntity();
+            auto meshCmp         = scene->AddComponent<MeshComponent>(entity);
+            meshCmp->mesh        = mesh;
+            auto transform       = scene->AddComponent<TransformComponent>(entity);
+            transform->transform = rest;
+
+            if (isMoving)
+            {
+                AddMotion(random, scene, entity, rest);
+                moving = true;
+            }
+        }
+
+        for (uint32_t i = 0; i < desc.pointLightCount; i++)
+        {
+            auto position = Place(random, desc, i, desc.pointLightCount);
+            // lights hover above the boxes in the grid layout
+            position.y    = desc.layout == StressLayout::Grid ? desc.maxSize + 1.f : position.y;
+            bool isMoving = random.Float() < desc.movingFraction;
+
+            auto entity           = scene->CreateEntity();
+            auto light            = scene->AddComponent<PointLightComponent>(entity);
+            light->light.position = position;
+            light->light.radius   = random.Range(desc.minLightRadius, desc.maxLightRadius);
+            light->light.radiance = {random.Range(.2f, 1.f), random.Range(.2f, 1.f), random.Range(.2f, 1.f)};
+            light->light.falloff  = .001f;
+
+            if (isMoving)
+            {
+                AddMotion(random, scene, entity, glm::translate(glm::mat4(1.), position));
+                moving = true;
+            }
+        }
+
+        if (moving)
+        {
+            scene->AddSystem<MotionSystem>();
+        }
+    }
+} // namespace Zephyr
@@ -0,0 +1,49 @@
+#pragma once
+#include "pch.h"
+
+namespace Zephyr
+{
+    class Engine;
+    class Scene;
+
+    enum class StressLayout
+    {
+        Grid,
+        Random
+    };
+
+    struct StressSceneDescription
+    {
+        uint64_t     seed   = 1;
+        StressLayout layout = StressLayout::Grid;
+
+        uint32_t entityCount = 1000;
+        // entities and lights are spread over [-extent, extent] in x and z
+        float extent = 100.f;
+        float height = 20.f;
+
+        // distinct box meshes, each with its own material
+        uint32_t meshVariants = 8;
+        float    minSize      = .5f;
+        float    maxSize      = 3.f;
+
+        uint32_t pointLightCount = 0;
+        float    minLightRadius  = 4.f;
+        float    maxLightRadius  = 12.f;
+
+        // share of entities and lights that get a MotionComponent
+        float movingFraction = 0.f;
+    };
+
+    /*
+        fills a scene with box entities and point lights from seeded parameters through the regular
+        scene api. every random number comes from one seeded Random in a fixed order, the same description
+        gives the same scene on every machine. adds a MotionSystem when anything moves, camera, sun and
+        render system are left to the caller.
+    */
+    class StressSceneGenerator final
+    {
+    public:
+        static void Generate(Engine* engine, Scene* scene, const StressSceneDescription& desc);
+    };
+} // namespace Zephyr
@@ -1,35 +1,80 @@
 #pragma once
 #include "pch.h"
+#include "scene/component/ComponentSignature.h"
 
 namespace Zephyr
 {
-    using ComponentId = uint64_t;
-    constexpr uint32_t InvalidComponentId = 0;
+    using ComponentId = uint32_t;
+    constexpr uint32_t InvalidComponentId = ~0u;
+
+    // what an archetype needs to store a component type without knowing it
+    struct ComponentInfo
+    {
+        // bit of the component in a ComponentSignature
+        uint32_t id;
+        uint32_t size;
+        uint32_t alignment;
+
+        void (*construct)(void* dst);
+        void (*destruct)(void* dst);
+        // move constructs dst from src and destroys src
+        void (*move)(void* dst, void* src);
+    };
 
     struct ComponentBase
     {
-        static uint32_t NextComponentId() {
-            static uint32_t nextId = 1;
+        static const ComponentInfo& GetInfo(uint32_t id) { return GetRegistry()[id]; }
 
-            uint32_t id = nextId;
+        // idempotent, safe to reach from any static initializer
+        template<typename T>
+        static const ComponentInfo& Register()
+        {
+            static const ComponentInfo& info = Register(sizeof(T),
+                                                        alignof(T),
+                                                        [](void* dst) { new (dst) T(); },
+                                                        [](void* dst) { static_cast<T*>(dst)->~T(); },
+                                                        [](void* dst, void* src) {
+                                                            new (dst) T(std::move(*static_cast<T*>(src)));
+                                                            static_cast<T*>(src)->~T();
+                                                        });
+            return info;
+        }
 
-            nextId <<= 1;
+    private:
+        static ComponentInfo* GetRegistry()
+        {
+            static ComponentInfo registry[MAX_COMPONENT_TYPES] {};
+            return registry;
+        }
+
+        static const ComponentInfo& Register(uint32_t size,
+                                             uint32_t alignment,
+                                             void (*construct)(void*),
+                                             void (*destruct)(void*),
+                                             void (*move)(void*, void*))
+        {
+            static uint32_t count = 0;
+            assert(count < MAX_COMPONENT_TYPES && "out of component ids, raise ZEPHYR_MAX_COMPONENT_TYPES");
 
-            return id;
+            auto& info = GetRegistry()[count];
+            info       = {count, size, alignment, construct, destruct, move};
+            count++;
+
+            return info;
         }
     };
 
     template<typename T>
     struct Component : ComponentBase
     {
+        // dense index handed out in registration order
         static const uint32_t ID;
 
         inline const uint32_t GetID() { return Component<T>::ID; }
     };
 
     template<typename T>
-    const uint32_t Component<T>::ID(ComponentBase::NextComponentId());
-
+    const uint32_t Component<T>::ID(ComponentBase::Register<T>().id);
 
     #define COMPONENT(c) struct c: Component<c>
-}
\ No newline at end of file
+}
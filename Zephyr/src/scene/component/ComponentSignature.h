@@ -0,0 +1,236 @@
+#pragma once
+#include "pch.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define ZEPHYR_SIGNATURE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZEPHYR_SIGNATURE_SSE2
+#include <emmintrin.h>
+#endif
+
+// number of component types a scene can hold, a multiple of 256 so signatures are whole avx2 registers
+#ifndef ZEPHYR_MAX_COMPONENT_TYPES
+#define ZEPHYR_MAX_COMPONENT_TYPES 256
+#endif
+
+namespace Zephyr
+{
+    inline constexpr uint32_t MAX_COMPONENT_TYPES = ZEPHYR_MAX_COMPONENT_TYPES;
+    static_assert(MAX_COMPONENT_TYPES % 256 == 0, "ZEPHYR_MAX_COMPONENT_TYPES has to be a multiple of 256");
+
+    inline uint32_t LowestBit(uint64_t bits)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    /*
+        one bit per component type, bit i is the component with ID i.
+        the set operations run 256 bits at a time with avx2, 128 with sse2 and 64 otherwise.
+    */
+    struct alignas(32) ComponentSignature
+    {
+        static constexpr uint32_t WordCount = MAX_COMPONENT_TYPES / 64;
+
+        uint64_t words[WordCount] {};
+
+        ComponentSignature() = default;
+        ComponentSignature(std::initializer_list<uint32_t> ids)
+        {
+            for (auto id : ids)
+            {
+                Set(id);
+            }
+        }
+
+        inline void Set(uint32_t id) { words[id / 64] |= 1ull << (id % 64); }
+        inline void Reset(uint32_t id) { words[id / 64] &= ~(1ull << (id % 64)); }
+        inline bool Test(uint32_t id) const { return (words[id / 64] >> (id % 64)) & 1; }
+
+        inline ComponentSignature With(uint32_t id) const
+        {
+            auto signature = *this;
+            signature.Set(id);
+            return signature;
+        }
+        inline ComponentSignature Without(uint32_t id) const
+        {
+            auto signature = *this;
+            signature.Reset(id);
+            return signature;
+        }
+
+        ComponentSignature& operator|=(const ComponentSignature& other)
+        {
+            for (uint32_t i = 0; i < WordCount; i++)
+            {
+                words[i] |= other.words[i];
+            }
+            return *this;
+        }
+
+        bool operator==(const ComponentSignature& other) const
+        {
+            return std::equal(std::begin(words), std::end(words), std::begin(other.words));
+        }
+        bool operator!=(const ComponentSignature& other) const { return !(*this == other); }
+
+        // every bit of other is set in this
+        bool Contains(const ComponentSignature& other) const;
+        bool Intersects(const ComponentSignature& other) const;
+        bool Empty() const;
+
+        // fn(id) for every set bit, in ascending order
+        template<typename F>
+        void ForEach(F&& fn) const
+        {
+            for (uint32_t word = 0; word < WordCount; word++)
+            {
+                for (uint64_t bits = words[word]; bits != 0; bits &= bits - 1)
+                {
+                    fn(word * 64 + LowestBit(bits));
+                }
+            }
+        }
+    };
+
+#if defined(ZEPHYR_SIGNATURE_AVX2)
+    inline bool ComponentSignature::Contains(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 4)
+        {
+            auto a = _mm256_load_si256(reinterpret_cast<const __m256i*>(words + i));
+            auto b = _mm256_load_si256(reinterpret_cast<const __m256i*>(other.words + i));
+            // testc: (~a & b) == 0
+            if (!_mm256_testc_si256(a, b))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline bool ComponentSignature::Intersects(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 4)
+        {
+            auto a = _mm256_load_si256(reinterpret_cast<const __m256i*>(words + i));
+            auto b = _mm256_load_si256(reinterpret_cast<const __m256i*>(other.words + i));
+            if (!_mm256_testz_si256(a, b))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    inline bool ComponentSignature::Empty() const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 4)
+        {
+            auto a = _mm256_load_si256(reinterpret_cast<const __m256i*>(words + i));
+            if (!_mm256_testz_si256(a, a))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+#elif defined(ZEPHYR_SIGNATURE_SSE2)
+    inline bool ComponentSignature::Contains(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 2)
+        {
+            auto a = _mm_load_si128(reinterpret_cast<const __m128i*>(words + i));
+            auto b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.words + i));
+            // sse2 has no ptest, compare (a & b) against b
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, b), b)) != 0xFFFF)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline bool ComponentSignature::Intersects(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 2)
+        {
+            auto a = _mm_load_si128(reinterpret_cast<const __m128i*>(words + i));
+            auto b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.words + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, b), _mm_setzero_si128())) != 0xFFFF)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    inline bool ComponentSignature::Empty() const
+    {
+        for (uint32_t i = 0; i < WordCount; i += 2)
+        {
+            auto a = _mm_load_si128(reinterpret_cast<const __m128i*>(words + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) != 0xFFFF)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+#else
+    inline bool ComponentSignature::Contains(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i++)
+        {
+            if ((words[i] & other.words[i]) != other.words[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline bool ComponentSignature::Intersects(const ComponentSignature& other) const
+    {
+        for (uint32_t i = 0; i < WordCount; i++)
+        {
+            if ((words[i] & other.words[i]) != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    inline bool ComponentSignature::Empty() const
+    {
+        for (uint32_t i = 0; i < WordCount; i++)
+        {
+            if (words[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+
+    struct ComponentSignatureHash
+    {
+        size_t operator()(const ComponentSignature& signature) const
+        {
+            // fnv-1a over the words
+            uint64_t hash = 14695981039346656037ull;
+            for (auto word : signature.words)
+            {
+                hash = (hash ^ word) * 1099511628211ull;
+            }
+            return hash;
+        }
+    };
+} // namespace Zephyr
@@ -0,0 +1,22 @@
+#pragma once
+#include "Component.h"
+#include "scene/EntityHandle.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Zephyr
+{
+    /*
+        transform relative to parent, TransformSystem composes it into the entity's TransformComponent.
+        set dirty after changing any field. parent needs a LocalTransformComponent too, an entity whose parent
+        is removed becomes a root
+    */
+    COMPONENT(LocalTransformComponent)
+    {
+        glm::vec3    position {0.f};
+        glm::quat    rotation {1.f, 0.f, 0.f, 0.f};
+        glm::vec3    scale {1.f};
+        EntityHandle parent = InvalidEntityHandle;
+        bool         dirty  = true;
+    };
+} // namespace Zephyr
@@ -0,0 +1,16 @@
+#pragma once
+#include "Component.h"
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    // circles around the rest transform in the xz plane, a point light on the entity moves along
+    COMPONENT(MotionComponent)
+    {
+        glm::mat4 rest;
+        float     radius;
+        // radians per second
+        float speed;
+        float phase;
+    };
+} // namespace Zephyr
@@ -9,33 +9,66 @@ namespace Zephyr
     {
         for (auto& id : all)
         {
-            m_AllMask |= id;
+            m_AllSignature.Set(id);
         }
 
         for (auto& id : some)
         {
-            m_SomeMask |= id;
+            m_SomeSignature.Set(id);
         }
 
         for (auto& id : exclude)
         {
-            m_ExcludeMask |= id;
+            m_ExcludeSignature.Set(id);
         }
-    }
 
-    bool Query::Qualify(const Entity* const entity) {
-        return CheckExclude(entity) && CheckSome(entity) && CheckAll(entity);
-    }
-    bool Query::CheckExclude(const Entity* const entity)
-    {
-        return m_ExcludeMask == 0 || (entity->m_ComponentMask & m_ExcludeMask) == 0;
+        m_HasSome = !some.empty();
     }
-    bool Query::CheckSome(const Entity* const entity)
+
+    bool Query::Qualify(const Entity* const entity) const { return Qualify(entity->m_Signature); }
+
+#if defined(ZEPHYR_SIGNATURE_AVX2)
+    void Query::Filter(const ComponentSignature* signatures, uint32_t count, std::vector<uint32_t>& matches) const
     {
-        return m_SomeMask == 0 || (entity->m_ComponentMask & m_SomeMask) != 0;
+        if constexpr (ComponentSignature::WordCount != 4)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (Qualify(signatures[i]))
+                {
+                    matches.push_back(i);
+                }
+            }
+        }
+        else
+        {
+            // one register per signature, three tests per archetype
+            auto all     = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_AllSignature.words));
+            auto some    = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_SomeSignature.words));
+            auto exclude = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_ExcludeSignature.words));
+            int  noSome  = !m_HasSome;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                auto signature = _mm256_load_si256(reinterpret_cast<const __m256i*>(signatures[i].words));
+                int  match     = _mm256_testc_si256(signature, all) & _mm256_testz_si256(signature, exclude) &
+                            (noSome | !_mm256_testz_si256(signature, some));
+                if (match)
+                {
+                    matches.push_back(i);
+                }
+            }
+        }
     }
-    bool Query::CheckAll(const Entity* const entity) 
+#else
+    void Query::Filter(const ComponentSignature* signatures, uint32_t count, std::vector<uint32_t>& matches) const
     {
-        return (entity->m_ComponentMask & m_AllMask) == m_AllMask;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (Qualify(signatures[i]))
+            {
+                matches.push_back(i);
+            }
+        }
     }
-} // namespace Zephyr
\ No newline at end of file
+#endif
+} // namespace Zephyr
@@ -1,8 +1,13 @@
 #pragma once
 #include "pch.h"
+#include "core/job/JobSystem.h"
+#include "scene/Archetype.h"
 
 namespace Zephyr
 {
+    // chunks handed to one job by the parallel iteration
+    inline constexpr uint32_t QUERY_CHUNKS_PER_JOB = 4;
+
     class Entity;
     class Query final
     {
@@ -11,19 +16,144 @@ namespace Zephyr
         Query(const std::vector<uint32_t>& all, const std::vector<uint32_t>& some, const std::vector<uint32_t>& exclude);
         ~Query() = default;
 
-        bool Qualify(const Entity* const entity);
+        bool Qualify(const Entity* const entity) const;
+        inline bool Qualify(const ComponentSignature& signature) const
+        {
+            return CheckExclude(signature) && CheckSome(signature) && CheckAll(signature);
+        }
+
+        // appends the index of every matching signature to matches. the query's signatures are loaded once
+        // and stay in registers for the whole array
+        void Filter(const ComponentSignature* signatures, uint32_t count, std::vector<uint32_t>& matches) const;
 
         private:
-        bool CheckAll(const Entity* const entity);
-        bool CheckSome(const Entity* const entity);
-        bool CheckExclude(const Entity* const entity);
+        inline bool CheckAll(const ComponentSignature& signature) const { return signature.Contains(m_AllSignature); }
+        inline bool CheckSome(const ComponentSignature& signature) const
+        {
+            return !m_HasSome || signature.Intersects(m_SomeSignature);
+        }
+        inline bool CheckExclude(const ComponentSignature& signature) const
+        {
+            return !signature.Intersects(m_ExcludeSignature);
+        }
     private:
         std::vector<uint32_t> m_All;
         std::vector<uint32_t> m_Some;
         std::vector<uint32_t> m_Exclude;
 
-        uint32_t m_AllMask = 0;
-        uint32_t m_SomeMask = 0;
-        uint32_t m_ExcludeMask = 0;
+        ComponentSignature m_AllSignature;
+        ComponentSignature m_SomeSignature;
+        ComponentSignature m_ExcludeSignature;
+        bool               m_HasSome = false;
+    };
+
+    // the archetypes matching a query, systems walk their chunks instead of single entities
+    class QueryResult final
+    {
+    public:
+        QueryResult() = default;
+        explicit QueryResult(std::vector<Archetype*>&& archetypes) : m_Archetypes(std::move(archetypes)) {}
+
+        inline const std::vector<Archetype*>& GetArchetypes() const { return m_Archetypes; }
+        inline void                           Add(Archetype* archetype) { m_Archetypes.push_back(archetype); }
+        inline void                           SetJobSystem(JobSystem* jobs) { m_JobSystem = jobs; }
+
+        uint32_t GetEntityCount() const
+        {
+            uint32_t count = 0;
+            for (auto archetype : m_Archetypes)
+            {
+                count += archetype->GetEntityCount();
+            }
+            return count;
+        }
+
+        // fn(const ChunkView&) for every non-empty chunk
+        template<typename F>
+        void EachChunk(F&& fn) const
+        {
+            for (auto archetype : m_Archetypes)
+            {
+                for (uint32_t chunk = 0; chunk < archetype->GetChunkCount(); chunk++)
+                {
+                    fn(archetype->GetChunk(chunk));
+                }
+            }
+        }
+
+        // EachChunk limited to chunks where any of T changed after version, usually the system's last run version.
+        // visiting a chunk with a non const Get marks it changed again
+        template<typename... T, typename F>
+        void EachChangedChunk(uint32_t version, F&& fn) const
+        {
+            EachChunk([&](const ChunkView& chunk) {
+                if ((chunk.IsChanged<T>(version) || ...))
+                {
+                    fn(chunk);
+                }
+            });
+        }
+
+        // fn(T&...) for every entity, every T has to be in the query's all list
+        template<typename... T, typename F>
+        void Each(F&& fn) const
+        {
+            EachChunk([&](const ChunkView& chunk) {
+                auto     columns = std::make_tuple(chunk.Get<T>()...);
+                uint32_t count   = chunk.Count();
+                for (uint32_t row = 0; row < count; row++)
+                {
+                    fn(std::get<T*>(columns)[row]...);
+                }
+            });
+        }
+
+        // EachChunk spread over the job system, fn may run on several threads at once.
+        // returns once every chunk is done, without a job system it is EachChunk
+        template<typename F>
+        void ParallelEachChunk(F&& fn) const
+        {
+            if (m_JobSystem == nullptr || m_JobSystem->GetWorkerCount() == 0)
+            {
+                EachChunk(fn);
+                return;
+            }
+
+            JobCounter counter;
+            for (auto archetype : m_Archetypes)
+            {
+                uint32_t chunkCount = archetype->GetChunkCount();
+                for (uint32_t begin = 0; begin < chunkCount; begin += QUERY_CHUNKS_PER_JOB)
+                {
+                    uint32_t end = std::min(begin + QUERY_CHUNKS_PER_JOB, chunkCount);
+                    m_JobSystem->Run(
+                        [&fn, archetype, begin, end]() {
+                            for (uint32_t chunk = begin; chunk < end; chunk++)
+                            {
+                                fn(archetype->GetChunk(chunk));
+                            }
+                        },
+                        &counter);
+                }
+            }
+            m_JobSystem->Wait(counter);
+        }
+
+        template<typename... T, typename F>
+        void ParallelEach(F&& fn) const
+        {
+            ParallelEachChunk([&](const ChunkView& chunk) {
+                auto     columns = std::make_tuple(chunk.Get<T>()...);
+                uint32_t count   = chunk.Count();
+                for (uint32_t row = 0; row < count; row++)
+                {
+                    fn(std::get<T*>(columns)[row]...);
+                }
+            });
+        }
+
+    private:
+        std::vector<Archetype*> m_Archetypes;
+        JobSystem*             m_JobSystem = nullptr;
     };
-}
\ No newline at end of file
+}
@@ -1,21 +1,56 @@
 #include "System.h"
+#include "core/profile/Profiler.h"
+#include "scene/Scene.h"
 
 namespace Zephyr
 {
-    void SystemBase::Tick(float delta, const std::vector<Entity*>& entities) {
+    bool SystemBase::Conflicts(const SystemBase& other) const
+    {
+        if (IsExclusive() || other.IsExclusive())
+        {
+            return true;
+        }
+        // readers only conflict with writers
+        return m_Writes.Intersects(other.m_Reads) || m_Writes.Intersects(other.m_Writes) ||
+               m_Reads.Intersects(other.m_Writes);
+    }
+
+    EntityCommandBuffer& SystemBase::GetCommands()
+    {
+        assert(m_Scene && "system isn't part of a scene");
+        return m_Scene->GetCommandBuffer();
+    }
+
+    void SystemBase::Match(Archetype* archetype)
+    {
+        if (m_Query.Qualify(archetype->GetSignature()))
+        {
+            m_Result.Add(archetype);
+        }
+    }
+
+    void SystemBase::MatchAll(const std::vector<Archetype*>& archetypes, const std::vector<ComponentSignature>& signatures)
+    {
+        std::vector<uint32_t> matches;
+        m_Query.Filter(signatures.data(), signatures.size(), matches);
+        for (auto index : matches)
+        {
+            m_Result.Add(archetypes[index]);
+        }
+    }
+
+    void SystemBase::Tick(float delta) {
+        ZEPHYR_PROFILE_ZONE("SystemBase::Tick");
         if (!m_Enabled)
         {
             return;
         }
-        std::vector<Entity*> list;
-
-        for (auto& entity : entities)
+        if (m_Scene)
         {
-            if (m_Query.Qualify(entity))
-            {
-                list.push_back(entity);
-            }
+            m_LastRunVersion = m_RunVersion;
+            m_RunVersion     = m_Scene->AdvanceChangeVersion();
         }
-        Execute(delta, list);
+        // empty archetypes stay in the result, they just have no chunks to walk
+        Execute(delta, m_Result);
     }
 } // namespace Zephyr
\ No newline at end of file
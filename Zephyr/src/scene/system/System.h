@@ -5,7 +5,9 @@
 namespace Zephyr
 {
     class Engine;
-    class Entity;
+    class Archetype;
+    class Scene;
+    class EntityCommandBuffer;
     class SystemBase
     {
     public:
@@ -17,25 +19,73 @@ namespace Zephyr
         SystemBase() = default;
         virtual ~SystemBase() = default;
 
+        // reads and writes are the components Execute touches. a system declaring neither is exclusive:
+        // the scheduler runs it alone on the thread that ticks the scene
         SystemBase(Engine* engine, const std::vector<uint32_t>& all,
                    const std::vector<uint32_t>& some,
-                   const std::vector<uint32_t>& exclude) :
+                   const std::vector<uint32_t>& exclude,
+                   const std::vector<uint32_t>& reads  = {},
+                   const std::vector<uint32_t>& writes = {}) :
             m_Engine(engine), m_Query(all, some, exclude)
-        {}
+        {
+            for (auto id : reads)
+            {
+                m_Reads.Set(id);
+            }
+            for (auto id : writes)
+            {
+                m_Writes.Set(id);
+            }
+            m_Exclusive = reads.empty() && writes.empty();
+        }
 
         void Disable() { m_Enabled = false; }
 
         void Enable() { m_Enabled = true; }
 
-        void Tick(float delta, const std::vector<Entity*>& entities);
+        inline bool                      IsEnabled() const { return m_Enabled; }
+        inline bool                      IsExclusive() const { return m_Exclusive; }
+        inline const ComponentSignature& GetReads() const { return m_Reads; }
+        inline const ComponentSignature& GetWrites() const { return m_Writes; }
+
+        // whether the two can't run at the same time
+        bool Conflicts(const SystemBase& other) const;
+
+        // used by the parallel iteration of the query result
+        void SetJobSystem(JobSystem* jobs) { m_Result.SetJobSystem(jobs); }
+        void SetScene(Scene* scene) { m_Scene = scene; }
+
+        // called by the scene for every archetype it creates after the system was added
+        void Match(Archetype* archetype);
+        // called once when the system is added, signatures[i] belongs to archetypes[i]
+        void MatchAll(const std::vector<Archetype*>& archetypes, const std::vector<ComponentSignature>& signatures);
 
-        virtual void Execute(float delta, const std::vector<Entity*>& entities) = 0;
-        virtual void Shutdown()                                                 = 0;
+        void Tick(float delta);
+
+        virtual void Execute(float delta, const QueryResult& result) = 0;
+        virtual void Shutdown()                                      = 0;
+
+    protected:
+        // where Execute records structural changes, they are applied once every system ticked
+        EntityCommandBuffer& GetCommands();
+        // components with a newer change version changed since the previous Execute, 0 on the first one
+        inline uint32_t      GetLastRunVersion() const { return m_LastRunVersion; }
 
     protected:
         Query m_Query;
+        // matching archetypes, only ever grows since archetypes live as long as the scene
+        QueryResult m_Result;
         Engine* m_Engine;
+        Scene*  m_Scene = nullptr;
         bool  m_Enabled = true;
+
+        ComponentSignature m_Reads;
+        ComponentSignature m_Writes;
+        bool               m_Exclusive = true;
+
+        // scene change version at the start of the previous run and of the current one
+        uint32_t m_LastRunVersion = 0;
+        uint32_t m_RunVersion     = 0;
     };
 
     template<typename T>
@@ -45,8 +95,10 @@ namespace Zephyr
         static const uint32_t ID;
         System(Engine* engine, const std::vector<uint32_t>& all,
                    const std::vector<uint32_t>& some,
-                   const std::vector<uint32_t>& exclude) :
-            SystemBase(engine, all, some, exclude)
+                   const std::vector<uint32_t>& exclude,
+                   const std::vector<uint32_t>& reads  = {},
+                   const std::vector<uint32_t>& writes = {}) :
+            SystemBase(engine, all, some, exclude, reads, writes)
         {}
     };
 
@@ -0,0 +1,89 @@
+#include "SystemScheduler.h"
+#include "System.h"
+#include "core/profile/Profiler.h"
+
+namespace Zephyr
+{
+    void SystemScheduler::Build(const std::vector<SystemBase*>& systems)
+    {
+        m_Nodes.clear();
+        for (auto system : systems)
+        {
+            if (system->IsEnabled())
+            {
+                m_Nodes.push_back(system);
+            }
+        }
+
+        uint32_t count = m_Nodes.size();
+        m_Dependents.resize(count);
+        m_DependencyCount.assign(count, 0);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            m_Dependents[i].clear();
+            for (uint32_t j = i + 1; j < count; j++)
+            {
+                if (m_Nodes[i]->Conflicts(*m_Nodes[j]))
+                {
+                    m_Dependents[i].push_back(j);
+                    m_DependencyCount[j]++;
+                }
+            }
+        }
+
+        if (m_RemainingSize < count)
+        {
+            m_Remaining.reset(new std::atomic<uint32_t>[count]);
+            m_RemainingSize = count;
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            m_Remaining[i].store(m_DependencyCount[i], std::memory_order_relaxed);
+        }
+    }
+
+    void SystemScheduler::Run(float delta, const std::vector<SystemBase*>& systems, JobSystem* jobs)
+    {
+        ZEPHYR_PROFILE_ZONE("SystemScheduler::Run");
+        if (jobs == nullptr || jobs->GetWorkerCount() == 0)
+        {
+            // the order systems were added already satisfies every conflict
+            for (auto system : systems)
+            {
+                system->Tick(delta);
+            }
+            return;
+        }
+
+        // exclusive systems are main thread jobs, only this thread's Wait runs them
+        assert(jobs->IsMainThread());
+
+        Build(systems);
+        for (uint32_t node = 0; node < m_Nodes.size(); node++)
+        {
+            if (m_DependencyCount[node] == 0)
+            {
+                Launch(node, delta, jobs);
+            }
+        }
+        jobs->Wait(m_Counter);
+    }
+
+    void SystemScheduler::Launch(uint32_t node, float delta, JobSystem* jobs)
+    {
+        auto affinity = m_Nodes[node]->IsExclusive() ? JobAffinity::MainThread : JobAffinity::Any;
+        jobs->Run(
+            [this, node, delta, jobs]() {
+                m_Nodes[node]->Tick(delta);
+                for (auto dependent : m_Dependents[node])
+                {
+                    if (m_Remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        Launch(dependent, delta, jobs);
+                    }
+                }
+            },
+            &m_Counter,
+            affinity);
+    }
+} // namespace Zephyr
@@ -0,0 +1,37 @@
+#pragma once
+#include "pch.h"
+#include "core/job/JobSystem.h"
+
+namespace Zephyr
+{
+    class SystemBase;
+
+    /*
+        runs the systems of a scene for one frame.
+        two systems conflict when one writes a component the other reads or writes, a conflicting pair always runs
+        in the order the systems were added. everything else is free to run at the same time on the job system.
+        the dependency graph is rebuilt every frame since systems can be added, enabled or disabled between frames.
+    */
+    class SystemScheduler final
+    {
+    public:
+        // jobs may be nullptr, then every system runs in order on the calling thread
+        void Run(float delta, const std::vector<SystemBase*>& systems, JobSystem* jobs);
+
+    private:
+        void Build(const std::vector<SystemBase*>& systems);
+        void Launch(uint32_t node, float delta, JobSystem* jobs);
+
+    private:
+        // enabled systems in the order they were added
+        std::vector<SystemBase*> m_Nodes;
+        // later systems that conflict with a node, each waits for all of its earlier conflicts
+        std::vector<std::vector<uint32_t>>       m_Dependents;
+        std::vector<uint32_t>                    m_DependencyCount;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_Remaining;
+        uint32_t                                 m_RemainingSize = 0;
+
+        // systems launched and not done yet, a system launches its dependents before it counts as done
+        JobCounter m_Counter;
+    };
+} // namespace Zephyr
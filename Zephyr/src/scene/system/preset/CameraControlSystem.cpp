@@ -2,14 +2,13 @@
 #include "core/event/EventSystem.h"
 #include "core/event/KeyboardEvent.h"
 #include "core/event/MouseEvent.h"
-#include "scene/Entity.h"
 #include "scene/component/CameraControlComponent.h"
 #include "scene/component/MainCameraComponent.h"
 
 namespace Zephyr
 {
     CameraControlSystem::CameraControlSystem(Engine* engine) :
-        System(engine, {}, {CameraControlComponent::ID, MainCameraComponent::ID}, {})
+        System(engine, {}, {CameraControlComponent::ID, MainCameraComponent::ID}, {}, {}, {MainCameraComponent::ID})
     {
         EventCenter::Get()->Register<KeyPressedEvent>([this](KeyPressedEvent& event) {
             auto keycode = event.GetKeyCode();
@@ -63,29 +62,36 @@ namespace Zephyr
         });
     }
 
-    void CameraControlSystem::Execute(float delta, const std::vector<Entity*>& entities)
+    void CameraControlSystem::Execute(float delta, const QueryResult& result)
     {
-        for (auto& entity : entities)
-        {
-            auto camera = entity->GetComponent<MainCameraComponent>();
-            camera->camera.Rotate(m_CameraAngularMovementX * delta, m_CameraAngularMovementY * delta);
-            if (m_ActionKey & Forward)
+        result.EachChunk([&](const ChunkView& chunk) {
+            auto cameras = chunk.Get<MainCameraComponent>();
+            if (!cameras)
             {
-                camera->camera.Forward(.03);
+                return;
             }
-            if (m_ActionKey & Back)
+            for (uint32_t row = 0; row < chunk.Count(); row++)
             {
-                camera->camera.Back(.03);
+                auto camera = &cameras[row];
+                camera->camera.Rotate(m_CameraAngularMovementX * delta, m_CameraAngularMovementY * delta);
+                if (m_ActionKey & Forward)
+                {
+                    camera->camera.Forward(.03);
+                }
+                if (m_ActionKey & Back)
+                {
+                    camera->camera.Back(.03);
+                }
+                if (m_ActionKey & Left)
+                {
+                    camera->camera.Left(.03);
+                }
+                if (m_ActionKey & Right)
+                {
+                    camera->camera.Right(.03);
+                }
             }
-            if (m_ActionKey & Left)
-            {
-                camera->camera.Left(.03);
-            }
-            if (m_ActionKey & Right)
-            {
-                camera->camera.Right(.03);
-            }
-        }
+        });
 
         m_CameraAngularMovementX = 0.;
         m_CameraAngularMovementY = 0.;
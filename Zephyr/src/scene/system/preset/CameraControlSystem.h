@@ -25,7 +25,7 @@ namespace Zephyr
         CameraControlSystem(Engine * engine);
         ~CameraControlSystem() override = default;
 
-        void Execute(float delta, const std::vector<Entity*>& entities) override;
+        void Execute(float delta, const QueryResult& result) override;
         void Shutdown() override {}
 
     private:
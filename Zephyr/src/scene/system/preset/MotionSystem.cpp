@@ -0,0 +1,43 @@
+#include "MotionSystem.h"
+#include "engine/Engine.h"
+#include "scene/component/MotionComponent.h"
+#include "scene/component/PointLightComponent.h"
+#include "scene/component/TransformComponent.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Zephyr
+{
+    MotionSystem::MotionSystem(Engine* engine) :
+        System(engine, {MotionComponent::ID}, {}, {}, {MotionComponent::ID}, {TransformComponent::ID, PointLightComponent::ID})
+    {}
+
+    void MotionSystem::Execute(float delta, const QueryResult& result)
+    {
+        // driven by the frame index instead of delta
+        float time = m_Engine->GetFrame() * MOTION_TIME_STEP;
+
+        // rows are independent, chunks go to the job system
+        result.ParallelEachChunk([time](const ChunkView& chunk) {
+            auto motions    = chunk.Get<const MotionComponent>();
+            auto transforms = chunk.Get<TransformComponent>();
+            auto lights     = chunk.Get<PointLightComponent>();
+
+            for (uint32_t row = 0; row < chunk.Count(); row++)
+            {
+                auto&     motion = motions[row];
+                float     angle  = motion.phase + motion.speed * time;
+                glm::vec3 offset = {motion.radius * glm::cos(angle), 0.f, motion.radius * glm::sin(angle)};
+
+                glm::mat4 transform = glm::translate(glm::mat4(1.), offset) * motion.rest;
+                if (transforms)
+                {
+                    transforms[row].transform = transform;
+                }
+                if (lights)
+                {
+                    lights[row].light.position = glm::vec3(transform[3]);
+                }
+            }
+        });
+    }
+} // namespace Zephyr
@@ -0,0 +1,22 @@
+#pragma once
+#include "pch.h"
+#include "scene/system/System.h"
+
+namespace Zephyr
+{
+    class Engine;
+    class Entity;
+
+    // seconds one frame advances the motion, a fixed step keeps moving scenes identical between runs
+    inline constexpr float MOTION_TIME_STEP = 1.f / 60.f;
+
+    SYSTEM(MotionSystem)
+    {
+    public:
+        MotionSystem(Engine * engine);
+        ~MotionSystem() override = default;
+
+        void Execute(float delta, const QueryResult& result) override;
+        void Shutdown() override {}
+    };
+} // namespace Zephyr
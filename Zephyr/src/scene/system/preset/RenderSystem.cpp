@@ -1,58 +1,232 @@
 #include "RenderSystem.h"
+#include "core/profile/Profiler.h"
 #include "engine/Engine.h"
 #include "scene/component/DirectionalLightComponent.h"
 #include "scene/component/PointLightComponent.h"
 #include "scene/component/MainCameraComponent.h"
 #include "scene/component/MeshComponent.h"
 #include "scene/component/TransformComponent.h"
-#include "scene/Entity.h"
 #include "render/Renderer.h"
+#include "resource/Mesh.h"
 
 namespace Zephyr
 {
+    namespace
+    {
+        // same transforms as the renderer gives the submeshes, submeshes without bounds are left out
+        AABB GetWorldBounds(Mesh* mesh, const glm::mat4& transform)
+        {
+            AABB bounds({FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX});
+            for (auto& submesh : mesh->GetSubmeshes())
+            {
+                if (!submesh.aabb.IsEmpty())
+                {
+                    bounds = AABB::Union(bounds, submesh.aabb.Transform(submesh.transform * transform));
+                }
+            }
+            // a point where the mesh is, its units are never culled
+            if (bounds.IsEmpty())
+            {
+                glm::vec3 origin = transform[3];
+                bounds           = AABB(origin, origin);
+            }
+            return bounds;
+        }
+
+        AABB GetWorldBounds(const PointLight& light)
+        {
+            return AABB(light.position - glm::vec3(light.radius), light.position + glm::vec3(light.radius));
+        }
+    } // namespace
+
+    // declares no access so it stays exclusive and records on the main thread
     RenderSystem::RenderSystem(Engine* engine):
         System(engine, {}, { PointLightComponent::ID, DirectionalLightComponent::ID, MainCameraComponent::ID, MeshComponent::ID }, {}),
         m_Renderer(engine)
-    {}
+    {
+        m_Data.meshBounds       = &m_MeshBounds;
+        m_Data.pointLightBounds = &m_PointLightBounds;
+    }
 
-    void RenderSystem::Execute(float delta, const std::vector<Entity*>& entities)
+    void RenderSystem::Execute(float delta, const QueryResult& result)
     {
-        SceneRenderData scene;
-        for (auto& entity : entities)
+        ZEPHYR_PROFILE_ZONE("RenderSystem::Execute");
+        uint32_t version    = GetLastRunVersion();
+        auto&    archetypes = result.GetArchetypes();
+        m_Rows.resize(archetypes.size());
+
+        for (uint32_t index = 0; index < archetypes.size(); index++)
         {
-            auto b = entity->HasComponent<DirectionalLightComponent>();
-            if (entity->HasComponent<DirectionalLightComponent>())
+            auto     archetype  = archetypes[index];
+            auto&    chunks     = m_Rows[index];
+            uint32_t chunkCount = archetype->GetChunkCount();
+
+            // chunks the archetype freed since the last run
+            while (chunks.size() > chunkCount)
             {
-                scene.light = entity->GetComponent<DirectionalLightComponent>()->light;
+                for (auto& slots : chunks.back())
+                {
+                    Release(slots);
+                }
+                chunks.pop_back();
             }
-            if (entity->HasComponent<PointLightComponent>())
+            chunks.resize(chunkCount);
+
+            bool camera      = archetype->Has(MainCameraComponent::ID);
+            bool directional = archetype->Has(DirectionalLightComponent::ID);
+            for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
             {
-                scene.pointLights.push_back(entity->GetComponent<PointLightComponent>()->light);
+                auto chunk = archetype->GetChunk(chunkIndex);
+
+                // a handful of rows, taken every frame. read only, the view matrix is derived on the copy so the
+                // camera column isn't marked changed by every frame
+                if (camera)
+                {
+                    auto cameras = chunk.Get<const MainCameraComponent>();
+                    for (uint32_t row = 0; row < chunk.Count(); row++)
+                    {
+                        m_Data.camera = cameras[row].camera;
+                        m_Data.camera.Update();
+                    }
+                }
+                if (directional)
+                {
+                    auto lights = chunk.Get<const DirectionalLightComponent>();
+                    for (uint32_t row = 0; row < chunk.Count(); row++)
+                    {
+                        m_Data.light = lights[row].light;
+                    }
+                }
+
+                if (chunks[chunkIndex].size() != chunk.Count() || chunk.IsChanged<MeshComponent>(version) ||
+                    chunk.IsChanged<TransformComponent>(version) || chunk.IsChanged<PointLightComponent>(version))
+                {
+                    SyncChunk(index, chunkIndex, chunk, version);
+                }
             }
-            if (entity->HasComponent<MainCameraComponent>())
+        }
+
+        m_MeshBounds.Optimize();
+        m_PointLightBounds.Optimize();
+
+        m_Renderer.SetPostProcessSettings(m_Engine->GetPostProcessSettings());
+        m_Renderer.SetColorGrading(m_Engine->GetColorGrading());
+        m_Renderer.Render(m_Data);
+    }
+
+    void RenderSystem::SyncChunk(uint32_t archetype, uint32_t chunk, const ChunkView& view, uint32_t version)
+    {
+        auto&    rows  = m_Rows[archetype][chunk];
+        uint32_t count = view.Count();
+
+        // rows past the end left the chunk
+        while (rows.size() > count)
+        {
+            Release(rows.back());
+            rows.pop_back();
+        }
+        uint32_t known = rows.size();
+        rows.resize(count);
+
+        auto meshes      = view.Get<const MeshComponent>();
+        auto transforms  = view.Get<const TransformComponent>();
+        auto pointLights = view.Get<const PointLightComponent>();
+        for (uint32_t row = 0; row < count; row++)
+        {
+            auto& slots = rows[row];
+            bool  added = row >= known;
+
+            if (meshes && (added || view.IsChanged<MeshComponent>(row, version) ||
+                           view.IsChanged<TransformComponent>(row, version)))
             {
-                auto camera  = entity->GetComponent<MainCameraComponent>();
-                camera->camera.Update();
-                scene.camera = camera->camera;
-                //scene.camera.Update();
+                bool created = slots.mesh == NoSlot;
+                if (created)
+                {
+                    slots.mesh = m_Data.meshes.size();
+                    m_Data.meshes.emplace_back();
+                    m_Data.transforms.emplace_back();
+                    m_MeshOwners.push_back({archetype, chunk, row});
+                }
+                m_Data.meshes[slots.mesh]     = meshes[row].mesh;
+                m_Data.transforms[slots.mesh] = transforms ? transforms[row].transform : glm::mat4(1.);
+
+                auto bounds = GetWorldBounds(m_Data.meshes[slots.mesh], m_Data.transforms[slots.mesh]);
+                if (created)
+                {
+                    m_MeshProxies.push_back(m_MeshBounds.Insert(bounds, slots.mesh));
+                }
+                else
+                {
+                    m_MeshBounds.Move(m_MeshProxies[slots.mesh], bounds);
+                }
             }
-            if (entity->HasComponent<MeshComponent>())
+
+            if (pointLights && (added || view.IsChanged<PointLightComponent>(row, version)))
             {
-                scene.meshes.push_back(entity->GetComponent<MeshComponent>()->mesh);
-                if (entity->HasComponent<TransformComponent>())
+                bool created = slots.pointLight == NoSlot;
+                if (created)
+                {
+                    slots.pointLight = m_Data.pointLights.size();
+                    m_Data.pointLights.emplace_back();
+                    m_PointLightOwners.push_back({archetype, chunk, row});
+                }
+                m_Data.pointLights[slots.pointLight] = pointLights[row].light;
+
+                auto bounds = GetWorldBounds(pointLights[row].light);
+                if (created)
                 {
-                    scene.transforms.push_back(entity->GetComponent<TransformComponent>()->transform);
+                    m_PointLightProxies.push_back(m_PointLightBounds.Insert(bounds, slots.pointLight));
                 }
                 else
                 {
-                    scene.transforms.push_back(glm::mat4(1.));
+                    m_PointLightBounds.Move(m_PointLightProxies[slots.pointLight], bounds);
                 }
             }
+        }
+    }
 
+    // swap removes the row's slots, the last slot's owner is pointed at the hole
+    void RenderSystem::Release(const RowSlots& slots)
+    {
+        if (slots.mesh != NoSlot)
+        {
+            uint32_t last = m_Data.meshes.size() - 1;
+            m_MeshBounds.Remove(m_MeshProxies[slots.mesh]);
+            if (slots.mesh != last)
+            {
+                auto& owner                   = m_MeshOwners[last];
+                m_Data.meshes[slots.mesh]     = m_Data.meshes[last];
+                m_Data.transforms[slots.mesh] = m_Data.transforms[last];
+                m_MeshOwners[slots.mesh]      = owner;
+                m_MeshProxies[slots.mesh]     = m_MeshProxies[last];
+                m_MeshBounds.SetUserData(m_MeshProxies[slots.mesh], slots.mesh);
+                m_Rows[owner.archetype][owner.chunk][owner.row].mesh = slots.mesh;
+            }
+            m_Data.meshes.pop_back();
+            m_Data.transforms.pop_back();
+            m_MeshOwners.pop_back();
+            m_MeshProxies.pop_back();
         }
 
-        m_Renderer.Render(scene);
+        if (slots.pointLight != NoSlot)
+        {
+            uint32_t last = m_Data.pointLights.size() - 1;
+            m_PointLightBounds.Remove(m_PointLightProxies[slots.pointLight]);
+            if (slots.pointLight != last)
+            {
+                auto& owner                           = m_PointLightOwners[last];
+                m_Data.pointLights[slots.pointLight]  = m_Data.pointLights[last];
+                m_PointLightOwners[slots.pointLight]  = owner;
+                m_PointLightProxies[slots.pointLight] = m_PointLightProxies[last];
+                m_PointLightBounds.SetUserData(m_PointLightProxies[slots.pointLight], slots.pointLight);
+                m_Rows[owner.archetype][owner.chunk][owner.row].pointLight = slots.pointLight;
+            }
+            m_Data.pointLights.pop_back();
+            m_PointLightOwners.pop_back();
+            m_PointLightProxies.pop_back();
+        }
     }
+
     void RenderSystem::Shutdown() { m_Renderer.Shutdown();
     }
-} // namespace Zephyr
\ No newline at end of file
+} // namespace Zephyr
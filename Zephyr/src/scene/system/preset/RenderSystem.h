@@ -1,5 +1,6 @@
 #pragma once
 #include "scene/system/System.h"
+#include "core/math/DynamicBVH.h"
 #include "render/Renderer.h"
 
 namespace Zephyr
@@ -7,17 +8,58 @@ namespace Zephyr
     class Engine;
     class Entity;
 
+    /*
+        keeps a persistent SceneRenderData mirror of the scene. each run only the chunks whose mesh, transform or
+        point light changed since the previous run are visited, and in them only the changed rows are copied.
+        mirror slots belong to archetype rows, a row that is swapped in by a removal is stamped changed and simply
+        overwrites the slot. every slot also has a proxy in a bvh of world bounds, moved along with the copy, which
+        the renderer culls with and gameplay can query
+    */
     SYSTEM(RenderSystem)
     {
     public:
         RenderSystem(Engine * engine);
         ~RenderSystem() override = default;
 
-        void Execute(float delta, const std::vector<Entity*>& entities) override;
+        void Execute(float delta, const QueryResult& result) override;
         void Shutdown() override;
 
+        // user data is the index into the mirrored meshes / point lights, valid until the next run
+        inline const DynamicBVH& GetMeshBounds() const { return m_MeshBounds; }
+        inline const DynamicBVH& GetPointLightBounds() const { return m_PointLightBounds; }
+
+    private:
+        static constexpr uint32_t NoSlot = ~0u;
+
+        // where a row's data sits in the mirror
+        struct RowSlots
+        {
+            uint32_t mesh       = NoSlot;
+            uint32_t pointLight = NoSlot;
+        };
+        // the row a mirror slot belongs to
+        struct SlotOwner
+        {
+            uint32_t archetype;
+            uint32_t chunk;
+            uint32_t row;
+        };
+
+        void SyncChunk(uint32_t archetype, uint32_t chunk, const ChunkView& view, uint32_t version);
+        void Release(const RowSlots& slots);
+
     private:
         Renderer m_Renderer;
-        uint32_t m_MaxPointLights = 1000;
+
+        SceneRenderData        m_Data;
+        std::vector<SlotOwner> m_MeshOwners;
+        std::vector<SlotOwner> m_PointLightOwners;
+        // bvh proxy of every slot
+        DynamicBVH             m_MeshBounds;
+        DynamicBVH             m_PointLightBounds;
+        std::vector<uint32_t>  m_MeshProxies;
+        std::vector<uint32_t>  m_PointLightProxies;
+        // slots of every row, by matched archetype and chunk
+        std::vector<std::vector<std::vector<RowSlots>>> m_Rows;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,516 @@
+#include "TransformSystem.h"
+#include "core/profile/Profiler.h"
+#include "scene/component/LocalTransformComponent.h"
+#include "scene/component/TransformComponent.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ZEPHYR_TRANSFORM_SSE
+#include <xmmintrin.h>
+#else
+#include <glm/gtc/matrix_transform.hpp>
+#endif
+
+namespace Zephyr
+{
+    namespace
+    {
+        constexpr uint32_t NO_NODE = ~0u;
+    } // namespace
+
+    TransformSystem::TransformSystem(Engine* engine) :
+        System(engine,
+               {LocalTransformComponent::ID, TransformComponent::ID},
+               {},
+               {},
+               {},
+               {LocalTransformComponent::ID, TransformComponent::ID})
+    {}
+
+    void TransformSystem::Execute(float delta, const QueryResult& result)
+    {
+        ZEPHYR_PROFILE_ZONE("TransformSystem::Execute");
+        Sync(result);
+        Update(result);
+    }
+
+    void TransformSystem::Sync(const QueryResult& result)
+    {
+        auto&    archetypes = result.GetArchetypes();
+        uint32_t version    = GetLastRunVersion();
+        m_Rows.resize(archetypes.size());
+        m_Versions.resize(archetypes.size(), ~0u);
+        m_Sync++;
+        m_Departed.clear();
+        m_Added.clear();
+
+        for (uint32_t index = 0; index < archetypes.size(); index++)
+        {
+            auto archetype = archetypes[index];
+            if (archetype->GetVersion() == m_Versions[index])
+            {
+                continue;
+            }
+            m_Versions[index] = archetype->GetVersion();
+
+            // chunks the archetype freed
+            auto&    chunks     = m_Rows[index];
+            uint32_t chunkCount = archetype->GetChunkCount();
+            for (uint32_t chunk = chunkCount; chunk < chunks.size(); chunk++)
+            {
+                m_Departed.insert(m_Departed.end(), chunks[chunk].begin(), chunks[chunk].end());
+            }
+            chunks.resize(chunkCount);
+
+            // rows only come and go in chunks that are stamped or changed their row count
+            for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+            {
+                auto chunk = archetype->GetChunk(chunkIndex);
+                if (chunks[chunkIndex].size() != chunk.Count() || chunk.IsChanged<LocalTransformComponent>(version))
+                {
+                    SyncChunk(archetype, index, chunkIndex);
+                }
+            }
+        }
+
+        // a node found at no row of the visited chunks left the query, one found again only moved
+        m_Removed.clear();
+        for (auto node : m_Departed)
+        {
+            if (m_Nodes[node].synced != m_Sync)
+            {
+                m_Nodes[node].synced = m_Sync;
+                m_Removed.push_back(m_Nodes[node].handle);
+            }
+        }
+        m_Orphans.clear();
+        for (auto handle : m_Removed)
+        {
+            Remove(handle);
+        }
+
+        // the components of removed rows are gone, orphans are only touched once every removal is done
+        for (auto handle : m_Orphans)
+        {
+            auto iter = m_Indices.find(handle);
+            if (iter == m_Indices.end())
+            {
+                continue;
+            }
+            auto& orphan = m_Nodes[iter->second];
+            if (orphan.local->parent == orphan.parentHandle)
+            {
+                // the parent was removed or lost its LocalTransformComponent
+                orphan.local->parent = InvalidEntityHandle;
+                orphan.local->dirty  = true;
+                orphan.archetype->MarkChanged(LocalTransformComponent::ID, orphan.chunk, orphan.row);
+            }
+            orphan.parentHandle = InvalidEntityHandle;
+            SetDepth(iter->second, 0);
+        }
+
+        // link new nodes once all of them exist, a parent can come after its child
+        for (auto handle : m_Added)
+        {
+            uint32_t node = m_Indices[handle];
+            Attach(node);
+            // the world matrix of a new row was never written
+            m_Nodes[node].local->dirty = true;
+        }
+        for (auto handle : m_Added)
+        {
+            uint32_t node   = m_Indices[handle];
+            uint32_t parent = m_Nodes[node].parent;
+            // new nodes below another new node get their depth with it
+            if (m_Nodes[node].depth == NO_NODE && (parent == NO_NODE || m_Nodes[parent].depth != NO_NODE))
+            {
+                SetDepth(node, parent == NO_NODE ? 0 : m_Nodes[parent].depth + 1);
+            }
+        }
+        m_Changed.resize(m_Nodes.size(), 0);
+    }
+
+    void TransformSystem::SyncChunk(Archetype* archetype, uint32_t index, uint32_t chunk)
+    {
+        auto     view  = archetype->GetChunk(chunk);
+        auto&    rows  = m_Rows[index][chunk];
+        uint32_t count = view.Count();
+        if (rows.size() > count)
+        {
+            m_Departed.insert(m_Departed.end(), rows.begin() + count, rows.end());
+        }
+        rows.resize(count, NO_NODE);
+
+        // cached for Update, which marks every row it writes, marking whole columns here would report every
+        // transform as changed
+        auto entities = view.GetEntities();
+        auto locals   = view.GetColumn<LocalTransformComponent>();
+        auto worlds   = view.GetColumn<TransformComponent>();
+        for (uint32_t row = 0; row < count; row++)
+        {
+            uint32_t node = rows[row];
+            if (node == NO_NODE || m_Nodes[node].handle != entities[row])
+            {
+                if (node != NO_NODE)
+                {
+                    m_Departed.push_back(node);
+                }
+
+                auto iter = m_Indices.find(entities[row]);
+                if (iter != m_Indices.end())
+                {
+                    node = iter->second;
+                }
+                else
+                {
+                    node = m_Nodes.size();
+                    m_Nodes.push_back({});
+                    m_Nodes[node].handle       = entities[row];
+                    m_Nodes[node].parent       = NO_NODE;
+                    m_Nodes[node].parentHandle = InvalidEntityHandle;
+                    m_Nodes[node].firstChild   = NO_NODE;
+                    m_Nodes[node].nextSibling  = NO_NODE;
+                    m_Nodes[node].prevSibling  = NO_NODE;
+                    m_Nodes[node].depth        = NO_NODE;
+                    m_Indices.insert({entities[row], node});
+                    m_Added.push_back(entities[row]);
+                }
+                rows[row] = node;
+            }
+
+            auto& found          = m_Nodes[node];
+            found.local          = &locals[row];
+            found.world          = &worlds[row];
+            found.archetype      = archetype;
+            found.archetypeIndex = index;
+            found.chunk          = chunk;
+            found.row            = row;
+            found.synced         = m_Sync;
+        }
+    }
+
+    // swap removes the node, its children become roots until Sync re-roots them
+    void TransformSystem::Remove(EntityHandle handle)
+    {
+        auto     iter = m_Indices.find(handle);
+        uint32_t node = iter->second;
+        m_Indices.erase(iter);
+
+        for (uint32_t child = m_Nodes[node].firstChild; child != NO_NODE;)
+        {
+            auto&    orphan     = m_Nodes[child];
+            uint32_t next       = orphan.nextSibling;
+            orphan.parent       = NO_NODE;
+            orphan.nextSibling  = NO_NODE;
+            orphan.prevSibling  = NO_NODE;
+            m_Orphans.push_back(orphan.handle);
+            child = next;
+        }
+        Detach(node);
+
+        uint32_t last = m_Nodes.size() - 1;
+        if (node != last)
+        {
+            auto& moved                                          = m_Nodes[node];
+            moved                                                = m_Nodes[last];
+            m_Indices[moved.handle]                              = node;
+            m_Rows[moved.archetypeIndex][moved.chunk][moved.row] = node;
+            if (moved.parent != NO_NODE && m_Nodes[moved.parent].firstChild == last)
+            {
+                m_Nodes[moved.parent].firstChild = node;
+            }
+            if (moved.prevSibling != NO_NODE)
+            {
+                m_Nodes[moved.prevSibling].nextSibling = node;
+            }
+            if (moved.nextSibling != NO_NODE)
+            {
+                m_Nodes[moved.nextSibling].prevSibling = node;
+            }
+            for (uint32_t child = moved.firstChild; child != NO_NODE; child = m_Nodes[child].nextSibling)
+            {
+                m_Nodes[child].parent = node;
+            }
+        }
+        m_Nodes.pop_back();
+    }
+
+    // links the node below the parent its local names, a missing parent makes it a root
+    void TransformSystem::Attach(uint32_t node)
+    {
+        auto&    attached = m_Nodes[node];
+        uint32_t parent   = NO_NODE;
+        if (attached.local->parent != InvalidEntityHandle)
+        {
+            auto iter = m_Indices.find(attached.local->parent);
+            if (iter != m_Indices.end())
+            {
+                parent = iter->second;
+                for (uint32_t ancestor = parent; ancestor != NO_NODE; ancestor = m_Nodes[ancestor].parent)
+                {
+                    assert(ancestor != node && "transform parents form a cycle");
+                    if (ancestor == node)
+                    {
+                        parent = NO_NODE;
+                        break;
+                    }
+                }
+            }
+            if (parent == NO_NODE)
+            {
+                // the parent was removed or lost its LocalTransformComponent
+                attached.local->parent = InvalidEntityHandle;
+                attached.local->dirty  = true;
+                attached.archetype->MarkChanged(LocalTransformComponent::ID, attached.chunk, attached.row);
+            }
+        }
+
+        attached.parent       = parent;
+        attached.parentHandle = attached.local->parent;
+        attached.prevSibling  = NO_NODE;
+        attached.nextSibling  = NO_NODE;
+        if (parent != NO_NODE)
+        {
+            attached.nextSibling = m_Nodes[parent].firstChild;
+            if (attached.nextSibling != NO_NODE)
+            {
+                m_Nodes[attached.nextSibling].prevSibling = node;
+            }
+            m_Nodes[parent].firstChild = node;
+        }
+    }
+
+    void TransformSystem::Detach(uint32_t node)
+    {
+        auto& detached = m_Nodes[node];
+        if (detached.parent == NO_NODE)
+        {
+            return;
+        }
+        if (detached.prevSibling != NO_NODE)
+        {
+            m_Nodes[detached.prevSibling].nextSibling = detached.nextSibling;
+        }
+        else
+        {
+            m_Nodes[detached.parent].firstChild = detached.nextSibling;
+        }
+        if (detached.nextSibling != NO_NODE)
+        {
+            m_Nodes[detached.nextSibling].prevSibling = detached.prevSibling;
+        }
+        detached.parent      = NO_NODE;
+        detached.prevSibling = NO_NODE;
+        detached.nextSibling = NO_NODE;
+    }
+
+    void TransformSystem::SetDepth(uint32_t node, uint32_t depth)
+    {
+        m_Nodes[node].depth = depth;
+        m_Stack.clear();
+        m_Stack.push_back(node);
+        while (!m_Stack.empty())
+        {
+            auto& parent = m_Nodes[m_Stack.back()];
+            m_Stack.pop_back();
+            for (uint32_t child = parent.firstChild; child != NO_NODE; child = m_Nodes[child].nextSibling)
+            {
+                m_Nodes[child].depth = parent.depth + 1;
+                m_Stack.push_back(child);
+            }
+        }
+    }
+
+    void TransformSystem::Update(const QueryResult& result)
+    {
+        // the dirty flags are read in storage order, which walks the chunks front to back
+        m_Dirty.clear();
+        auto& archetypes = result.GetArchetypes();
+        for (uint32_t index = 0; index < archetypes.size(); index++)
+        {
+            for (uint32_t chunkIndex = 0; chunkIndex < archetypes[index]->GetChunkCount(); chunkIndex++)
+            {
+                auto  chunk  = archetypes[index]->GetChunk(chunkIndex);
+                auto  locals = chunk.Get<const LocalTransformComponent>();
+                auto& rows   = m_Rows[index][chunkIndex];
+                for (uint32_t row = 0; row < chunk.Count(); row++)
+                {
+                    if (locals[row].dirty)
+                    {
+                        m_Dirty.push_back(rows[row]);
+                    }
+                }
+            }
+        }
+        if (m_Dirty.empty())
+        {
+            return;
+        }
+
+        for (auto node : m_Dirty)
+        {
+            if (m_Nodes[node].local->parent != m_Nodes[node].parentHandle)
+            {
+                Detach(node);
+                Attach(node);
+                uint32_t parent = m_Nodes[node].parent;
+                SetDepth(node, parent == NO_NODE ? 0 : m_Nodes[parent].depth + 1);
+            }
+        }
+
+        // a node is composed after its parent, both dirty or not
+        std::sort(m_Dirty.begin(), m_Dirty.end(), [&](uint32_t a, uint32_t b) {
+            return m_Nodes[a].depth < m_Nodes[b].depth || (m_Nodes[a].depth == m_Nodes[b].depth && a < b);
+        });
+        uint32_t dirty = 0;
+        m_Batch.clear();
+        for (uint32_t depth = 0; !m_Batch.empty() || dirty < m_Dirty.size(); depth++)
+        {
+            m_Next.clear();
+            for (auto node : m_Batch)
+            {
+                for (uint32_t child = m_Nodes[node].firstChild; child != NO_NODE; child = m_Nodes[child].nextSibling)
+                {
+                    m_Changed[child] = 1;
+                    m_Next.push_back(child);
+                }
+            }
+            for (; dirty < m_Dirty.size() && m_Nodes[m_Dirty[dirty]].depth == depth; dirty++)
+            {
+                if (!m_Changed[m_Dirty[dirty]])
+                {
+                    m_Next.push_back(m_Dirty[dirty]);
+                }
+            }
+
+            // parents all have a smaller depth, so the batch doesn't depend on itself
+            Compose(m_Next.data(), m_Next.size());
+            for (auto node : m_Next)
+            {
+                auto& composed = m_Nodes[node];
+                composed.archetype->MarkChanged(TransformComponent::ID, composed.chunk, composed.row);
+                m_Changed[node] = 0;
+            }
+            std::swap(m_Batch, m_Next);
+        }
+
+        for (auto node : m_Dirty)
+        {
+            m_Nodes[node].local->dirty = false;
+        }
+    }
+
+#ifdef ZEPHYR_TRANSFORM_SSE
+    // four nodes per iteration, lane i of every register belongs to node i
+    void TransformSystem::Compose(const uint32_t* nodes, uint32_t count)
+    {
+        for (uint32_t begin = 0; begin < count; begin += 4)
+        {
+            uint32_t lanes = std::min(count - begin, 4u);
+
+            // gather into structure of arrays, missing lanes repeat the last node
+            alignas(16) float soa[10][4];
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                auto local   = m_Nodes[nodes[begin + std::min(lane, lanes - 1)]].local;
+                soa[0][lane] = local->position.x;
+                soa[1][lane] = local->position.y;
+                soa[2][lane] = local->position.z;
+                soa[3][lane] = local->rotation.x;
+                soa[4][lane] = local->rotation.y;
+                soa[5][lane] = local->rotation.z;
+                soa[6][lane] = local->rotation.w;
+                soa[7][lane] = local->scale.x;
+                soa[8][lane] = local->scale.y;
+                soa[9][lane] = local->scale.z;
+            }
+
+            __m128 x  = _mm_load_ps(soa[3]);
+            __m128 y  = _mm_load_ps(soa[4]);
+            __m128 z  = _mm_load_ps(soa[5]);
+            __m128 w  = _mm_load_ps(soa[6]);
+            __m128 sx = _mm_load_ps(soa[7]);
+            __m128 sy = _mm_load_ps(soa[8]);
+            __m128 sz = _mm_load_ps(soa[9]);
+
+            __m128 one = _mm_set1_ps(1.f);
+            __m128 two = _mm_set1_ps(2.f);
+            __m128 xx  = _mm_mul_ps(x, x);
+            __m128 yy  = _mm_mul_ps(y, y);
+            __m128 zz  = _mm_mul_ps(z, z);
+            __m128 xy  = _mm_mul_ps(x, y);
+            __m128 xz  = _mm_mul_ps(x, z);
+            __m128 yz  = _mm_mul_ps(y, z);
+            __m128 wx  = _mm_mul_ps(w, x);
+            __m128 wy  = _mm_mul_ps(w, y);
+            __m128 wz  = _mm_mul_ps(w, z);
+
+            // rotation matrix of the quaternion, column c scaled by scale[c]. local[c * 3 + r] is column c row r
+            alignas(16) float local[9][4];
+            auto store = [&](uint32_t index, __m128 value, __m128 scale) {
+                _mm_store_ps(local[index], _mm_mul_ps(value, scale));
+            };
+            store(0, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            store(1, _mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            store(2, _mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            store(3, _mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            store(4, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            store(5, _mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            store(6, _mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            store(7, _mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            store(8, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+            // scatter, multiplying with the parent's world matrix column by column
+            for (uint32_t lane = 0; lane < lanes; lane++)
+            {
+                auto& node = m_Nodes[nodes[begin + lane]];
+                float* out = &node.world->transform[0][0];
+                if (node.parent == NO_NODE)
+                {
+                    for (uint32_t column = 0; column < 3; column++)
+                    {
+                        _mm_storeu_ps(out + column * 4,
+                                      _mm_setr_ps(local[column * 3][lane],
+                                                  local[column * 3 + 1][lane],
+                                                  local[column * 3 + 2][lane],
+                                                  0.f));
+                    }
+                    _mm_storeu_ps(out + 12, _mm_setr_ps(soa[0][lane], soa[1][lane], soa[2][lane], 1.f));
+                    continue;
+                }
+
+                const float* parent = &m_Nodes[node.parent].world->transform[0][0];
+                __m128       p0     = _mm_loadu_ps(parent);
+                __m128       p1     = _mm_loadu_ps(parent + 4);
+                __m128       p2     = _mm_loadu_ps(parent + 8);
+                __m128       p3     = _mm_loadu_ps(parent + 12);
+                for (uint32_t column = 0; column < 3; column++)
+                {
+                    __m128 result = _mm_mul_ps(p0, _mm_set1_ps(local[column * 3][lane]));
+                    result        = _mm_add_ps(result, _mm_mul_ps(p1, _mm_set1_ps(local[column * 3 + 1][lane])));
+                    result        = _mm_add_ps(result, _mm_mul_ps(p2, _mm_set1_ps(local[column * 3 + 2][lane])));
+                    _mm_storeu_ps(out + column * 4, result);
+                }
+                __m128 translation = _mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(soa[0][lane])), p3);
+                translation        = _mm_add_ps(translation, _mm_mul_ps(p1, _mm_set1_ps(soa[1][lane])));
+                translation        = _mm_add_ps(translation, _mm_mul_ps(p2, _mm_set1_ps(soa[2][lane])));
+                _mm_storeu_ps(out + 12, translation);
+            }
+        }
+    }
+#else
+    void TransformSystem::Compose(const uint32_t* nodes, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            auto&     node  = m_Nodes[nodes[i]];
+            auto      local = node.local;
+            glm::mat4 transform =
+                glm::translate(glm::mat4(1.f), local->position) * glm::mat4_cast(local->rotation) *
+                glm::scale(glm::mat4(1.f), local->scale);
+
+            node.world->transform =
+                node.parent == NO_NODE ? transform : m_Nodes[node.parent].world->transform * transform;
+        }
+    }
+#endif
+} // namespace Zephyr
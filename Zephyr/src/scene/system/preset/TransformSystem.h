@@ -0,0 +1,84 @@
+#pragma once
+#include "pch.h"
+#include "scene/system/System.h"
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    class Engine;
+    struct LocalTransformComponent;
+    struct TransformComponent;
+
+    /*
+        writes the world matrix of every entity with LocalTransformComponent and TransformComponent.
+        nodes link to their parent and children and know their depth, so dirty nodes sorted by depth are composed
+        level by level and a level only reads matrices of levels already done. per frame the dirty flags are scanned
+        in storage order, then only dirty nodes and their descendants are composed, four at a time with sse.
+        the nodes cache component pointers. spawns, despawns and moves between archetypes only revisit the chunks
+        whose row count or local transforms changed, so their cost is one pass over those chunks plus a hash lookup
+        per moved row; nodes are added and swap removed in place, nothing is rebuilt
+    */
+    SYSTEM(TransformSystem)
+    {
+    public:
+        TransformSystem(Engine * engine);
+        ~TransformSystem() override = default;
+
+        void Execute(float delta, const QueryResult& result) override;
+        void Shutdown() override {}
+
+    private:
+        struct Node
+        {
+            LocalTransformComponent* local;
+            TransformComponent*      world;
+            // where world lives, writes through the cached pointer are marked by hand
+            Archetype*               archetype;
+            uint32_t                 archetypeIndex;
+            uint32_t                 chunk;
+            uint32_t                 row;
+            EntityHandle             handle;
+            // indices into m_Nodes, ~0u when there is none
+            uint32_t                 parent;
+            uint32_t                 firstChild;
+            uint32_t                 nextSibling;
+            uint32_t                 prevSibling;
+            // local->parent when the node was linked, a different one means the entity was reparented
+            EntityHandle             parentHandle;
+            uint32_t                 depth;
+            // the last Sync that found the node in a row
+            uint32_t                 synced;
+        };
+
+        // follows the rows the matched archetypes gained, lost or moved since the last run
+        void Sync(const QueryResult& result);
+        void SyncChunk(Archetype* archetype, uint32_t index, uint32_t chunk);
+        void Remove(EntityHandle handle);
+        void Attach(uint32_t node);
+        void Detach(uint32_t node);
+        // sets the depth of the node and all of its descendants
+        void SetDepth(uint32_t node, uint32_t depth);
+        void Update(const QueryResult& result);
+        void Compose(const uint32_t* nodes, uint32_t count);
+
+    private:
+        std::vector<Node>                          m_Nodes;
+        std::unordered_map<EntityHandle, uint32_t> m_Indices;
+        // node of every row, m_Rows[archetype][chunk][row] with archetypes in the order of the query result
+        std::vector<std::vector<std::vector<uint32_t>>> m_Rows;
+        // version of every matched archetype at the last Sync
+        std::vector<uint32_t> m_Versions;
+        uint32_t              m_Sync = 0;
+
+        // per frame scratch, m_Changed is only set while its level is composed
+        std::vector<uint8_t>      m_Changed;
+        std::vector<uint32_t>     m_Dirty;
+        std::vector<uint32_t>     m_Batch;
+        std::vector<uint32_t>     m_Next;
+        std::vector<uint32_t>     m_Departed;
+        std::vector<uint32_t>     m_Stack;
+        std::vector<EntityHandle> m_Added;
+        std::vector<EntityHandle> m_Removed;
+        std::vector<EntityHandle> m_Orphans;
+    };
+} // namespace Zephyr
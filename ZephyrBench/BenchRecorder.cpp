@@ -0,0 +1,248 @@
+#include "BenchRecorder.h"
+#include "engine/Engine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace Zephyr
+{
+    namespace
+    {
+        float Percentile(const std::vector<float>& sorted, float p)
+        {
+            uint32_t index = std::min<uint32_t>((uint32_t)(p * sorted.size()), sorted.size() - 1);
+            return sorted[index];
+        }
+
+        // avg, median, p95, p99 and max of the samples under prefix
+        void Distribution(std::vector<std::pair<std::string, double>>& metrics,
+                          const std::string&                           prefix,
+                          const std::vector<float>&                    samples)
+        {
+            if (samples.empty())
+            {
+                return;
+            }
+            auto sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.;
+            for (auto sample : sorted)
+            {
+                sum += sample;
+            }
+            metrics.push_back({prefix + ".avg", sum / sorted.size()});
+            metrics.push_back({prefix + ".median", Percentile(sorted, .5f)});
+            metrics.push_back({prefix + ".p95", Percentile(sorted, .95f)});
+            metrics.push_back({prefix + ".p99", Percentile(sorted, .99f)});
+            metrics.push_back({prefix + ".max", sorted.back()});
+        }
+
+        std::string Escape(const std::string& s)
+        {
+            std::string result;
+            for (auto c : s)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    result.push_back('\\');
+                }
+                result.push_back(c);
+            }
+            return result;
+        }
+
+        // the flat "metrics" object of a report written by WriteJson
+        bool ReadMetrics(const std::string& path, std::map<std::string, double>& metrics)
+        {
+            std::ifstream file(path);
+            if (!file.is_open())
+            {
+                return false;
+            }
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            std::string text = buffer.str();
+
+            auto begin = text.find("\"metrics\"");
+            if (begin == std::string::npos)
+            {
+                return false;
+            }
+            size_t pos = text.find('{', begin);
+            size_t end = text.find('}', pos);
+            if (pos == std::string::npos || end == std::string::npos)
+            {
+                return false;
+            }
+
+            while (true)
+            {
+                size_t keyBegin = text.find('"', pos);
+                if (keyBegin == std::string::npos || keyBegin > end)
+                {
+                    break;
+                }
+                size_t keyEnd = text.find('"', keyBegin + 1);
+                size_t colon  = text.find(':', keyEnd);
+
+                char*  valueEnd = nullptr;
+                double value    = std::strtod(text.c_str() + colon + 1, &valueEnd);
+
+                metrics[text.substr(keyBegin + 1, keyEnd - keyBegin - 1)] = value;
+                pos                                                       = valueEnd - text.c_str();
+            }
+            return true;
+        }
+    } // namespace
+
+    void BenchRecorder::Record(Engine* engine)
+    {
+        auto now   = std::chrono::steady_clock::now();
+        auto frame = engine->GetFrame();
+        if (frame == 0)
+        {
+            m_LastFrameTime = now;
+            return;
+        }
+
+        float cpuTime   = std::chrono::duration<float, std::milli>(now - m_LastFrameTime).count();
+        m_LastFrameTime = now;
+
+        if (frame < m_WarmupFrames)
+        {
+            return;
+        }
+
+        auto driver = engine->GetDriver();
+        m_CpuFrameTimes.push_back(cpuTime);
+        m_Statistics.push_back(driver->GetStatistics());
+
+        // gpu results trail by the frames in flight, only frames rendered after the warm-up count
+        auto& timings = driver->GetGpuTimings();
+        if (!timings.valid || timings.frame < m_WarmupFrames || (m_GpuCollected && timings.frame == m_GpuLastFrame))
+        {
+            return;
+        }
+        m_GpuCollected = true;
+        m_GpuLastFrame = timings.frame;
+
+        m_GpuFrameTimes.push_back(timings.frameTime);
+
+        // a pass can run several times in a frame, its samples are per frame
+        std::map<std::string, float> passTimes;
+        for (auto& scope : timings.scopes)
+        {
+            passTimes[scope.name] += scope.time;
+        }
+        for (auto& [name, time] : passTimes)
+        {
+            m_GpuPassTimes[name].push_back(time);
+        }
+    }
+
+    std::vector<std::pair<std::string, double>> BenchRecorder::Summarize() const
+    {
+        std::vector<std::pair<std::string, double>> metrics;
+
+        Distribution(metrics, "cpu.frame", m_CpuFrameTimes);
+        Distribution(metrics, "gpu.frame", m_GpuFrameTimes);
+        for (auto& [name, times] : m_GpuPassTimes)
+        {
+            Distribution(metrics, "gpu.pass." + name, times);
+        }
+
+        if (!m_Statistics.empty())
+        {
+            double   drawCalls = 0., dispatches = 0., pipelineBinds = 0., descriptorSetBinds = 0.;
+            double   descriptorSetWrites = 0., submits = 0.;
+            uint64_t bufferMemory = 0, textureMemory = 0;
+            for (auto& stats : m_Statistics)
+            {
+                drawCalls += stats.drawCalls;
+                dispatches += stats.dispatches;
+                pipelineBinds += stats.pipelineBinds;
+                descriptorSetBinds += stats.descriptorSetBinds;
+                descriptorSetWrites += stats.descriptorSetWrites;
+                submits += stats.submits;
+                bufferMemory  = std::max(bufferMemory, stats.bufferMemory);
+                textureMemory = std::max(textureMemory, stats.textureMemory);
+            }
+
+            double count = m_Statistics.size();
+            metrics.push_back({"driver.drawCalls", drawCalls / count});
+            metrics.push_back({"driver.dispatches", dispatches / count});
+            metrics.push_back({"driver.pipelineBinds", pipelineBinds / count});
+            metrics.push_back({"driver.descriptorSetBinds", descriptorSetBinds / count});
+            metrics.push_back({"driver.descriptorSetWrites", descriptorSetWrites / count});
+            metrics.push_back({"driver.submits", submits / count});
+            metrics.push_back({"memory.bufferMB", bufferMemory / (1024. * 1024.)});
+            metrics.push_back({"memory.textureMB", textureMemory / (1024. * 1024.)});
+        }
+
+        return metrics;
+    }
+
+    bool BenchRecorder::WriteJson(const std::string& path, const std::string& scene) const
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            printf("[ZephyrBench] cannot write %s\n", path.c_str());
+            return false;
+        }
+
+        auto metrics = Summarize();
+
+        file << "{\n";
+        file << "  \"scene\": \"" << Escape(scene) << "\",\n";
+        file << "  \"warmupFrames\": " << m_WarmupFrames << ",\n";
+        file << "  \"measuredFrames\": " << m_CpuFrameTimes.size() << ",\n";
+        file << "  \"gpuFrames\": " << m_GpuFrameTimes.size() << ",\n";
+        file << "  \"metrics\": {\n";
+        for (uint32_t i = 0; i < metrics.size(); i++)
+        {
+            file << "    \"" << Escape(metrics[i].first) << "\": " << metrics[i].second;
+            file << (i + 1 < metrics.size() ? ",\n" : "\n");
+        }
+        file << "  }\n";
+        file << "}\n";
+
+        return true;
+    }
+
+    bool BenchRecorder::Compare(const std::string& baselinePath, double threshold) const
+    {
+        std::map<std::string, double> baseline;
+        if (!ReadMetrics(baselinePath, baseline))
+        {
+            printf("[ZephyrBench] cannot read baseline %s\n", baselinePath.c_str());
+            return false;
+        }
+
+        uint32_t regressions = 0;
+        for (auto& [name, value] : Summarize())
+        {
+            auto iter = baseline.find(name);
+            if (iter == baseline.end())
+            {
+                printf("[ZephyrBench] %-40s new metric %.3f\n", name.c_str(), value);
+                continue;
+            }
+
+            double base = iter->second;
+            if (value > base * (1. + threshold) && value - base > BENCH_MIN_REGRESSION)
+            {
+                double change = base > 0. ? (value / base - 1.) * 100. : 100.;
+                printf("[ZephyrBench] %-40s %.3f -> %.3f (+%.1f%%) REGRESSION\n", name.c_str(), base, value, change);
+                regressions++;
+            }
+        }
+
+        printf("[ZephyrBench] %u regression(s) against %s at %.0f%% threshold\n",
+               regressions,
+               baselinePath.c_str(),
+               threshold * 100.);
+        return regressions == 0;
+    }
+} // namespace Zephyr
@@ -0,0 +1,45 @@
+#pragma once
+#include "pch.h"
+#include "rhi/Driver.h"
+
+namespace Zephyr
+{
+    class Engine;
+
+    // a metric regresses when it grows by more than the relative threshold and by more than this
+    inline constexpr double BENCH_MIN_REGRESSION = .01;
+
+    /*
+        per-frame samples of a benchmark run: cpu frame time, gpu time of the frame and every frame graph pass,
+        the driver's command counters and allocated memory. every metric is lower-is-better, so the flat
+        "metrics" object of the json report can be compared against a stored baseline key by key.
+    */
+    class BenchRecorder final
+    {
+    public:
+        explicit BenchRecorder(uint32_t warmupFrames) : m_WarmupFrames(warmupFrames) {}
+
+        // once per frame, after the frame was submitted
+        void Record(Engine* engine);
+
+        bool WriteJson(const std::string& path, const std::string& scene) const;
+        // prints every regressed metric, false when there is at least one or the baseline can't be read
+        bool Compare(const std::string& baselinePath, double threshold) const;
+
+    private:
+        std::vector<std::pair<std::string, double>> Summarize() const;
+
+    private:
+        uint32_t m_WarmupFrames;
+
+        std::chrono::steady_clock::time_point m_LastFrameTime;
+
+        std::vector<float>                        m_CpuFrameTimes;
+        std::vector<float>                        m_GpuFrameTimes;
+        std::map<std::string, std::vector<float>> m_GpuPassTimes;
+        std::vector<DriverStatistics>             m_Statistics;
+
+        bool     m_GpuCollected = false;
+        uint64_t m_GpuLastFrame = 0;
+    };
+} // namespace Zephyr
@@ -0,0 +1,228 @@
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include "BenchScene.h"
+#include "engine/Engine.h"
+#include "resource/MaterialInstance.h"
+#include "resource/Mesh.h"
+#include "resource/preset/geometry/BoxMesh.h"
+#include "scene/Scene.h"
+#include "scene/component/DirectionalLightComponent.h"
+#include "scene/component/MainCameraComponent.h"
+#include "scene/component/MeshComponent.h"
+#include "scene/component/PointLightComponent.h"
+#include "scene/component/TransformComponent.h"
+#include "scene/system/preset/RenderSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <sstream>
+
+namespace Zephyr
+{
+    namespace
+    {
+        // position of the index-th cell of a square grid centred on the origin in the xz plane
+        glm::vec3 GridPosition(uint32_t index, uint32_t count, float spacing, float height)
+        {
+            uint32_t side   = (uint32_t)std::ceil(std::sqrt((float)count));
+            float    offset = (side - 1) * spacing * .5f;
+
+            return {(index % side) * spacing - offset, height, (index / side) * spacing - offset};
+        }
+    } // namespace
+
+    bool BenchScene::Load(const std::string& path, BenchSceneDescription& desc)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            printf("[ZephyrBench] cannot open scene %s\n", path.c_str());
+            return false;
+        }
+
+        desc      = {};
+        desc.name = std::filesystem::path(path).stem().string();
+
+        std::string line;
+        uint32_t    lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            auto comment = line.find('#');
+            if (comment != std::string::npos)
+            {
+                line.erase(comment);
+            }
+
+            std::istringstream stream(line);
+            std::string        directive;
+            if (!(stream >> directive))
+            {
+                continue;
+            }
+
+            bool valid = true;
+            if (directive == "resolution")
+            {
+                valid = bool(stream >> desc.width >> desc.height);
+            }
+            else if (directive == "frames")
+            {
+                valid = bool(stream >> desc.warmupFrames >> desc.measuredFrames);
+            }
+            else if (directive == "model")
+            {
+                BenchModel model;
+                valid = bool(stream >> model.path >> model.instances >> model.spacing >> model.scale);
+                desc.models.push_back(model);
+            }
+            else if (directive == "box")
+            {
+                BenchBox box;
+                valid = bool(stream >> box.extent >> box.instances >> box.spacing);
+                desc.boxes.push_back(box);
+            }
+            else if (directive == "lights")
+            {
+                valid = bool(stream >> desc.lightCount >> desc.lightSpacing >> desc.lightRadius);
+            }
+            else if (directive == "sun")
+            {
+                auto& d = desc.sunDirection;
+                auto& r = desc.sunRadiance;
+                valid   = bool(stream >> d.x >> d.y >> d.z >> r.x >> r.y >> r.z);
+            }
+            else if (directive == "stress")
+            {
+                StressSceneDescription stress;
+                std::string            layout;
+                valid = bool(stream >> stress.seed >> layout >> stress.entityCount >> stress.extent >>
+                             stress.meshVariants >> stress.pointLightCount >> stress.movingFraction);
+                valid = valid && (layout == "grid" || layout == "random");
+                stress.layout = layout == "grid" ? StressLayout::Grid : StressLayout::Random;
+                desc.stress.push_back(stress);
+            }
+            else if (directive == "camera")
+            {
+                BenchCameraPoint point;
+                auto&            e = point.eye;
+                auto&            t = point.target;
+                valid              = bool(stream >> e.x >> e.y >> e.z >> t.x >> t.y >> t.z);
+                desc.cameraPath.push_back(point);
+            }
+            else
+            {
+                valid = false;
+            }
+
+            if (!valid)
+            {
+                printf("[ZephyrBench] %s:%u: cannot parse \"%s\"\n", path.c_str(), lineNumber, line.c_str());
+                return false;
+            }
+        }
+
+        if (desc.cameraPath.empty())
+        {
+            desc.cameraPath.push_back({{0.f, 20.f, 60.f}, {0.f, 0.f, 0.f}});
+        }
+        return true;
+    }
+
+    void BenchScene::Build(Engine* engine, Scene* scene)
+    {
+        m_Scene = scene;
+
+        for (auto& model : m_Description.models)
+        {
+            // one mesh shared by every instance, the instance count is what is being measured
+            auto mesh     = engine->CreateMesh(model.path);
+            auto material = engine->CreateMaterial(ShadingModel::Lit);
+            material->SetConstantBlock<glm::vec3>("albedo", {1., 1., 1.});
+            material->SetConstantBlock<glm::vec3>("emission", {0., 0., 0.});
+            material->SetConstantBlock<float>("metalness", .5f);
+            material->SetConstantBlock<float>("roughness", .5f);
+            mesh->SetMaterials({material});
+
+            for (uint32_t i = 0; i < model.instances; i++)
+            {
+                auto entity   = scene->CreateEntity();
+                auto meshCmp  = scene->AddComponent<MeshComponent>(entity);
+                meshCmp->mesh = mesh;
+
+                auto position        = GridPosition(i, model.instances, model.spacing, 0.f);
+                auto transform       = scene->AddComponent<TransformComponent>(entity);
+                transform->transform = glm::scale(glm::translate(glm::mat4(1.), position), glm::vec3(model.scale));
+            }
+        }
+
+        for (auto& box : m_Description.boxes)
+        {
+            BoxMeshDescription d {box.extent, box.extent, box.extent};
+            auto               mesh     = engine->CreateMesh(d);
+            auto               material = engine->CreateMaterial(ShadingModel::Lit);
+            material->SetConstantBlock<glm::vec3>("albedo", {1., .8, .7});
+            material->SetConstantBlock<glm::vec3>("emission", {0., 0., 0.});
+            mesh->SetMaterials({material});
+
+            for (uint32_t i = 0; i < box.instances; i++)
+            {
+                auto entity   = scene->CreateEntity();
+                auto meshCmp  = scene->AddComponent<MeshComponent>(entity);
+                meshCmp->mesh = mesh;
+
+                auto transform       = scene->AddComponent<TransformComponent>(entity);
+                transform->transform = glm::translate(glm::mat4(1.), GridPosition(i, box.instances, box.spacing, -5.f));
+            }
+        }
+
+        for (auto& stress : m_Description.stress)
+        {
+            StressSceneGenerator::Generate(engine, scene, stress);
+        }
+
+        for (uint32_t i = 0; i < m_Description.lightCount; i++)
+        {
+            auto entity    = scene->CreateEntity();
+            auto light     = scene->AddComponent<PointLightComponent>(entity);
+            auto position  = GridPosition(i, m_Description.lightCount, m_Description.lightSpacing, 3.f);
+            // a fixed palette keeps the lighting identical between runs
+            float hue             = (i % 7) / 7.f;
+            light->light.position = position;
+            light->light.radius   = m_Description.lightRadius;
+            light->light.radiance = {.5f + .5f * hue, .6f, 1.f - .5f * hue};
+            light->light.falloff  = .001f;
+        }
+
+        auto sun                  = scene->CreateEntity();
+        auto sunLight             = scene->AddComponent<DirectionalLightComponent>(sun);
+        sunLight->light.direction = glm::normalize(m_Description.sunDirection);
+        sunLight->light.radiance  = m_Description.sunRadiance;
+
+        m_Camera    = scene->CreateEntity();
+        auto camera = scene->AddComponent<MainCameraComponent>(m_Camera);
+        camera->camera.SetPerspective(45., (float)m_Description.width / m_Description.height, .1, 1000.);
+        UpdateCamera(0);
+
+        scene->AddSystem<RenderSystem>();
+    }
+
+    void BenchScene::UpdateCamera(uint64_t frame)
+    {
+        auto& path   = m_Description.cameraPath;
+        auto  camera = m_Scene->GetComponent<MainCameraComponent>(m_Camera);
+
+        // one loop through the waypoints over the whole run
+        uint64_t totalFrames = std::max<uint64_t>(m_Description.warmupFrames + m_Description.measuredFrames, 1);
+        float    t           = (float)(frame % totalFrames) / totalFrames * path.size();
+        uint32_t segment     = (uint32_t)t % path.size();
+        float    blend       = t - std::floor(t);
+
+        auto& from   = path[segment];
+        auto& to     = path[(segment + 1) % path.size()];
+        auto  eye    = glm::mix(from.eye, to.eye, blend);
+        auto  target = glm::mix(from.target, to.target, blend);
+
+        camera->camera.LookAt(eye, glm::normalize(target - eye), {0.f, 1.f, 0.f});
+    }
+} // namespace Zephyr
@@ -0,0 +1,76 @@
+#pragma once
+#include "pch.h"
+#include "scene/EntityHandle.h"
+#include "scene/StressSceneGenerator.h"
+#include <glm/glm.hpp>
+
+namespace Zephyr
+{
+    class Engine;
+    class Scene;
+
+    struct BenchModel
+    {
+        std::string path;
+        uint32_t    instances = 1;
+        float       spacing   = 10.f;
+        float       scale     = 1.f;
+    };
+
+    struct BenchBox
+    {
+        float    extent    = 1.f;
+        uint32_t instances = 1;
+        float    spacing   = 4.f;
+    };
+
+    struct BenchCameraPoint
+    {
+        glm::vec3 eye;
+        glm::vec3 target;
+    };
+
+    struct BenchSceneDescription
+    {
+        std::string name;
+        uint32_t    width          = 1280;
+        uint32_t    height         = 720;
+        uint32_t    warmupFrames   = 60;
+        uint32_t    measuredFrames = 600;
+
+        std::vector<BenchModel>             models;
+        std::vector<BenchBox>               boxes;
+        std::vector<StressSceneDescription> stress;
+
+        uint32_t lightCount   = 0;
+        float    lightSpacing = 8.f;
+        float    lightRadius  = 10.f;
+
+        glm::vec3 sunDirection {-.3f, -.6f, -1.f};
+        glm::vec3 sunRadiance {3.f, 3.f, 3.f};
+
+        std::vector<BenchCameraPoint> cameraPath;
+    };
+
+    /*
+        a benchmark scene read from a plain text description, see ZephyrBench/scenes for the format.
+        everything is laid out on fixed grids and the camera position is a function of the frame index only,
+        so two runs of the same description render the same frames.
+    */
+    class BenchScene final
+    {
+    public:
+        static bool Load(const std::string& path, BenchSceneDescription& desc);
+
+        explicit BenchScene(const BenchSceneDescription& desc) : m_Description(desc) {}
+
+        void Build(Engine* engine, Scene* scene);
+        void UpdateCamera(uint64_t frame);
+
+    private:
+        BenchSceneDescription m_Description;
+
+        Scene*       m_Scene  = nullptr;
+        EntityHandle m_Camera = InvalidEntityHandle;
+    };
+} // namespace Zephyr
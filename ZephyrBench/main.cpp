@@ -0,0 +1,96 @@
+#include "BenchRecorder.h"
+#include "BenchScene.h"
+#include "engine/Engine.h"
+#include "scene/Scene.h"
+
+namespace
+{
+    void PrintUsage()
+    {
+        printf("usage: ZephyrBench <scene.bench> [--out report.json] [--baseline baseline.json] [--threshold 0.1]\n");
+    }
+} // namespace
+
+/*
+    renders a scene description headless for its warm-up plus measured frames and writes a json report.
+    with a baseline the exit code is non-zero when any metric regressed beyond the threshold.
+*/
+int main(int argc, char** argv)
+{
+    using namespace Zephyr;
+
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string scenePath = argv[1];
+    std::string outPath;
+    std::string baselinePath;
+    double      threshold = .1;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            PrintUsage();
+            return 1;
+        }
+        if (arg == "--out")
+        {
+            outPath = argv[++i];
+        }
+        else if (arg == "--baseline")
+        {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--threshold")
+        {
+            threshold = std::atof(argv[++i]);
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    BenchSceneDescription desc;
+    if (!BenchScene::Load(scenePath, desc))
+    {
+        return 1;
+    }
+    if (outPath.empty())
+    {
+        outPath = desc.name + ".json";
+    }
+
+    EngineDescription engineDesc {desc.width, desc.height, DriverType::Vulkan, "ZephyrBench", false, false, false};
+    engineDesc.headless   = true;
+    engineDesc.frameLimit = desc.warmupFrames + desc.measuredFrames;
+
+    auto          engine = Engine::Create(engineDesc);
+    BenchScene    benchScene(desc);
+    BenchRecorder recorder(desc.warmupFrames);
+
+    engine->SetFrameCallback([&](Engine* engine) {
+        recorder.Record(engine);
+        benchScene.UpdateCamera(engine->GetFrame() + 1);
+    });
+
+    engine->Run([&](Engine* engine) {
+        auto scene = engine->CreateScene(desc.name);
+        benchScene.Build(engine, scene);
+    });
+
+    bool passed = recorder.WriteJson(outPath, desc.name);
+    if (passed && !baselinePath.empty())
+    {
+        passed = recorder.Compare(baselinePath, threshold);
+    }
+
+    Engine::Destroy(engine);
+
+    return passed ? 0 : 1;
+}
@@ -9,6 +9,7 @@ layout(set = 0, binding = 1) uniform sampler2D inputImage;
 
 layout(push_constant) uniform PrefilterData {
 	vec4 data; // x: threshhold y: knee(threshold * soft threshold) z: 2 * knee w: .25/ knee
+	vec4 viewport; // xy: uv scale of the rendered region zw: uv clamp
 } prefilterData;
 
 vec3 Filter(vec3 color) {
@@ -27,6 +28,8 @@ void main() {
 	vec2 uv = vec2(float(gl_GlobalInvocationID.x)/rtSize.x, float(gl_GlobalInvocationID.y)/rtSize.y);
 	uv += .5/ rtSize;
 
+	// the scene may cover only part of the input
+	uv = min(uv * prefilterData.viewport.xy, prefilterData.viewport.zw);
 	vec3 color = texture(inputImage, uv).rgb;
 
 	color = Filter(color);
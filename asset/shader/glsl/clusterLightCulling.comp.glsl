@@ -0,0 +1,123 @@
+#version 450 core
+
+// must match the cluster constants in Renderer.h
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+#define GROUP_SIZE 128
+
+// one invocation per cluster
+layout(local_size_x = GROUP_SIZE) in;
+
+layout(set = 0, binding = 0) readonly buffer GlobalRenderData {
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 vp;
+	vec3 directionalLightDirection;
+	float _padding1;
+	vec3 directionalLightRadiance;
+	float _padding2;
+	vec3 eye;
+	float _padding3;
+	mat4 lightVPCascade[4];
+	vec2 cascadeSplits[4];
+	vec4 cascadeSphereInfo[4];
+	mat4 inverseProjection;
+	vec4 clusterInfo; // x: zNear y: zFar z: width w: height
+} globalRenderData;
+
+struct PointLight {
+	vec3 position;
+	float radius;
+	vec3 radiance;
+	float falloff;
+};
+
+layout(set = 0, binding = 1) readonly buffer PointLightData {
+	uint lightCount;
+	PointLight lights[];
+} pointLightData;
+
+// x: offset into the index list y: light count
+layout(set = 0, binding = 2) writeonly buffer ClusterLightGrid {
+	uvec2 clusters[];
+} clusterLightGrid;
+
+layout(set = 0, binding = 3) writeonly buffer ClusterLightIndex {
+	uint indices[];
+} clusterLightIndex;
+
+// view space position + radius, loaded cooperatively by the whole group
+shared vec4 sharedLights[GROUP_SIZE];
+
+vec3 NDCToView(vec2 ndc) {
+	// depth zero is the near plane
+	vec4 view = globalRenderData.inverseProjection * vec4(ndc, 0., 1.);
+	return view.xyz / view.w;
+}
+
+// intersect the ray from the eye through p with the plane z = -depth
+vec3 IntersectDepthPlane(vec3 p, float depth) {
+	return p * (-depth / p.z);
+}
+
+bool SphereIntersectsAABB(vec4 sphere, vec3 aabbMin, vec3 aabbMax) {
+	vec3 closest = clamp(sphere.xyz, aabbMin, aabbMax);
+	vec3 d = closest - sphere.xyz;
+	return dot(d, d) <= sphere.w * sphere.w;
+}
+
+void main() {
+	uint clusterIndex = gl_GlobalInvocationID.x;
+	bool valid = clusterIndex < CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+	uint x = clusterIndex % CLUSTER_GRID_X;
+	uint y = (clusterIndex / CLUSTER_GRID_X) % CLUSTER_GRID_Y;
+	uint z = clusterIndex / (CLUSTER_GRID_X * CLUSTER_GRID_Y);
+
+	// exponential depth slices
+	float zNear = globalRenderData.clusterInfo.x;
+	float zFar = globalRenderData.clusterInfo.y;
+	float sliceNear = zNear * pow(zFar / zNear, float(z) / CLUSTER_GRID_Z);
+	float sliceFar = zNear * pow(zFar / zNear, float(z + 1) / CLUSTER_GRID_Z);
+
+	vec2 tileSize = 1. / vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y);
+	vec3 tileMin = NDCToView(vec2(x, y) * tileSize * 2. - 1.);
+	vec3 tileMax = NDCToView(vec2(x + 1, y + 1) * tileSize * 2. - 1.);
+
+	vec3 minNear = IntersectDepthPlane(tileMin, sliceNear);
+	vec3 minFar = IntersectDepthPlane(tileMin, sliceFar);
+	vec3 maxNear = IntersectDepthPlane(tileMax, sliceNear);
+	vec3 maxFar = IntersectDepthPlane(tileMax, sliceFar);
+
+	vec3 aabbMin = min(min(minNear, minFar), min(maxNear, maxFar));
+	vec3 aabbMax = max(max(minNear, minFar), max(maxNear, maxFar));
+
+	uint lightCount = pointLightData.lightCount;
+	uint offset = clusterIndex * MAX_LIGHTS_PER_CLUSTER;
+	uint visibleCount = 0;
+
+	for(uint base = 0; base < lightCount; base += GROUP_SIZE) {
+		uint lightIndex = base + gl_LocalInvocationIndex;
+		if(lightIndex < lightCount) {
+			PointLight light = pointLightData.lights[lightIndex];
+			vec4 viewPos = globalRenderData.viewMatrix * vec4(light.position, 1.);
+			sharedLights[gl_LocalInvocationIndex] = vec4(viewPos.xyz, light.radius);
+		}
+		barrier();
+
+		uint batchCount = min(GROUP_SIZE, lightCount - base);
+		for(uint i = 0; valid && i < batchCount; i++) {
+			if(visibleCount < MAX_LIGHTS_PER_CLUSTER && SphereIntersectsAABB(sharedLights[i], aabbMin, aabbMax)) {
+				clusterLightIndex.indices[offset + visibleCount] = base + i;
+				visibleCount++;
+			}
+		}
+		barrier();
+	}
+
+	if(valid) {
+		clusterLightGrid.clusters[clusterIndex] = uvec2(offset, visibleCount);
+	}
+}
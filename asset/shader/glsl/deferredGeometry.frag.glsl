@@ -26,10 +26,14 @@ layout(set = 1, binding = 1) uniform sampler2D normalMap;
 layout(set = 1, binding = 2) uniform sampler2D metallicRoughnessMap;
 layout(set = 1, binding = 3) uniform sampler2D emissionMap;
 
+// rgba8
 layout(location = 0) out vec4 outAlbedoMetalness;
-layout(location = 1) out vec4 outNormalRoughness;
-layout(location = 2) out vec4 outPositionOcclusion;
-layout(location = 3) out vec4 outEmissionShadow;
+// rg16, octahedral
+layout(location = 1) out vec2 outNormal;
+// rgba8, x: roughness^2 y: occlusion z: receive shadow
+layout(location = 2) out vec4 outRoughnessOcclusion;
+// r11g11b10
+layout(location = 3) out vec3 outEmission;
 
 layout (depth_unchanged) out float gl_FragDepth;
 
@@ -45,6 +49,13 @@ layout(push_constant, std140) uniform Material
 	float ReceiveShadow;
 } materialUniforms;
 
+// maps the unit sphere onto [0, 1]^2, must match OctDecode in deferredLighting.frag
+vec2 OctEncode(vec3 n) {
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 e = n.z >= 0. ? n.xy : (1. - abs(n.yx)) * vec2(n.x >= 0. ? 1. : -1., n.y >= 0. ? 1. : -1.);
+	return e * .5 + .5;
+}
+
 void main() {
 
 //------------------------------------------------------------------------------------------------------
@@ -74,12 +85,7 @@ void main() {
 	vec3 bentNormal = normalize(mix(n, anisotropicNormal, anisotropy));
 	
 	outAlbedoMetalness = vec4(albedo, metalness);
-	outNormalRoughness = vec4(bentNormal, roughness * roughness);
-
-	// this actually stores tangent space vector
-//	outPositionOcclusion = vec4(viewPos.xyz/viewPos.w, 1.);
-	outPositionOcclusion = vec4(tbn[1], 1.);
-
-
-	outEmissionShadow = vec4(materialUniforms.Emission, materialUniforms.ReceiveShadow);
+	outNormal = OctEncode(bentNormal);
+	outRoughnessOcclusion = vec4(roughness * roughness, 1., materialUniforms.ReceiveShadow, 0.);
+	outEmission = materialUniforms.Emission;
 }
\ No newline at end of file
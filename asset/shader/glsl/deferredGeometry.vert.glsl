@@ -31,6 +31,9 @@ layout(push_constant, std140) uniform WorldMatrix
 	mat4 worldMatrix;
 } worldMatrix;
 
+// must match depthPrepass.vert for the EQUAL depth test
+invariant gl_Position;
+
 void main() {
 
 	gl_Position = globalRenderData.vp * worldMatrix.worldMatrix * vec4(inPosition, 1.);
@@ -3,7 +3,10 @@
 #version 450 core
 
 #define M_PI 3.1415926535897932384626433832795
-#define MAX_POINT_LIGHT_COUNT 1000
+// must match the cluster constants in Renderer.h
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
 const float Epsilon = 0.00001;
 const float ShadowBias = 0.005;
 
@@ -24,6 +27,9 @@ layout(set = 0, binding = 0) readonly buffer GlobalRenderData {
 	mat4 lightVPCascade[4];
 	vec2 cascadeSplits[4];
 	vec4 cascadeSphereInfo[4];
+	mat4 inverseProjection;
+	vec4 clusterInfo; // x: zNear y: zFar z: width w: height
+	mat4 inverseViewProjection;
 } globalRenderData;
 
 struct PointLight {
@@ -34,17 +40,25 @@ struct PointLight {
 };
 
 layout(set = 0, binding = 1) uniform sampler2DArray shadowMap;
-layout(set = 0, binding = 2) uniform PointLightData {
-	PointLight lights[MAX_POINT_LIGHT_COUNT];
+layout(set = 0, binding = 2) readonly buffer PointLightData {
 	uint lightCount;
-} u_PointLights;
+	PointLight lights[];
+} pointLightData;
 layout(set = 0, binding = 3) uniform samplerCube specularMap;
 layout(set = 0, binding = 4) uniform sampler2D brdfLut;
+// x: offset into the index list y: light count, written by clusterLightCulling.comp
+layout(set = 0, binding = 5) readonly buffer ClusterLightGrid {
+	uvec2 clusters[];
+} clusterLightGrid;
+layout(set = 0, binding = 6) readonly buffer ClusterLightIndex {
+	uint indices[];
+} clusterLightIndex;
 
 layout(set = 1, binding = 0) uniform sampler2D albedoMetalnessMap;
-layout(set = 1, binding = 1) uniform sampler2D normalRoughnessMap;
-layout(set = 1, binding = 2) uniform sampler2D positionOcclusionMap;
-layout(set = 1, binding = 3) uniform sampler2D emissionShadowMap;
+layout(set = 1, binding = 1) uniform sampler2D normalMap;
+layout(set = 1, binding = 2) uniform sampler2D roughnessOcclusionMap;
+layout(set = 1, binding = 3) uniform sampler2D emissionMap;
+layout(set = 1, binding = 4) uniform sampler2D depthMap;
 
 
 struct PBRParameters {
@@ -136,13 +150,28 @@ float HardShadow(vec2 shadowUv, float objectDepth, float bias, uint cascadeLevel
 	return 1.;
 }
 
+uint GetClusterIndex(vec2 uv, vec3 position) {
+	float zNear = globalRenderData.clusterInfo.x;
+	float zFar = globalRenderData.clusterInfo.y;
+	float viewDepth = -(globalRenderData.viewMatrix * vec4(position, 1.)).z;
+
+	uint x = min(uint(uv.x * CLUSTER_GRID_X), CLUSTER_GRID_X - 1);
+	uint y = min(uint(uv.y * CLUSTER_GRID_Y), CLUSTER_GRID_Y - 1);
+	float slice = log(max(viewDepth, zNear) / zNear) / log(zFar / zNear) * CLUSTER_GRID_Z;
+	uint z = min(uint(slice), CLUSTER_GRID_Z - 1);
+
+	return x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+}
+
 vec3 CalculatePointLight(PBRParameters params) {
 
 	vec3 color = vec3(0.);
-	return color;
 
-	for(uint i = 0; i < u_PointLights.lightCount; i++) {
-		PointLight light = u_PointLights.lights[i];
+	// only shade with the lights that touch this pixel's cluster
+	uvec2 cluster = clusterLightGrid.clusters[GetClusterIndex(uv, params.position)];
+
+	for(uint i = 0; i < cluster.y; i++) {
+		PointLight light = pointLightData.lights[clusterLightIndex.indices[cluster.x + i]];
 
 		vec3 albedo =  params.albedo;
 		float metalness = params.metalness;
@@ -164,7 +193,7 @@ vec3 CalculatePointLight(PBRParameters params) {
 		// inverse light
 		vec3 l = normalize(light.position - position);
 		// view/eye vector
-		vec3 v = normalize(globalRenderData.eye);
+		vec3 v = params.view;
 		// half vector of light and view
 		vec3 h = normalize(l + v);
 
@@ -257,41 +286,50 @@ float SpecularAntiAliasing(vec3 n, float rs) {
 
 }
 
-vec3 GetWorldPositionFromUV(vec2 uv) {
-	float depth = gl_FragCoord.z;
+vec3 GetWorldPositionFromUV(vec2 uv, float depth) {
 	vec4 ndcCoord = vec4(uv * 2. - 1., depth, 1.);
-
-	mat4 inverseVP = inverse(globalRenderData.vp);
-	vec4 worldPos = inverseVP * ndcCoord;
+	vec4 worldPos = globalRenderData.inverseViewProjection * ndcCoord;
 
 	return worldPos.xyz / worldPos.w;
 }
 
+// must match OctEncode in deferredGeometry.frag
+vec3 OctDecode(vec2 e) {
+	e = e * 2. - 1.;
+	vec3 n = vec3(e, 1. - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.);
+	n.x += n.x >= 0. ? -t : t;
+	n.y += n.y >= 0. ? -t : t;
+	return normalize(n);
+}
+
 void main() {
 
 //------------------------------------------------------------------------------------------------------
 // Lighting
 
-	vec4 albedoMetalness = texture(albedoMetalnessMap, uv);
-	vec4 normalRoughness = texture(normalRoughnessMap, uv);
-	vec4 positionOcclusion = texture(positionOcclusionMap, uv);
-	vec4 emissionShadow = texture(emissionShadowMap, uv);
-	
-	vec3 emission = emissionShadow.rgb;
-	float receiveShadow = emissionShadow.a;
-	vec3 position = GetWorldPositionFromUV(uv);
-	vec3 albedo =  albedoMetalness.rgb;
-	vec3 n = normalize(normalRoughness.rgb);
-	float metalness = albedoMetalness.a;
-	float roughness = normalRoughness.a;
-
-	vec3 bitangent = positionOcclusion.xyz;
-
+	// fetch, filtering would blend packed normals across edges
+	ivec2 pixel = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(depthMap, pixel, 0).r;
 
-	if(length(normalRoughness.rgb) == 0) {
-		color = vec4(0., 0., 0., 1.);
+	// nothing was drawn here, show the environment like the skybox did
+	if(depth == 1.) {
+		vec3 direction = normalize(GetWorldPositionFromUV(uv, depth) - globalRenderData.eye);
+		color = vec4(textureLod(specularMap, vec3(-direction.x, direction.y, direction.z), 0.).rgb, 1.);
 		return;
 	}
+
+	vec4 albedoMetalness = texelFetch(albedoMetalnessMap, pixel, 0);
+	vec4 roughnessOcclusion = texelFetch(roughnessOcclusionMap, pixel, 0);
+	
+	vec3 emission = texelFetch(emissionMap, pixel, 0).rgb;
+	float receiveShadow = roughnessOcclusion.b;
+	float occlusion = roughnessOcclusion.g;
+	vec3 position = GetWorldPositionFromUV(uv, depth);
+	vec3 albedo =  albedoMetalness.rgb;
+	vec3 n = OctDecode(texelFetch(normalMap, pixel, 0).rg);
+	float metalness = albedoMetalness.a;
+	float roughness = roughnessOcclusion.r;
 	
 	// specular anti aliasing
 	roughness = SpecularAntiAliasing(n, roughness * roughness);
@@ -388,7 +426,7 @@ void main() {
 	color = vec4(vec3(0.), 1.);
 	// directional light shading
 	color = vec4(((kd * f_Diffuse + f_Specular) * globalRenderData.directionalLightRadiance * NoL), 1.);
-	if(receiveShadow == 1.) {
+	if(receiveShadow > .5) {
 		color = vec4((color.rgb * shadow), 1.);
 	}
 	// point light shading
@@ -414,10 +452,10 @@ void main() {
 
 	vec3 IBL = (kD * diffuseIBL + specularIBL);
 
-	color += vec4(IBL, 1.);
+	color += vec4(IBL * occlusion, 1.);
 
 	// ambient
-	color += vec4(albedo * vec3(0.03), 1.);
+	color += vec4(albedo * vec3(0.03) * occlusion, 1.);
 
 	// emission
 	color += vec4(emission, 1.);
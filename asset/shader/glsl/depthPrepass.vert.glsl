@@ -0,0 +1,21 @@
+#version 450 core
+
+layout(location = 0) in vec3 inPosition;
+
+layout(set = 0, binding = 0) readonly buffer GlobalRenderData {
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 vp;
+} globalRenderData;
+
+layout(push_constant, std140) uniform WorldMatrix
+{
+	mat4 worldMatrix;
+} worldMatrix;
+
+// the geometry pass tests against this depth with EQUAL, both must compute the exact same position
+invariant gl_Position;
+
+void main() {
+	gl_Position = globalRenderData.vp * worldMatrix.worldMatrix * vec4(inPosition, 1.);
+}
@@ -0,0 +1,35 @@
+#version 450 core
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// one mip of the hi-z pyramid
+layout(set = 0, binding = 0, r32f) uniform writeonly image2D outputImage;
+// scene depth for mip 0, the previous mip otherwise
+layout(set = 0, binding = 1) uniform sampler2D inputImage;
+
+layout(push_constant) uniform HiZBuildConstant {
+	ivec2 inputSize;
+	ivec2 outputSize;
+} pc;
+
+void main() {
+	ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+	if(any(greaterThanEqual(p, pc.outputSize))) {
+		return;
+	}
+
+	// the input footprint of an output texel, up to 3x3 when the input isn't twice as large
+	ivec2 begin = p * pc.inputSize / pc.outputSize;
+	ivec2 end = ((p + 1) * pc.inputSize + pc.outputSize - 1) / pc.outputSize;
+
+	// keep the farthest depth so a texel never claims more occlusion than it has
+	float depth = 0.;
+	for(int y = begin.y; y < end.y; y++) {
+		for(int x = begin.x; x < end.x; x++) {
+			ivec2 coord = min(ivec2(x, y), pc.inputSize - 1);
+			depth = max(depth, texelFetch(inputImage, coord, 0).r);
+		}
+	}
+
+	imageStore(outputImage, p, vec4(depth));
+}
@@ -5,7 +5,6 @@
 #define M_PI 3.1415926535897932384626433832795
 const float Epsilon = 0.00001;
 const float ShadowBias = 0.002;
-#define MAX_POINT_LIGHT_COUNT 1000
 
 layout(location = 0) in vec3 normal;
 layout(location = 1) in vec2 uv;
@@ -37,10 +36,10 @@ struct PointLight {
 	vec3 radiance;
 	float falloff;
 };
-layout(set = 0, binding = 3) uniform PointLightData {
-	PointLight lights[MAX_POINT_LIGHT_COUNT];
+layout(set = 0, binding = 3) readonly buffer PointLightData {
 	uint lightCount;
-} u_PointLights;
+	PointLight lights[];
+} pointLightData;
 
 layout(set = 1, binding = 0) uniform sampler2D albedoMap;
 layout(set = 1, binding = 1) uniform sampler2D normalMap;
@@ -250,9 +249,9 @@ vec3 CalculatePointLight(PBRParameters params) {
 
 	vec3 color = vec3(0.);
 
-	for(uint i = 0; i < u_PointLights.lightCount; i++) {
+	for(uint i = 0; i < pointLightData.lightCount; i++) {
 //	for(uint i = 0; i < 1; i++) {
-		PointLight light = u_PointLights.lights[i];
+		PointLight light = pointLightData.lights[i];
 
 		vec3 albedo =  params.albedo;
 		float metalness = params.metalness;
@@ -0,0 +1,148 @@
+#version 450 core
+
+// one invocation per scene render unit
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0) readonly buffer GlobalRenderData {
+	mat4 viewMatrix;
+	mat4 projectionMatrix;
+	mat4 vp;
+	vec3 directionalLightDirection;
+	float _padding1;
+	vec3 directionalLightRadiance;
+	float _padding2;
+	vec3 eye;
+	float _padding3;
+	mat4 lightVPCascade[4];
+	vec2 cascadeSplits[4];
+	vec4 cascadeSphereInfo[4];
+	mat4 inverseProjection;
+	vec4 clusterInfo;
+} globalRenderData;
+
+// must match OcclusionCullUnit in Renderer.h
+struct CullUnit {
+	vec4 boundsMin;
+	vec4 boundsMax;
+	uint indexCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint _padding;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout(set = 0, binding = 1) readonly buffer CullUnits {
+	CullUnit units[];
+} cullUnits;
+
+layout(set = 0, binding = 2) writeonly buffer DrawCommands {
+	DrawCommand commands[];
+} drawCommands;
+
+// commands of the early phase, the late phase only draws what they skipped
+layout(set = 0, binding = 3) readonly buffer EarlyDrawCommands {
+	DrawCommand commands[];
+} earlyDrawCommands;
+
+layout(set = 0, binding = 4) uniform sampler2D hiZ;
+
+layout(push_constant) uniform OcclusionCullConstant {
+	// the view projection the hi-z was rendered with
+	mat4 hiZViewProjection;
+	uint unitCount;
+	// 0: early, test against last frame's hi-z 1: late, test against this frame's hi-z
+	uint phase;
+	uint hiZValid;
+	uint hiZLevels;
+} pc;
+
+bool IsInFrustum(vec3 boundsMin, vec3 boundsMax) {
+	// a box is outside if all corners are outside of one clip plane
+	uvec4 outsideNegative = uvec4(0);
+	uvec2 outsidePositive = uvec2(0);
+	for(uint i = 0; i < 8; i++) {
+		vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x,
+						   (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+						   (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+		vec4 clip = globalRenderData.vp * vec4(corner, 1.);
+		outsideNegative += uvec4(clip.x < -clip.w, clip.y < -clip.w, clip.z < 0., clip.z > clip.w);
+		outsidePositive += uvec2(clip.x > clip.w, clip.y > clip.w);
+	}
+	return all(lessThan(outsideNegative, uvec4(8))) && all(lessThan(outsidePositive, uvec2(8)));
+}
+
+bool IsOccluded(vec3 boundsMin, vec3 boundsMax) {
+	vec2 ndcMin = vec2(1.);
+	vec2 ndcMax = vec2(-1.);
+	float nearestDepth = 1.;
+	for(uint i = 0; i < 8; i++) {
+		vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x,
+						   (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+						   (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+		vec4 clip = pc.hiZViewProjection * vec4(corner, 1.);
+		// crossing the near plane, the projected rect is meaningless
+		if(clip.w <= 0.) {
+			return false;
+		}
+		vec3 ndc = clip.xyz / clip.w;
+		ndcMin = min(ndcMin, ndc.xy);
+		ndcMax = max(ndcMax, ndc.xy);
+		nearestDepth = min(nearestDepth, ndc.z);
+	}
+
+	vec2 uvMin = clamp(ndcMin * .5 + .5, 0., 1.);
+	vec2 uvMax = clamp(ndcMax * .5 + .5, 0., 1.);
+
+	// pick the mip where the rect covers at most 2x2 texels
+	vec2 hiZSize = vec2(textureSize(hiZ, 0));
+	vec2 extent = (uvMax - uvMin) * hiZSize;
+	int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.)))), 0, int(pc.hiZLevels) - 1);
+
+	ivec2 levelSize = textureSize(hiZ, level);
+	ivec2 texelMin = clamp(ivec2(uvMin * levelSize), ivec2(0), levelSize - 1);
+	ivec2 texelMax = clamp(ivec2(uvMax * levelSize), ivec2(0), levelSize - 1);
+
+	float farthestDepth = max(max(texelFetch(hiZ, texelMin, level).r, texelFetch(hiZ, ivec2(texelMax.x, texelMin.y), level).r),
+							  max(texelFetch(hiZ, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(hiZ, texelMax, level).r));
+
+	return nearestDepth > farthestDepth;
+}
+
+void main() {
+	uint index = gl_GlobalInvocationID.x;
+	if(index >= pc.unitCount) {
+		return;
+	}
+
+	CullUnit unit = cullUnits.units[index];
+	vec3 boundsMin = unit.boundsMin.xyz;
+	vec3 boundsMax = unit.boundsMax.xyz;
+
+	bool visible;
+	if(any(greaterThan(boundsMin, boundsMax))) {
+		// no bounds, never cull
+		visible = pc.phase == 0;
+	} else if(pc.phase == 0) {
+		visible = IsInFrustum(boundsMin, boundsMax) && (pc.hiZValid == 0 || !IsOccluded(boundsMin, boundsMax));
+	} else {
+		// drawn early or tested again against the depth of everything drawn early
+		visible = earlyDrawCommands.commands[index].instanceCount == 0 && IsInFrustum(boundsMin, boundsMax) &&
+				  !IsOccluded(boundsMin, boundsMax);
+	}
+
+	DrawCommand command;
+	command.indexCount = unit.indexCount;
+	command.instanceCount = visible ? 1 : 0;
+	command.firstIndex = unit.firstIndex;
+	command.vertexOffset = unit.vertexOffset;
+	command.firstInstance = 0;
+	drawCommands.commands[index] = command;
+}
@@ -0,0 +1,97 @@
+#version 450 core
+
+// fused post stack: bloom composite, color grading and tonemapping in one read of the hdr color.
+// the output is gamma encoded with its luma in alpha, ready for fxaa and the swapchain
+
+layout(constant_id = 0) const bool BLOOM = true;
+layout(constant_id = 1) const bool COLOR_GRADING = true;
+layout(constant_id = 2) const bool TONEMAP = true;
+
+layout(local_size_x = 16, local_size_y = 16) in;
+layout(set = 0, binding = 0, rgba16f) uniform writeonly image2D result;
+layout(set = 0, binding = 1) uniform sampler2D bloomImage;
+layout(set = 0, binding = 2) uniform sampler2D hdrColor;
+
+layout(push_constant) uniform ColorGradingData {
+	vec4 colorFilter;
+	float exposure; // in stops
+	float contrast;
+	float saturation;
+	float _padding;
+	vec4 viewport; // xy: uv scale of the rendered region zw: uv clamp
+} colorGradingData;
+
+const float MIDDLE_GREY = .18;
+const float EPSILON = 0.00001;
+
+vec3 ACESTonemap(vec3 color)
+{
+	mat3 m1 = mat3(
+		0.59719, 0.07600, 0.02840,
+		0.35458, 0.90834, 0.13383,
+		0.04823, 0.01566, 0.83777
+	);
+	mat3 m2 = mat3(
+		1.60475, -0.10208, -0.00327,
+		-0.53108, 1.10813, -0.07276,
+		-0.07367, -0.00605, 1.07602
+	);
+	vec3 v = m1 * color;
+	vec3 a = v * (v + 0.0245786) - 0.000090537;
+	vec3 b = v * (0.983729 * v + 0.4329510) + 0.238081;
+	return clamp(m2 * (a / b), 0.0, 1.0);
+}
+
+// Convert rgb to luminance
+// with rgb in linear space with sRGB primaries and D65 white point
+float LinearRgbToLuminance(vec3 linearRgb) {
+	return dot(linearRgb, vec3(0.2126729f,  0.7151522f, 0.0721750f));
+}
+
+vec3 GammaCorrection(vec3 color, float gamma) {
+	return pow(color, vec3(1.0f / gamma));
+}
+
+// graded in linear hdr, contrast pivots around middle grey in log space
+vec3 ColorGrade(vec3 color) {
+	color *= exp2(colorGradingData.exposure);
+	color *= colorGradingData.colorFilter.rgb;
+
+	vec3 logColor = log2(max(color, EPSILON) / MIDDLE_GREY);
+	color = MIDDLE_GREY * exp2(logColor * colorGradingData.contrast);
+
+	float luminance = LinearRgbToLuminance(color);
+	color = max(mix(vec3(luminance), color, colorGradingData.saturation), 0.);
+
+	return color;
+}
+
+void main() {
+	ivec2 invocID = ivec2(gl_GlobalInvocationID);
+	vec2 imgSize = imageSize(result);
+	if(invocID.x >= imgSize.x || invocID.y >= imgSize.y) {
+		return;
+	}
+
+	vec2 texCoords = (vec2(invocID) + .5) / imgSize;
+
+	// the scene may cover only part of hdrColor, this bilinear fetch upscales it to output resolution
+	vec2 sceneCoords = min(texCoords * colorGradingData.viewport.xy, colorGradingData.viewport.zw);
+	vec3 color = textureLod(hdrColor, sceneCoords, 0).rgb;
+	if(BLOOM) {
+		color += textureLod(bloomImage, texCoords, 0).rgb;
+	}
+	if(COLOR_GRADING) {
+		color = ColorGrade(color);
+	}
+	if(TONEMAP) {
+		color = ACESTonemap(color);
+	} else {
+		color = clamp(color, 0., 1.);
+	}
+
+	color = GammaCorrection(color, 2.2);
+
+	// fxaa measures contrast on perceptual luma
+	imageStore(result, invocID, vec4(color, LinearRgbToLuminance(color)));
+}
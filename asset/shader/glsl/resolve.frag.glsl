@@ -1,42 +1,239 @@
 #version 450 core
 
+// fused fxaa and resolve: anti-aliases the graded image while writing it to the swapchain, then dithers
+
+layout(constant_id = 0) const bool FXAA = true;
+layout(constant_id = 1) const bool DITHER = true;
+
 layout(location = 0) in vec2 uv;
 
-layout(set = 0, binding = 0) uniform sampler2D colorInput;
+// gamma encoded color with luma in alpha
+layout(set = 0, binding = 0) uniform sampler2D inputTexture;
 layout(set = 0, binding = 1) uniform sampler2D dither;
 
+layout(push_constant, std140) uniform FXAAData {
+	float contrastThreshold;
+	float relativeThreshold;
+	float sharpness;
+} fxaaData;
+
 layout(location = 0) out vec4 color;
 
+#define EDGE_STEP_COUNT 10
+#define EDGE_STEPS 1, 1.5, 2, 2, 2, 2, 2, 2, 2, 4
+#define EDGE_GUESS 8
+
+const float edgeSteps[EDGE_STEP_COUNT] = {EDGE_STEPS};
+
+/*
+	NW	N	NE
+
+	W	M	E
+
+	SW	S	SE
+*/
+
+struct LumaData {
+	float m, n, s, w, e;
+	float nw, ne, sw, se;
+	float highest, lowest, contrast;
+};
+
+struct EdgeData {
+	bool isHorizontal;
+	float pixelStep;
+	float oppositeLuma, gradient;
+};
+
+bool ShouldSkipPixel(LumaData l) {
+	float threshold = max(fxaaData.contrastThreshold, fxaaData.relativeThreshold * l.highest);
+
+	return l.contrast < threshold;
+}
+
+float SampleLuma(vec2 uv) {
+	return textureLod(inputTexture, uv, 0).a;
+}
+
+LumaData SampleNeighborLuma(vec2 uv, vec2 texelSize) {
+	LumaData data;
+	data.m = SampleLuma(uv);
+	data.n = SampleLuma(uv + vec2(0., texelSize.y));
+	data.s = SampleLuma(uv + vec2(0., -texelSize.y));
+	data.e = SampleLuma(uv + vec2(texelSize.x, 0.));
+	data.w = SampleLuma(uv + vec2(-texelSize.x, 0.));
+	data.nw = SampleLuma(uv + vec2(-texelSize.x, texelSize.y));
+	data.ne = SampleLuma(uv + vec2(texelSize.x, texelSize.y));
+	data.sw = SampleLuma(uv + vec2(-texelSize.x, -texelSize.y));
+	data.se = SampleLuma(uv + vec2(texelSize.x, -texelSize.y));
+	
+	data.highest = max(data.m, max(data.n, max(data.s, max(data.w, data.e))));
+	data.lowest = min(data.m, min(data.n, min(data.s, min(data.w, data.e))));
+	data.contrast = data.highest - data.lowest;
+
+	return data;
+}
+
+/* 3x3 tent filter
+	1	2	1
+	2		1
+	1	2	1
+*/
+
+// this determines the subpixel blending factor
+float DeterminePixelBlendFactor(LumaData data) {
+	float factor = 0.;
+	factor += data.nw + data.ne + data.sw + data.se;
+	factor += 2. * (data.n + data.s + data.w + data.e);
+
+	factor /= 12.;
+	factor = abs(data.m - factor);
+	factor = clamp(factor/data.contrast, 0., 1.);
+	factor = smoothstep(0., 1., factor);
+	factor *= factor * fxaaData.sharpness;
+
+	return factor;
+}
+
+// this determines the blending along the edge
+float DetermineEdgeBlendFactor(LumaData l, EdgeData e, vec2 uv, vec2 texelSize) {
+	vec2 edgeUv = uv;
+	vec2 edgeStep;
+	if(e.isHorizontal) {
+		edgeUv.y += e.pixelStep * .5;
+		edgeStep = vec2(texelSize.x, 0.);
+	} else {
+		edgeUv.x += e.pixelStep * .5;
+		edgeStep = vec2(0., texelSize.y);
+	}
+
+	// walk along both direction to find two ends of the edge
+	float edgeLuma = (l.m + e.oppositeLuma) * .5;
+	float gradientThreshold = e.gradient * .25;
+
+	vec2 pUv = edgeUv;
+	float pLumaDelta;
+	float nLumaDelta;
+	vec2 nUv = edgeUv;
+
+	bool pAtEnd = false;
+	bool nAtEnd = false;
+
+	for(int i = 0; i < EDGE_STEP_COUNT && !pAtEnd; i++) {
+		pUv += edgeStep * edgeSteps[i];
+		pLumaDelta = SampleLuma(pUv) - edgeLuma;
+		pAtEnd = abs(pLumaDelta) >= gradientThreshold;
+	}
+	if(!pAtEnd) {
+		pUv += edgeStep * EDGE_GUESS;
+	}
+
+	for(int i = 0; i < EDGE_STEP_COUNT && !nAtEnd; i++) {
+		nUv -= edgeStep * edgeSteps[i];
+		nLumaDelta = SampleLuma(nUv) - edgeLuma;
+		nAtEnd = abs(nLumaDelta) >= gradientThreshold;
+	}
+	if(!nAtEnd) {
+		nUv -= edgeStep * EDGE_GUESS;
+	}
+
+	float pDistance;
+	float nDistance;
+		
+	if(e.isHorizontal) {
+		pDistance = pUv.x - edgeUv.x;
+		nDistance = edgeUv.x - nUv.x;
+	} else {
+		pDistance = pUv.y - edgeUv.y;
+		nDistance = edgeUv.y - nUv.y;
+	}
+
+	float shortestDistance;
+	bool deltaSign;
+
+	if(pDistance < nDistance) {
+		shortestDistance = pDistance;
+		deltaSign = pLumaDelta >= 0.;
+	} else {
+		shortestDistance = nDistance;
+		deltaSign = nLumaDelta >= 0.;
+	}
+
+	if(deltaSign == (l.m - e.oppositeLuma) >= 0.) {
+		return 0.;
+	} else {
+		return .50001 - shortestDistance / (pDistance + nDistance);
+	}
 
-vec3 GammaCorrection(vec3 color, float gamma) {
-	return pow(color, vec3(1.0f / gamma));
 }
 
-vec3 ACESTonemap(vec3 color)
-{
-	mat3 m1 = mat3(
-		0.59719, 0.07600, 0.02840,
-		0.35458, 0.90834, 0.13383,
-		0.04823, 0.01566, 0.83777
-	);
-	mat3 m2 = mat3(
-		1.60475, -0.10208, -0.00327,
-		-0.53108, 1.10813, -0.07276,
-		-0.07367, -0.00605, 1.07602
-	);
-	vec3 v = m1 * color;
-	vec3 a = v * (v + 0.0245786) - 0.000090537;
-	vec3 b = v * (0.983729 * v + 0.4329510) + 0.238081;
+// do a comparison between horizontal contrast and vertical contrast.
+// we use different weight for diagonal values
+EdgeData DeterminEdge(LumaData data, vec2 texelSize) {
+	EdgeData e;
+
+	float horizontal = abs(data.n + data.s - 2. * data.m) * 2. + abs(data.ne + data.se - 2. * data.e) + abs(data.nw + data.sw - 2. * data.w);
+
+	float vertical = abs(data.w + data.e - 2. * data.m) * 2. + abs(data.nw + data.ne - 2. * data.n) + abs(data.sw + data.se - 2. * data.s);
+
+	// determin which direction to blend. positive direction: n for horizontal and e for vertical
+
+	e.isHorizontal = horizontal > vertical;
+	e.pixelStep = e.isHorizontal ? texelSize.y : texelSize.x;
+	
+	float pLuma = e.isHorizontal ? data.n : data.e;
+	float nLuma = e.isHorizontal ? data.s : data.w;
+	float pGradient = abs(data.m - pLuma);
+	float nGradient = abs(data.m - nLuma);
 
-	return clamp(m2 * (a / b), 0.0, 1.0);
+	if(pGradient < nGradient) {
+		e.pixelStep = -e.pixelStep;
+		e.oppositeLuma = nLuma;
+		e.gradient = nGradient;
+	} else {
+		e.oppositeLuma = pLuma;
+		e.gradient = pGradient;
+	}
+
+
+	return e;
+}
+
+vec3 Sample(vec2 uv) {
+	return textureLod(inputTexture, uv, 0).rgb;
 }
 
-float rand(vec2 co){ return fract(sin(dot(co.xy ,vec2(12.9898,78.233))) * 43758.5453); }
+vec3 ApplyFXAA(vec2 uv, vec2 texelSize) {
+	LumaData data = SampleNeighborLuma(uv, texelSize);
+
+	if(ShouldSkipPixel(data)) {
+		return Sample(uv);
+	}
+	float pixelBlendFactor = DeterminePixelBlendFactor(data);
+
+	EdgeData e = DeterminEdge(data, texelSize);
+	
+	float edgeBlendFactor = DetermineEdgeBlendFactor(data, e, uv, texelSize);
 
+	float finalBlendFactor = max(edgeBlendFactor, pixelBlendFactor);
+
+	if(e.isHorizontal) {
+		uv.y += e.pixelStep * finalBlendFactor;
+	} else {
+		uv.x += e.pixelStep * finalBlendFactor;
+	}
+
+
+	return Sample(uv);
+}
 
 void main() {
+	vec2 texelSize = 1. / vec2(textureSize(inputTexture, 0));
+
+	color = vec4(FXAA ? ApplyFXAA(uv, texelSize) : Sample(uv), 1.);
 
 	// dithering to prevent color banding
-	color = vec4(GammaCorrection(texture(colorInput, uv).rgb, 2.2),1.);
-	color += vec4(texture(dither, gl_FragCoord.xy / 8.0).r / 32.0 - (1.0 / 128.0));
-}
\ No newline at end of file
+	if(DITHER) {
+		color += vec4(texture(dither, gl_FragCoord.xy / 8.0).r / 32.0 - (1.0 / 128.0));
+	}
+}
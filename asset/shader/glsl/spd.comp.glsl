@@ -0,0 +1,194 @@
+#version 450 core
+
+// single pass downsampler: every group reduces a 64x64 tile of mip 0 down to mip 6 in shared memory,
+// the last group to finish then reduces the per-tile results of the whole dispatch down to mip 12
+
+// must match the constants in SinglePassDownsampler.h
+#define GROUP_SIZE 256
+#define MAX_MIP_COUNT 12
+#define MAX_GROUPS 4096
+
+layout(local_size_x = GROUP_SIZE) in;
+
+layout(set = 0, binding = 0) uniform sampler2D inputImage;
+
+// no format qualifier, the same shader writes every color format the views are created with
+layout(set = 0, binding = 1) uniform writeonly image2D mip1;
+layout(set = 0, binding = 2) uniform writeonly image2D mip2;
+layout(set = 0, binding = 3) uniform writeonly image2D mip3;
+layout(set = 0, binding = 4) uniform writeonly image2D mip4;
+layout(set = 0, binding = 5) uniform writeonly image2D mip5;
+layout(set = 0, binding = 6) uniform writeonly image2D mip6;
+layout(set = 0, binding = 7) uniform writeonly image2D mip7;
+layout(set = 0, binding = 8) uniform writeonly image2D mip8;
+layout(set = 0, binding = 9) uniform writeonly image2D mip9;
+layout(set = 0, binding = 10) uniform writeonly image2D mip10;
+layout(set = 0, binding = 11) uniform writeonly image2D mip11;
+layout(set = 0, binding = 12) uniform writeonly image2D mip12;
+
+struct SpdSlot {
+	uint counter; // groups done with mip 6, reset by the last one
+	uint _padding0;
+	uint _padding1;
+	uint _padding2;
+	vec4 texels[MAX_GROUPS]; // mip 6, one texel per group
+};
+
+layout(set = 0, binding = 13) coherent buffer SpdScratch {
+	SpdSlot slots[];
+} scratch;
+
+layout(push_constant) uniform SpdConstant {
+	uint mipCount; // mips written after mip 0
+	uint slot; // scratch slot, unique for every dispatch in a frame
+	uint karisAverage; // luma weighted first reduction against fireflies
+	uint _padding;
+} spdConstant;
+
+// a 32x32 block and its 16x16 reduction, later levels ping-pong between the two
+shared vec4 sharedTexels[1024 + 256];
+shared bool isLastGroup;
+
+float LinearRgbToLuminance(vec3 linearRgb) {
+	return dot(linearRgb, vec3(0.2126729f,  0.7151522f, 0.0721750f));
+}
+
+vec4 Reduce(vec4 a, vec4 b, vec4 c, vec4 d) {
+	return (a + b + c + d) * .25;
+}
+
+// http://www.iryoku.com/next-generation-post-processing-in-call-of-duty-advanced-warfare
+vec4 ReduceKaris(vec4 a, vec4 b, vec4 c, vec4 d) {
+	float wa = 1. / (1. + LinearRgbToLuminance(a.rgb));
+	float wb = 1. / (1. + LinearRgbToLuminance(b.rgb));
+	float wc = 1. / (1. + LinearRgbToLuminance(c.rgb));
+	float wd = 1. / (1. + LinearRgbToLuminance(d.rgb));
+	return (a * wa + b * wb + c * wc + d * wd) / (wa + wb + wc + wd);
+}
+
+void StoreMip(uint mip, ivec2 coord, vec4 value) {
+	switch(mip) {
+		case 1: if(all(lessThan(coord, imageSize(mip1)))) imageStore(mip1, coord, value); break;
+		case 2: if(all(lessThan(coord, imageSize(mip2)))) imageStore(mip2, coord, value); break;
+		case 3: if(all(lessThan(coord, imageSize(mip3)))) imageStore(mip3, coord, value); break;
+		case 4: if(all(lessThan(coord, imageSize(mip4)))) imageStore(mip4, coord, value); break;
+		case 5: if(all(lessThan(coord, imageSize(mip5)))) imageStore(mip5, coord, value); break;
+		case 6: if(all(lessThan(coord, imageSize(mip6)))) imageStore(mip6, coord, value); break;
+		case 7: if(all(lessThan(coord, imageSize(mip7)))) imageStore(mip7, coord, value); break;
+		case 8: if(all(lessThan(coord, imageSize(mip8)))) imageStore(mip8, coord, value); break;
+		case 9: if(all(lessThan(coord, imageSize(mip9)))) imageStore(mip9, coord, value); break;
+		case 10: if(all(lessThan(coord, imageSize(mip10)))) imageStore(mip10, coord, value); break;
+		case 11: if(all(lessThan(coord, imageSize(mip11)))) imageStore(mip11, coord, value); break;
+		case 12: if(all(lessThan(coord, imageSize(mip12)))) imageStore(mip12, coord, value); break;
+	}
+}
+
+vec4 LoadSource(ivec2 coord) {
+	ivec2 size = textureSize(inputImage, 0);
+	return texelFetch(inputImage, min(coord, size - 1), 0);
+}
+
+vec4 LoadScratch(ivec2 coord) {
+	ivec2 size = ivec2(gl_NumWorkGroups.xy);
+	coord = min(coord, size - 1);
+	return scratch.slots[spdConstant.slot].texels[coord.y * size.x + coord.x];
+}
+
+// coord is in mip 1
+vec4 ReduceSource(ivec2 coord) {
+	vec4 a = LoadSource(coord * 2);
+	vec4 b = LoadSource(coord * 2 + ivec2(1, 0));
+	vec4 c = LoadSource(coord * 2 + ivec2(0, 1));
+	vec4 d = LoadSource(coord * 2 + ivec2(1, 1));
+	return spdConstant.karisAverage != 0 ? ReduceKaris(a, b, c, d) : Reduce(a, b, c, d);
+}
+
+// coord is in mip 7
+vec4 ReduceScratch(ivec2 coord) {
+	return Reduce(LoadScratch(coord * 2),
+		LoadScratch(coord * 2 + ivec2(1, 0)),
+		LoadScratch(coord * 2 + ivec2(0, 1)),
+		LoadScratch(coord * 2 + ivec2(1, 1)));
+}
+
+// the 32x32 block of sharedMip at the start of shared memory is reduced five more times,
+// tile is the block position in units of its own size. returns the shared offset of the last level
+uint DownsampleShared(uint sharedMip, ivec2 tile) {
+	uint src = 0;
+	uint dst = 1024;
+	for(uint level = 1; level <= 5; level++) {
+		if(sharedMip + level > spdConstant.mipCount) {
+			break;
+		}
+
+		uint size = 32u >> level;
+		if(gl_LocalInvocationIndex < size * size) {
+			ivec2 p = ivec2(gl_LocalInvocationIndex % size, gl_LocalInvocationIndex / size);
+			uint srcSize = size * 2;
+			uint srcIndex = src + uint(p.y) * 2 * srcSize + uint(p.x) * 2;
+			vec4 value = Reduce(sharedTexels[srcIndex],
+				sharedTexels[srcIndex + 1],
+				sharedTexels[srcIndex + srcSize],
+				sharedTexels[srcIndex + srcSize + 1]);
+
+			sharedTexels[dst + uint(p.y) * size + uint(p.x)] = value;
+			StoreMip(sharedMip + level, tile * int(size) + p, value);
+		}
+		barrier();
+
+		uint temp = src;
+		src = dst;
+		dst = temp;
+	}
+	return src;
+}
+
+void main() {
+	uint index = gl_LocalInvocationIndex;
+	ivec2 group = ivec2(gl_WorkGroupID.xy);
+
+	// mip 1, every invocation reduces four quads of the 64x64 source tile
+	for(uint i = 0; i < 4; i++) {
+		ivec2 p = ivec2(index % 16 + 16 * (i % 2), index / 16 + 16 * (i / 2));
+		vec4 value = ReduceSource(group * 32 + p);
+		sharedTexels[p.y * 32 + p.x] = value;
+		StoreMip(1, group * 32 + p, value);
+	}
+	barrier();
+
+	uint last = DownsampleShared(1, group);
+
+	if(spdConstant.mipCount <= 6) {
+		return;
+	}
+
+	// publish mip 6 of this tile, the last group to arrive owns the tail of the chain
+	if(index == 0) {
+		uint groupIndex = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+		scratch.slots[spdConstant.slot].texels[groupIndex] = sharedTexels[last];
+		memoryBarrierBuffer();
+
+		uint finished = atomicAdd(scratch.slots[spdConstant.slot].counter, 1);
+		isLastGroup = finished == gl_NumWorkGroups.x * gl_NumWorkGroups.y - 1;
+	}
+	barrier();
+
+	if(!isLastGroup) {
+		return;
+	}
+
+	if(index == 0) {
+		scratch.slots[spdConstant.slot].counter = 0;
+	}
+
+	// mip 7 from the per-tile results, at most 64x64 of them
+	for(uint i = 0; i < 4; i++) {
+		ivec2 p = ivec2(index % 16 + 16 * (i % 2), index / 16 + 16 * (i / 2));
+		vec4 value = ReduceScratch(p);
+		sharedTexels[p.y * 32 + p.x] = value;
+		StoreMip(7, p, value);
+	}
+	barrier();
+
+	DownsampleShared(7, ivec2(0));
+}